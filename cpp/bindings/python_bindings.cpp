@@ -1,19 +1,52 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/functional.h>
 #include "page.hpp"
 #include "page_manager.hpp"
 #include "buffer_pool.hpp"
 #include "btree.hpp"
 #include "wal.hpp"
+#include "merge_operator.hpp"
+#include "key_encoder.hpp"
+#include "posting_list.hpp"
+#include "value_log.hpp"
+#include "snapshot_manager.hpp"
+#include "change_feed.hpp"
+#include "expr_vm.hpp"
+#include "merge_join.hpp"
+#include "hash_join.hpp"
 #include <atomic>
+#include <chrono>
+#include <map>
 #include <set>
+#include <tuple>
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace py = pybind11;
 using namespace toydb;
 
+// Merge join groups as (join value, left entries, right entries)
+using JoinGroups = std::vector<std::tuple<std::string, std::vector<MergeJoin::Entry>,
+                                          std::vector<MergeJoin::Entry>>>;
+
+// Up to max_groups groups (0: all) after join value after_value; the next
+// batch resumes after the last group's value
+JoinGroups RunMergeJoin(BTree* tree, const std::string& left_prefix,
+                        const std::string& right_prefix, const std::string& after_value,
+                        size_t max_groups) {
+    JoinGroups groups;
+    MergeJoin join(tree, left_prefix, tree, right_prefix, after_value);
+    MergeJoin::Group group;
+    while ((max_groups == 0 || groups.size() < max_groups) && join.Next(group)) {
+        std::string value = MergeJoin::JoinValue(group.left.front().first, left_prefix.size());
+        groups.emplace_back(std::move(value), std::move(group.left), std::move(group.right));
+    }
+    return groups;
+}
+
 /**
  * Simple key-value storage interface
  * Stores key-value pairs across pages
@@ -28,6 +61,7 @@ public:
         if (page_manager_.GetNumPages() > 1) {
             // Database exists, load metadata page
             metadata_page_id_ = 1;
+            EpochGuard guard(buffer_pool_.Epochs());
             auto page = buffer_pool_.FetchPage(metadata_page_id_);
             if (page) {
                 // Restore offset from page header
@@ -42,6 +76,7 @@ public:
     void insert(const std::string& key, const std::string& value) {
         // Simple implementation: store in first available space
         // For now, just store in metadata page
+        EpochGuard guard(buffer_pool_.Epochs());
         auto page = buffer_pool_.FetchPage(metadata_page_id_);
         if (!page) {
             throw std::runtime_error("Failed to fetch page");
@@ -62,6 +97,7 @@ public:
     }
     
     std::string get(const std::string& key) {
+        EpochGuard guard(buffer_pool_.Epochs());
         auto page = buffer_pool_.FetchPage(metadata_page_id_);
         if (!page) {
             throw std::runtime_error("Failed to fetch page");
@@ -118,13 +154,33 @@ private:
  */
 class TransactionalStorageEngine {
 public:
-    explicit TransactionalStorageEngine(const std::string& db_file)
+    using MergeFnMap = std::unordered_map<std::string, FunctionMergeOperator::MergeFn>;
+    
+    // merge_operators: user-defined operators needed to replay MERGE
+    // records during recovery (built-ins are always available)
+    // value_log_threshold: values longer than this go to the value log
+    // (0 keeps every value in the leaves)
+    explicit TransactionalStorageEngine(const std::string& db_file,
+                                        const MergeFnMap& merge_operators = {},
+                                        size_t value_log_threshold = 0)
         : page_manager_(db_file),
           buffer_pool_(128, &page_manager_),
           btree_(&buffer_pool_, &page_manager_),
           wal_(db_file + ".wal"),
+          value_log_(db_file + ".vlog"),
+          change_feed_(db_file + ".cdc"),
           next_txn_id_(1) {
 
+        // Pages are written back only after the log records of their changes
+        buffer_pool_.SetWAL(&wal_);
+
+        // Always attached so pointers written earlier stay readable
+        btree_.SetValueLog(&value_log_, value_log_threshold);
+
+        for (const auto& [name, fn] : merge_operators) {
+            register_merge_operator(name, fn);
+        }
+
         // Check if database exists and has a root node
         if (page_manager_.GetNumPages() > 1) {
             // Existing database - open the B-Tree
@@ -134,77 +190,341 @@ public:
             btree_.CreateTree();
         }
 
-        // Check if we need recovery
+        // Check if we need recovery. Only the log is analyzed here;
+        // keys are redone on first access (see RedoKey).
         auto wal_records = wal_.ReadLog();
 
         if (!wal_records.empty()) {
-            // Perform recovery
             Recover(wal_records);
         }
+
+        snapshots_.StartSweeper(VERSION_SWEEP_INTERVAL, VERSION_SWEEP_KEYS);
     }
     
     ~TransactionalStorageEngine() {
+        snapshots_.StopSweeper();
+        finish_recovery();
+
         // Final checkpoint
         wal_.LogCheckpoint();
         wal_.Flush();
         buffer_pool_.FlushDirty();
     }
     
-    uint64_t begin_transaction() {
+    // read_only: the transaction logs nothing and its writes are rejected,
+    // so begin and commit never touch the WAL or flush pages. It always
+    // reads a snapshot (at least "snapshot" isolation): with no writes to
+    // validate or log, the snapshot only costs version records.
+    // isolation: "" reads the latest state, "snapshot" reads commits made
+    // before begin, "serializable" adds SSI checks (see SnapshotManager)
+    uint64_t begin_transaction(bool read_only = false, const std::string& isolation = "") {
+        auto level = SnapshotManager::ParseIsolation(isolation);
+        if (read_only && level == SnapshotManager::Isolation::NONE) {
+            level = SnapshotManager::Isolation::SNAPSHOT;
+        }
         uint64_t txn_id = next_txn_id_++;
+        snapshots_.Begin(txn_id, level);
+        if (read_only) {
+            read_only_txns_.insert(txn_id);
+            return txn_id;
+        }
+        // Recovery ignores transactions without a COMMIT record, so BEGIN
+        // need not be durable; it goes out with the next flush
         wal_.LogBeginTxn(txn_id);
-        wal_.Flush();
         return txn_id;
     }
     
-    void commit_transaction(uint64_t txn_id) {
-        wal_.LogCommitTxn(txn_id);
-        wal_.Flush();
+    // Returns the commit LSN (0 for read-only transactions).
+    // Locks (uncommitted versions other writers conflict on) are released
+    // as soon as the COMMIT record is in the log buffer. With wait_durable
+    // the call then flushes the log up to it; without, the commit is
+    // pipelined: later transactions may build on it right away and a
+    // later flush (wait_durable, any synchronous commit) makes it durable.
+    // Since the log is flushed in order, a transaction's own commit being
+    // durable implies every commit it could depend on is too.
+    uint64_t commit_transaction(uint64_t txn_id, bool wait_durable = true) {
+        if (!snapshots_.CanCommit(txn_id)) {
+            abort_transaction(txn_id);
+            throw std::runtime_error("Serialization failure: transaction " +
+                                     std::to_string(txn_id) +
+                                     " has read/write conflicts both ways and was aborted");
+        }
+        if (read_only_txns_.erase(txn_id)) {
+            snapshots_.Commit(txn_id);
+            // It may have read pipelined commits: acknowledge only once
+            // they are durable
+            if (wait_durable) {
+                this->wait_durable(pipelined_lsn_);
+            }
+            return 0;
+        }
+        uint64_t commit_lsn = wal_.LogCommitTxn(txn_id);
+        txn_undo_.erase(txn_id);
+        snapshots_.Commit(txn_id);
+        if (wait_durable) {
+            this->wait_durable(commit_lsn);
+            MaybeCheckpoint();
+        } else {
+            pipelined_lsn_ = commit_lsn;
+        }
+        return commit_lsn;
+    }
+    
+    // Make the log durable up to lsn (a commit LSN), then write back
+    // dirty pages (the pool flushes the log further first if a page holds
+    // changes of other transactions logged after lsn)
+    void wait_durable(uint64_t lsn) {
+        if (lsn <= wal_.GetFlushedLSN()) {
+            return;
+        }
+        wal_.FlushTo(lsn);
         buffer_pool_.FlushDirty();
-        txn_inserts_.erase(txn_id);
+    }
+    
+    uint64_t get_durable_lsn() const {
+        return wal_.GetFlushedLSN();
     }
     
     void abort_transaction(uint64_t txn_id) {
-        // Best-effort rollback for inserts in this transaction.
-        // (UPDATE/DELETE rollback requires before-images and is not yet implemented.)
-        auto it = txn_inserts_.find(txn_id);
-        if (it != txn_inserts_.end()) {
-            for (const auto& key : it->second) {
-                btree_.Delete(key);
+        if (read_only_txns_.erase(txn_id)) {
+            snapshots_.Abort(txn_id);
+            return;
+        }
+        
+        // Restore before-images, newest first. Recovery skips aborted
+        // transactions, so nothing is logged but the ABORT record.
+        auto it = txn_undo_.find(txn_id);
+        if (it != txn_undo_.end()) {
+            for (auto undo = it->second.rbegin(); undo != it->second.rend(); ++undo) {
+                if (undo->before) {
+                    btree_.Insert(undo->key, undo->before->value, undo->before->version);
+                } else {
+                    btree_.Delete(undo->key);
+                }
             }
-            txn_inserts_.erase(it);
+            txn_undo_.erase(it);
         }
+        snapshots_.Abort(txn_id);
 
         wal_.LogAbortTxn(txn_id);
         wal_.Flush();
         buffer_pool_.FlushDirty();
     }
     
+    // Mark the current undo position of a transaction: the LSN its next
+    // write will get. Pass it to rollback_to to undo later writes only.
+    uint64_t savepoint(uint64_t txn_id) {
+        if (txn_id == 0) {
+            throw std::runtime_error("Savepoints need an explicit transaction");
+        }
+        return wal_.NextLSN();
+    }
+    
+    // Undo the writes a transaction made since a savepoint, newest first.
+    // Each undo is logged as a compensating record of the transaction, so
+    // replaying it after commit ends at the same state. The savepoint
+    // stays valid; the transaction stays open.
+    void rollback_to(uint64_t txn_id, uint64_t savepoint) {
+        auto it = txn_undo_.find(txn_id);
+        if (it == txn_undo_.end()) {
+            return;
+        }
+        
+        auto& undo = it->second;
+        while (!undo.empty() && undo.back().lsn >= savepoint) {
+            const UndoEntry& entry = undo.back();
+            if (entry.before) {
+                uint64_t lsn = wal_.LogUpdate(txn_id, 1, entry.key, entry.before->value);
+                btree_.Insert(entry.key, entry.before->value, lsn);
+            } else {
+                wal_.LogDelete(txn_id, 1, entry.key);
+                btree_.Delete(entry.key);
+            }
+            undo.pop_back();
+        }
+    }
+    
     void insert(const std::string& key, const std::string& value) {
         insert_txn(0, key, value);  // Auto-txn
     }
     
     void insert_txn(uint64_t txn_id, const std::string& key, const std::string& value) {
+        RedoKey(key);
         bool auto_txn = (txn_id == 0);
         
         if (auto_txn) {
             txn_id = begin_transaction();
+        } else {
+            CheckWritable(txn_id);
         }
         
+        auto before = BeforeWrite(txn_id, auto_txn, key);
+        
         // Log the operation
-        wal_.LogInsert(txn_id, 1, key, value);
-        wal_.Flush();
+        uint64_t lsn = wal_.LogInsert(txn_id, 1, key, value);
         
-        // Apply to B-Tree
-        btree_.Insert(key, value);
+        AfterWrite(txn_id, auto_txn, lsn, key, std::move(before));
+        
+        // Apply to B-Tree (entry version = LSN)
+        btree_.Insert(key, value, lsn);
+        
+        if (auto_txn) {
+            commit_transaction(txn_id);
+        }
+    }
 
-        if (!auto_txn) {
-            txn_inserts_[txn_id].push_back(key);
+    bool put_if_absent(const std::string& key, const std::string& value) {
+        return put_if_absent_txn(0, key, value);  // Auto-txn
+    }
+    
+    bool put_if_absent_txn(uint64_t txn_id, const std::string& key, const std::string& value) {
+        RedoKey(key);
+        bool auto_txn = (txn_id == 0);
+        
+        if (auto_txn) {
+            txn_id = begin_transaction();
+        } else {
+            CheckWritable(txn_id);
+        }
+        
+        auto before = BeforeWrite(txn_id, auto_txn, key);
+        
+        // Check first so a failed condition logs nothing, then log and
+        // apply as insert_txn does
+        bool applied = !btree_.SearchEntry(key);
+        if (applied) {
+            uint64_t lsn = wal_.LogInsert(txn_id, 1, key, value);
+            
+            AfterWrite(txn_id, auto_txn, lsn, key, std::move(before));
+            
+            btree_.Insert(key, value, lsn);
         }
         
         if (auto_txn) {
             commit_transaction(txn_id);
         }
+        return applied;
+    }
+    
+    bool put_if_version(const std::string& key, const std::string& value,
+                        uint64_t expected_version) {
+        return put_if_version_txn(0, key, value, expected_version);  // Auto-txn
+    }
+    
+    bool put_if_version_txn(uint64_t txn_id, const std::string& key,
+                            const std::string& value, uint64_t expected_version) {
+        RedoKey(key);
+        bool auto_txn = (txn_id == 0);
+        
+        if (auto_txn) {
+            txn_id = begin_transaction();
+        } else {
+            CheckWritable(txn_id);
+        }
+        
+        auto before = BeforeWrite(txn_id, auto_txn, key);
+        
+        auto current = btree_.SearchEntry(key);
+        bool applied = current && current->version == expected_version;
+        if (applied) {
+            uint64_t lsn = wal_.LogUpdate(txn_id, 1, key, value);
+            
+            AfterWrite(txn_id, auto_txn, lsn, key, std::move(before));
+            
+            btree_.Insert(key, value, lsn);
+        }
+        
+        if (auto_txn) {
+            commit_transaction(txn_id);
+        }
+        return applied;
+    }
+    
+    bool delete_if(const std::string& key, uint64_t expected_version) {
+        return delete_if_txn(0, key, expected_version);  // Auto-txn
+    }
+    
+    bool delete_if_txn(uint64_t txn_id, const std::string& key, uint64_t expected_version) {
+        RedoKey(key);
+        bool auto_txn = (txn_id == 0);
+        
+        if (auto_txn) {
+            txn_id = begin_transaction();
+        } else {
+            CheckWritable(txn_id);
+        }
+        
+        auto before = BeforeWrite(txn_id, auto_txn, key);
+        
+        auto current = btree_.SearchEntry(key);
+        bool applied = current && current->version == expected_version;
+        if (applied) {
+            uint64_t lsn = wal_.LogDelete(txn_id, 1, key);
+            
+            AfterWrite(txn_id, auto_txn, lsn, key, std::move(before));
+            
+            btree_.Delete(key);
+        }
+        
+        if (auto_txn) {
+            commit_transaction(txn_id);
+        }
+        return applied;
+    }
+    
+    std::string merge(const std::string& key, const std::string& operand,
+                      const std::string& op_name) {
+        return merge_txn(0, key, operand, op_name);  // Auto-txn
+    }
+    
+    std::string merge_txn(uint64_t txn_id, const std::string& key,
+                          const std::string& operand, const std::string& op_name) {
+        const MergeOperator& op = merge_operators_.Get(op_name);
+        RedoKey(key);
+        bool auto_txn = (txn_id == 0);
+        
+        if (auto_txn) {
+            txn_id = begin_transaction();
+        } else {
+            CheckWritable(txn_id);
+        }
+        
+        std::string result;
+        try {
+            auto before = BeforeWrite(txn_id, auto_txn, key);
+            
+            // Merged in place at the leaf, in one descent. The operator
+            // runs before logging: an operand it rejects leaves no record
+            // for recovery to replay.
+            btree_.Upsert(key, [&](const BTree::Entry* existing) -> std::optional<BTree::Entry> {
+                std::optional<std::string> current;
+                if (existing) {
+                    current = existing->value;
+                }
+                result = op.Merge(current, operand);
+                
+                // Recovery reapplies the operand (see ReplayMerge); the
+                // result is logged for change data capture
+                uint64_t lsn = wal_.LogMerge(txn_id, 1, key, op_name, operand, result);
+                AfterWrite(txn_id, auto_txn, lsn, key, std::move(before));
+                return BTree::Entry{result, lsn};
+            });
+        } catch (...) {
+            if (auto_txn) {
+                abort_transaction(txn_id);
+            }
+            throw;
+        }
+        
+        if (auto_txn) {
+            commit_transaction(txn_id);
+        }
+        return result;
+    }
+    
+    void register_merge_operator(const std::string& name,
+                                 const FunctionMergeOperator::MergeFn& fn) {
+        merge_operators_.Register(std::make_shared<FunctionMergeOperator>(name, fn));
     }
 
     void remove(const std::string& key) {
@@ -212,28 +532,75 @@ public:
     }
 
     void remove_txn(uint64_t txn_id, const std::string& key) {
+        RedoKey(key);
+        
+        // Fail before anything is logged or recorded as written
+        if (!btree_.Search(key)) {
+            throw std::runtime_error("Key not found: " + key);
+        }
         bool auto_txn = (txn_id == 0);
 
         if (auto_txn) {
             txn_id = begin_transaction();
+        } else {
+            CheckWritable(txn_id);
         }
 
+        auto before = BeforeWrite(txn_id, auto_txn, key);
+
         // Log the operation
-        wal_.LogDelete(txn_id, 1, key);
-        wal_.Flush();
+        uint64_t lsn = wal_.LogDelete(txn_id, 1, key);
+
+        AfterWrite(txn_id, auto_txn, lsn, key, std::move(before));
 
         // Apply to B-Tree
-        bool deleted = btree_.Delete(key);
-        if (!deleted) {
-            throw std::runtime_error("Key not found: " + key);
-        }
+        btree_.Delete(key);
 
         if (auto_txn) {
             commit_transaction(txn_id);
         }
     }
     
+    void delete_range(const std::string& start_key, const std::string& end_key) {
+        delete_range_txn(0, start_key, end_key);  // Auto-txn
+    }
+    
+    void delete_range_txn(uint64_t txn_id, const std::string& start_key,
+                          const std::string& end_key) {
+        RedoRange(start_key, end_key);
+        bool auto_txn = (txn_id == 0);
+        
+        if (auto_txn) {
+            txn_id = begin_transaction();
+        } else {
+            CheckWritable(txn_id);
+        }
+        
+        // Before-images of every entry in the range
+        std::vector<std::pair<std::string, std::optional<BTree::Entry>>> befores;
+        if (!auto_txn || snapshots_.VersionsNeeded()) {
+            for (auto& row : btree_.RangeScan(start_key, end_key)) {
+                auto before = BeforeWrite(txn_id, auto_txn, row.first);
+                befores.emplace_back(std::move(row.first), std::move(before));
+            }
+        }
+        
+        // One log record for the whole range
+        uint64_t lsn = wal_.LogDeleteRange(txn_id, 1, start_key, end_key);
+        
+        for (auto& [key, before] : befores) {
+            AfterWrite(txn_id, auto_txn, lsn, key, std::move(before));
+        }
+        
+        btree_.DeleteRange(start_key, end_key);
+        
+        if (auto_txn) {
+            commit_transaction(txn_id);
+        }
+    }
+    
     std::string get(const std::string& key) {
+        RedoKey(key);
         auto result = btree_.Search(key);
         if (result.has_value()) {
             return result.value();
@@ -241,27 +608,127 @@ public:
         throw std::runtime_error("Key not found: " + key);
     }
     
+    std::pair<std::string, uint64_t> get_with_version(const std::string& key) {
+        RedoKey(key);
+        auto entry = btree_.SearchEntry(key);
+        if (entry.has_value()) {
+            return {entry->value, entry->version};
+        }
+        throw std::runtime_error("Key not found: " + key);
+    }
+    
     std::vector<std::pair<std::string, std::string>> range_scan(
         const std::string& start_key,
         const std::string& end_key
     ) {
+        RedoRange(start_key, end_key);
         return btree_.RangeScan(start_key, end_key);
     }
     
+    std::vector<std::pair<std::string, std::string>> multi_range_scan(
+        const std::vector<std::pair<std::string, std::string>>& ranges
+    ) {
+        for (const auto& [start_key, end_key] : ranges) {
+            RedoRange(start_key, end_key);
+        }
+        return btree_.MultiRangeScan(ranges);
+    }
+    
+    // Equi-join the keys under two prefixes on their next key component
+    // (in batches of max_groups, see RunMergeJoin)
+    JoinGroups merge_join(const std::string& left_prefix, const std::string& right_prefix,
+                          const std::string& after_value, size_t max_groups) {
+        RedoRange(left_prefix, left_prefix + '\xff');
+        RedoRange(right_prefix, right_prefix + '\xff');
+        return RunMergeJoin(&btree_, left_prefix, right_prefix, after_value, max_groups);
+    }
+    
+    // Reads within a transaction: snapshot and serializable transactions
+    // see their snapshot (and take SIREAD locks), others the latest state
+    std::string get_txn(uint64_t txn_id, const std::string& key) {
+        auto version = snapshots_.Read(txn_id, key);
+        if (!version) {
+            return get(key);
+        }
+        if (!version->has_value()) {
+            throw std::runtime_error("Key not found: " + key);
+        }
+        return **version;
+    }
+    
+    std::vector<std::pair<std::string, std::string>> range_scan_txn(
+        uint64_t txn_id,
+        const std::string& start_key,
+        const std::string& end_key
+    ) {
+        RedoRange(start_key, end_key);
+        auto rows = btree_.RangeScan(start_key, end_key);
+        snapshots_.ReadRange(txn_id, start_key, end_key, rows);
+        return rows;
+    }
+    
     void checkpoint() {
+        finish_recovery();  // The log is truncated below
         wal_.LogCheckpoint();
+        value_log_.Flush();
         buffer_pool_.FlushDirty();
         wal_.Flush();
         
-        // After checkpoint, we can truncate the WAL
-        wal_.Truncate();
+        // After checkpoint, we can truncate the WAL, except for what
+        // change consumers have not acknowledged yet and the records of
+        // open transactions (the flush above wrote their uncommitted
+        // writes; recovery rolls them back from their before-images)
+        uint64_t keep_from = UINT64_MAX;
+        if (change_feed_.HasConsumers()) {
+            PollChanges();
+            keep_from = change_feed_.RetainFrom();
+        } else {
+            change_feed_.Reset();
+        }
+        for (const auto& [txn_id, undo] : txn_undo_) {
+            if (!undo.empty()) {
+                keep_from = std::min(keep_from, undo.front().lsn);
+            }
+        }
+        wal_.Truncate(keep_from);
+        change_offset_ = wal_.GetSize();  // Everything kept is decoded
+        checkpoint_wal_size_ = wal_.GetSize();
+        last_checkpoint_ = std::chrono::steady_clock::now();
+    }
+    
+    // Checkpoint automatically after a commit once any trigger fires
+    // (0 disables it): max_wal_bytes logged since the last checkpoint,
+    // max_interval_seconds elapsed with something logged, or an estimated
+    // replay time of the log above recovery_target_ms
+    void set_checkpoint_policy(uint64_t max_wal_bytes, double max_interval_seconds,
+                               double recovery_target_ms) {
+        checkpoint_wal_bytes_ = max_wal_bytes;
+        checkpoint_interval_s_ = max_interval_seconds;
+        recovery_target_ms_ = recovery_target_ms;
+    }
+    
+    uint64_t get_wal_size() const {
+        return wal_.GetSize();
+    }
+    
+    uint64_t get_auto_checkpoints() const {
+        return auto_checkpoints_;
     }
     
     void flush() {
+        value_log_.Flush();
         buffer_pool_.FlushDirty();
         wal_.Flush();
     }
     
+    uint64_t collect_value_log(double max_live_ratio) {
+        return btree_.CollectValueLog(max_live_ratio);
+    }
+    
+    uint64_t get_value_log_size() const {
+        return value_log_.TotalSize();
+    }
+    
     double get_cache_hit_rate() const {
         return buffer_pool_.GetHitRate();
     }
@@ -269,19 +736,213 @@ public:
     uint64_t get_last_lsn() const {
         return wal_.GetLastLSN();
     }
+    
+    // Change data capture: committed changes of transactions whose commit
+    // LSN is after after_lsn, in commit order, as
+    // (commit_lsn, lsn, txn_id, op, key, value, merge). Ops: "insert" (an
+    // upsert), "update", "delete", "merge" (value: the merged value, merge:
+    // operator + '\0' + operand; empty for other ops) and "delete_range"
+    // (key..value). At most about max_changes (0: all), never splitting a
+    // transaction.
+    std::vector<std::tuple<uint64_t, uint64_t, uint64_t, std::string, std::string, std::string,
+                           std::string>>
+    read_changes(uint64_t after_lsn, size_t max_changes) {
+        PollChanges();
+        std::vector<std::tuple<uint64_t, uint64_t, uint64_t, std::string, std::string, std::string,
+                               std::string>>
+            result;
+        for (auto& change : change_feed_.Read(after_lsn, max_changes)) {
+            std::string merge;
+            if (change.type == WAL::RecordType::MERGE) {
+                WAL::WALRecord record;
+                record.lsn = change.lsn;
+                record.value = std::move(change.value);
+                std::string op_name, operand;
+                WAL::DecodeMerge(record, op_name, operand, change.value);
+                merge = op_name + '\0' + operand;
+            }
+            result.emplace_back(change.commit_lsn, change.lsn, change.txn_id,
+                                ChangeOpName(change.type), std::move(change.key),
+                                std::move(change.value), std::move(merge));
+        }
+        return result;
+    }
+    
+    // A named change consumer: the WAL keeps every change it has not
+    // acknowledged, across checkpoints and restarts. Returns its position
+    // (from_lsn when new).
+    uint64_t register_change_consumer(const std::string& name, uint64_t from_lsn) {
+        return change_feed_.Register(name, from_lsn);
+    }
+    
+    void ack_changes(const std::string& name, uint64_t lsn) {
+        change_feed_.Ack(name, lsn);
+    }
+    
+    void drop_change_consumer(const std::string& name) {
+        change_feed_.Drop(name);
+    }
+    
+    // Redo every key recovery has not reached yet
+    void finish_recovery() {
+        while (!pending_redo_.empty()) {
+            RedoBatch(pending_redo_.size());
+        }
+    }
+    
+    // Keys with log records still to redo after a restart
+    uint64_t get_recovery_pending() const {
+        return pending_redo_.size();
+    }
+    
+    // Prune versions no running snapshot can read, returns how many
+    // (the background sweeper does this a few keys at a time)
+    uint64_t collect_versions() {
+        return snapshots_.CollectVersions();
+    }
+    
+    // Version chain metrics; a growing oldest_snapshot_lag or
+    // max_chain_length points at a long-running snapshot transaction
+    std::map<std::string, uint64_t> get_version_stats() const {
+        auto stats = snapshots_.GetVersionStats();
+        return {
+            {"versions", stats.versions},
+            {"version_keys", stats.keys},
+            {"max_chain_length", stats.max_chain_length},
+            {"oldest_snapshot_lag", stats.oldest_snapshot_lag},
+            {"oldest_snapshot_txn", stats.oldest_snapshot_txn},
+            {"versions_pruned", stats.pruned}
+        };
+    }
 
 private:
+    static constexpr std::chrono::milliseconds VERSION_SWEEP_INTERVAL{100};
+    static constexpr size_t VERSION_SWEEP_KEYS = 1024;
+    static constexpr size_t REDO_BATCH = 32;  // Keys redone per access during recovery
+    static constexpr uint64_t DEFAULT_CHECKPOINT_WAL_BYTES = 16 << 20;
+    static constexpr double DEFAULT_CHECKPOINT_INTERVAL_S = 300;
+    static constexpr double REDO_BYTES_PER_MS = 16384;  // Rough replay rate for recovery targets
+    
+    // Undo information for one write of an explicit transaction
+    struct UndoEntry {
+        uint64_t lsn;                       // LSN of the write (savepoints compare against it)
+        std::string key;
+        std::optional<BTree::Entry> before; // nullopt: key did not exist
+    };
+    
     PageManager page_manager_;
     BufferPool buffer_pool_;
     BTree btree_;
     WAL wal_;
+    ValueLog value_log_;
+    ChangeFeed change_feed_;
+    uint64_t change_offset_ = 0;  // WAL bytes decoded by the change feed
     std::atomic<uint64_t> next_txn_id_;
-    std::unordered_map<uint64_t, std::vector<std::string>> txn_inserts_;
+    std::unordered_map<uint64_t, std::vector<UndoEntry>> txn_undo_;
+    std::unordered_set<uint64_t> read_only_txns_;
+    uint64_t pipelined_lsn_ = 0;  // Last commit acknowledged before it was durable
+    std::map<std::string, std::vector<WAL::WALRecord>> pending_redo_;  // Per key, LSN order
+    
+    // Automatic checkpoints (see set_checkpoint_policy)
+    uint64_t checkpoint_wal_bytes_ = DEFAULT_CHECKPOINT_WAL_BYTES;
+    double checkpoint_interval_s_ = DEFAULT_CHECKPOINT_INTERVAL_S;
+    double recovery_target_ms_ = 0;
+    uint64_t checkpoint_wal_size_ = 0;  // WAL size right after the last checkpoint
+    std::chrono::steady_clock::time_point last_checkpoint_ = std::chrono::steady_clock::now();
+    uint64_t auto_checkpoints_ = 0;
+    SnapshotManager snapshots_;
+    MergeOperatorRegistry merge_operators_;
+    
+    // Conflict checks and before-image for a write of key; auto-commit
+    // writes skip both unless a snapshot transaction is running
+    std::optional<BTree::Entry> BeforeWrite(uint64_t txn_id, bool auto_txn,
+                                            const std::string& key) {
+        if (auto_txn && !snapshots_.VersionsNeeded()) {
+            return std::nullopt;
+        }
+        snapshots_.CheckWrite(txn_id, key);
+        return btree_.SearchEntry(key);
+    }
+    
+    // Undo entry and version for a write of key logged at lsn. Explicit
+    // transactions also log the before-image: their pages can be written
+    // back before they commit (see Recover).
+    void AfterWrite(uint64_t txn_id, bool auto_txn, uint64_t lsn, const std::string& key,
+                    std::optional<BTree::Entry> before) {
+        if (auto_txn && !snapshots_.VersionsNeeded()) {
+            return;
+        }
+        snapshots_.RecordWrite(txn_id, key,
+                               before ? std::optional<std::string>(before->value) : std::nullopt);
+        if (!auto_txn) {
+            wal_.LogUndo(txn_id, 1, key,
+                         before ? std::optional<std::string>(before->value) : std::nullopt,
+                         before ? before->version : 0);
+            txn_undo_[txn_id].push_back({lsn, key, std::move(before)});
+        }
+    }
+    
+    // Decode log records written since the last poll. Only durable ones:
+    // pipelined commits reach consumers once a flush covers them.
+    void PollChanges() {
+        change_feed_.Decode(wal_.ReadLog(change_offset_, wal_.GetFlushedLSN()));
+    }
+    
+    static std::string ChangeOpName(WAL::RecordType type) {
+        switch (type) {
+            case WAL::RecordType::INSERT: return "insert";
+            case WAL::RecordType::UPDATE: return "update";
+            case WAL::RecordType::DELETE: return "delete";
+            case WAL::RecordType::MERGE: return "merge";
+            case WAL::RecordType::DELETE_RANGE: return "delete_range";
+            default: return "unknown";
+        }
+    }
     
+    // Checkpoint if a trigger of the policy fired. Not while recovery is
+    // still redoing keys (a checkpoint would have to finish it first).
+    // Open transactions do not hold it back: the log is kept from the
+    // oldest one's first write on (see checkpoint).
+    void MaybeCheckpoint() {
+        if (!pending_redo_.empty()) {
+            return;
+        }
+        uint64_t logged = wal_.GetSize() - std::min(wal_.GetSize(), checkpoint_wal_size_);
+        if (logged == 0) {
+            return;
+        }
+        
+        bool due = checkpoint_wal_bytes_ > 0 && logged >= checkpoint_wal_bytes_;
+        if (!due && checkpoint_interval_s_ > 0) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - last_checkpoint_;
+            due = elapsed.count() >= checkpoint_interval_s_;
+        }
+        if (!due && recovery_target_ms_ > 0) {
+            due = logged / REDO_BYTES_PER_MS >= recovery_target_ms_;
+        }
+        if (due) {
+            checkpoint();
+            auto_checkpoints_++;
+        }
+    }
+    
+    void CheckWritable(uint64_t txn_id) const {
+        if (read_only_txns_.count(txn_id)) {
+            throw std::runtime_error("Transaction " + std::to_string(txn_id) + " is read-only");
+        }
+    }
+    
+    // Log analysis for instant restart. Durable operations
+    // - auto transactions (txn_id == 0)
+    // - committed explicit transactions
+    // are queued per key instead of replayed, so the engine opens at once;
+    // each key is redone when first accessed, and every access redoes a
+    // few more keys so recovery completes while serving traffic.
+    // Losers (transactions with neither COMMIT nor ABORT) are rolled back
+    // the same way: their writes can be on disk, since commits and
+    // evictions write back whole pages, so the before-images they logged
+    // are queued behind the key's redo.
     void Recover(const std::vector<WAL::WALRecord>& records) {
-        // Replay all durable operations:
-        // - auto transactions (txn_id == 0)
-        // - committed explicit transactions
         std::set<uint64_t> committed_txns;
         std::set<uint64_t> aborted_txns;
 
@@ -293,6 +954,10 @@ private:
                 aborted_txns.insert(record.txn_id);
             }
         }
+        auto durable = [&](const WAL::WALRecord& record) {
+            return record.txn_id == 0 ||
+                   (committed_txns.count(record.txn_id) && !aborted_txns.count(record.txn_id));
+        };
 
         // Start replay after the last checkpoint (if any)
         size_t replay_start = 0;
@@ -305,17 +970,68 @@ private:
         for (size_t i = replay_start; i < records.size(); ++i) {
             const auto& record = records[i];
 
-            bool durable = (record.txn_id == 0) ||
-                           (committed_txns.count(record.txn_id) && !aborted_txns.count(record.txn_id));
-            if (!durable) {
+            if (!durable(record)) {
                 continue;
             }
 
             if (record.type == WAL::RecordType::INSERT ||
-                record.type == WAL::RecordType::UPDATE) {
-                btree_.Insert(record.key, record.value);
-            } else if (record.type == WAL::RecordType::DELETE) {
-                btree_.Delete(record.key);
+                record.type == WAL::RecordType::UPDATE ||
+                record.type == WAL::RecordType::DELETE ||
+                record.type == WAL::RecordType::MERGE) {
+                if (record.type == WAL::RecordType::MERGE) {
+                    CheckMergeOperator(record);  // Fail at open, not on first access
+                }
+                pending_redo_[record.key].push_back(record);
+            } else if (record.type == WAL::RecordType::DELETE_RANGE) {
+                // Applied now: it removes keys the log never mentions.
+                // Queued keys in the range restart from a delete, so
+                // later records rebuild them in order.
+                btree_.DeleteRange(record.key, record.value);
+                auto first = pending_redo_.lower_bound(record.key);
+                auto last = pending_redo_.upper_bound(record.value);
+                for (auto it = first; it != last; ++it) {
+                    WAL::WALRecord erase;
+                    erase.type = WAL::RecordType::DELETE;
+                    erase.lsn = record.lsn;
+                    erase.txn_id = record.txn_id;
+                    erase.key = it->first;
+                    it->second.assign(1, erase);
+                }
+            }
+        }
+
+        // Loser before-images, from the whole log: a checkpoint keeps the
+        // records of transactions still open (see checkpoint). A durable
+        // write of the key after the loser's one supersedes it; aborted
+        // transactions restored their pages before logging ABORT.
+        std::map<std::string, uint64_t> durable_lsn;
+        std::vector<const WAL::WALRecord*> durable_ranges;
+        for (const auto& record : records) {
+            if (!durable(record)) {
+                continue;
+            }
+            if (record.type == WAL::RecordType::DELETE_RANGE) {
+                durable_ranges.push_back(&record);
+            } else if (record.type == WAL::RecordType::INSERT ||
+                       record.type == WAL::RecordType::UPDATE ||
+                       record.type == WAL::RecordType::DELETE ||
+                       record.type == WAL::RecordType::MERGE) {
+                durable_lsn[record.key] = record.lsn;
+            }
+        }
+        for (const auto& record : records) {
+            if (record.type != WAL::RecordType::UNDO || committed_txns.count(record.txn_id) ||
+                aborted_txns.count(record.txn_id)) {
+                continue;
+            }
+            auto it = durable_lsn.find(record.key);
+            bool superseded = (it != durable_lsn.end() && it->second > record.lsn) ||
+                std::any_of(durable_ranges.begin(), durable_ranges.end(), [&](const auto* range) {
+                    return range->lsn > record.lsn && range->key <= record.key &&
+                           record.key <= range->value;
+                });
+            if (!superseded) {
+                pending_redo_[record.key].push_back(record);
             }
         }
 
@@ -326,6 +1042,92 @@ private:
         }
         next_txn_id_ = max_txn_id + 1;
     }
+    
+    // Redo the queued records of key (if any) before it is read or
+    // written, then a batch of other keys
+    void RedoKey(const std::string& key) {
+        if (pending_redo_.empty()) {
+            return;
+        }
+        auto it = pending_redo_.find(key);
+        if (it != pending_redo_.end()) {
+            Redo(it->second);
+            pending_redo_.erase(it);
+        }
+        RedoBatch(REDO_BATCH);
+    }
+    
+    void RedoRange(const std::string& start_key, const std::string& end_key) {
+        if (pending_redo_.empty()) {
+            return;
+        }
+        if (start_key <= end_key) {
+            auto it = pending_redo_.lower_bound(start_key);
+            while (it != pending_redo_.end() && it->first <= end_key) {
+                Redo(it->second);
+                it = pending_redo_.erase(it);
+            }
+        }
+        RedoBatch(REDO_BATCH);
+    }
+    
+    void RedoBatch(size_t max_keys) {
+        for (size_t i = 0; i < max_keys && !pending_redo_.empty(); i++) {
+            Redo(pending_redo_.begin()->second);
+            pending_redo_.erase(pending_redo_.begin());
+        }
+    }
+    
+    // Durable records in LSN order, then the loser before-images newest
+    // first (Recover queues them behind every durable record of the key)
+    void Redo(const std::vector<WAL::WALRecord>& records) {
+        for (const auto& record : records) {
+            if (record.type == WAL::RecordType::UNDO) {
+                continue;
+            } else if (record.type == WAL::RecordType::DELETE) {
+                btree_.Delete(record.key);
+            } else if (record.type == WAL::RecordType::MERGE) {
+                ReplayMerge(record);
+            } else {
+                btree_.Insert(record.key, record.value, record.lsn);
+            }
+        }
+        for (auto it = records.rbegin(); it != records.rend(); ++it) {
+            std::string value;
+            uint64_t version;
+            if (it->type != WAL::RecordType::UNDO) {
+                continue;
+            } else if (WAL::DecodeUndo(*it, value, version)) {
+                btree_.Insert(it->key, value, version);
+            } else {
+                btree_.Delete(it->key);
+            }
+        }
+    }
+    
+    // Operator a MERGE record needs; throws if it is not registered
+    const MergeOperator& CheckMergeOperator(const WAL::WALRecord& record) const {
+        std::string op_name, operand, result;
+        WAL::DecodeMerge(record, op_name, operand, result);
+        
+        const MergeOperator* op = merge_operators_.Find(op_name);
+        if (!op) {
+            throw std::runtime_error("Cannot replay MERGE at LSN " + std::to_string(record.lsn) +
+                                     ": merge operator '" + op_name + "' is not registered");
+        }
+        return *op;
+    }
+    
+    void ReplayMerge(const WAL::WALRecord& record) {
+        std::string op_name, operand, result;
+        WAL::DecodeMerge(record, op_name, operand, result);
+        const MergeOperator& op = CheckMergeOperator(record);
+        
+        // The entry version makes replay idempotent: merges already
+        // reflected in the flushed leaf are skipped by BTree::Merge.
+        // Only operands the operator accepted were logged.
+        btree_.Merge(record.key, operand, op, record.lsn);
+    }
 };
 
 /**
@@ -333,10 +1135,17 @@ private:
  */
 class IndexedStorageEngine {
 public:
-    explicit IndexedStorageEngine(const std::string& db_file)
+    // value_log_threshold: values longer than this go to the value log
+    // (0 keeps every value in the leaves)
+    // value_log_segment_size: bytes per value log segment (0: the default)
+    explicit IndexedStorageEngine(const std::string& db_file, size_t value_log_threshold = 0,
+                                  uint64_t value_log_segment_size = 0)
         : page_manager_(db_file),
           buffer_pool_(128, &page_manager_),
-          btree_(&buffer_pool_, &page_manager_) {
+          btree_(&buffer_pool_, &page_manager_),
+          value_log_(db_file + ".vlog", value_log_segment_size) {
+        
+        btree_.SetValueLog(&value_log_, value_log_threshold);
         
         // Check if database exists and has a root node
         if (page_manager_.GetNumPages() > 1) {
@@ -351,6 +1160,29 @@ public:
     void insert(const std::string& key, const std::string& value) {
         btree_.Insert(key, value);
     }
+    
+    bool put_if_absent(const std::string& key, const std::string& value) {
+        return btree_.InsertIfAbsent(key, value);
+    }
+    
+    bool put_if_version(const std::string& key, const std::string& value,
+                        uint64_t expected_version) {
+        return btree_.InsertIfVersion(key, value, expected_version);
+    }
+    
+    bool delete_if(const std::string& key, uint64_t expected_version) {
+        return btree_.DeleteIfVersion(key, expected_version);
+    }
+    
+    std::string merge(const std::string& key, const std::string& operand,
+                      const std::string& op_name) {
+        return btree_.Merge(key, operand, merge_operators_.Get(op_name));
+    }
+    
+    void register_merge_operator(const std::string& name,
+                                 const FunctionMergeOperator::MergeFn& fn) {
+        merge_operators_.Register(std::make_shared<FunctionMergeOperator>(name, fn));
+    }
 
     void remove(const std::string& key) {
         bool deleted = btree_.Delete(key);
@@ -359,6 +1191,10 @@ public:
         }
     }
     
+    void delete_range(const std::string& start_key, const std::string& end_key) {
+        btree_.DeleteRange(start_key, end_key);
+    }
+    
     std::string get(const std::string& key) {
         auto result = btree_.Search(key);
         if (result.has_value()) {
@@ -367,6 +1203,14 @@ public:
         throw std::runtime_error("Key not found: " + key);
     }
     
+    std::pair<std::string, uint64_t> get_with_version(const std::string& key) {
+        auto entry = btree_.SearchEntry(key);
+        if (entry.has_value()) {
+            return {entry->value, entry->version};
+        }
+        throw std::runtime_error("Key not found: " + key);
+    }
+    
     std::vector<std::pair<std::string, std::string>> range_scan(
         const std::string& start_key,
         const std::string& end_key
@@ -374,10 +1218,35 @@ public:
         return btree_.RangeScan(start_key, end_key);
     }
     
+    std::vector<std::pair<std::string, std::string>> multi_range_scan(
+        const std::vector<std::pair<std::string, std::string>>& ranges
+    ) {
+        return btree_.MultiRangeScan(ranges);
+    }
+    
+    JoinGroups merge_join(const std::string& left_prefix, const std::string& right_prefix,
+                          const std::string& after_value, size_t max_groups) {
+        return RunMergeJoin(&btree_, left_prefix, right_prefix, after_value, max_groups);
+    }
+    
     void flush() {
+        value_log_.Flush();
         buffer_pool_.FlushDirty();
     }
     
+    uint64_t collect_value_log(double max_live_ratio) {
+        return btree_.CollectValueLog(max_live_ratio);
+    }
+    
+    uint64_t get_value_log_size() const {
+        return value_log_.TotalSize();
+    }
+    
+    // Evicted frames waiting for readers that might still use them
+    size_t get_epoch_pending() const {
+        return buffer_pool_.Epochs().PendingCount();
+    }
+    
     double get_cache_hit_rate() const {
         return buffer_pool_.GetHitRate();
     }
@@ -386,11 +1255,80 @@ private:
     PageManager page_manager_;
     BufferPool buffer_pool_;
     BTree btree_;
+    ValueLog value_log_;
+    MergeOperatorRegistry merge_operators_;
 };
 
 PYBIND11_MODULE(_storage_engine, m) {
     m.doc() = "ToyDB Storage Engine - C++ backend for database storage";
     
+    // Order-preserving composite keys (multi-column indexes)
+    m.def("encode_key", &KeyEncoder::Encode,
+          "Encode a tuple of None/int/float/str into a memcomparable key",
+          py::arg("values"));
+    m.def("decode_key", &KeyEncoder::Decode,
+          "Decode a key produced by encode_key back into its tuple",
+          py::arg("key"));
+    
+    // Compressed row ID lists (non-unique index entries)
+    m.def("encode_postings", &PostingList::Encode,
+          "Encode row IDs as a sorted, delta-encoded posting list",
+          py::arg("ids"));
+    m.def("decode_postings", &PostingList::Decode,
+          "Decode a posting list into sorted row IDs",
+          py::arg("data"));
+    
+    // Compiled predicates (WHERE / JOIN ON / HAVING, see toydb/expressions.py)
+    py::enum_<ExprProgram::Op>(m, "ExprOp")
+        .value("LOAD_COLUMN", ExprProgram::Op::LOAD_COLUMN)
+        .value("LOAD_CONST", ExprProgram::Op::LOAD_CONST)
+        .value("EQ", ExprProgram::Op::EQ)
+        .value("NE", ExprProgram::Op::NE)
+        .value("LT", ExprProgram::Op::LT)
+        .value("LE", ExprProgram::Op::LE)
+        .value("GT", ExprProgram::Op::GT)
+        .value("GE", ExprProgram::Op::GE)
+        .value("EQ_INT", ExprProgram::Op::EQ_INT)
+        .value("NE_INT", ExprProgram::Op::NE_INT)
+        .value("LT_INT", ExprProgram::Op::LT_INT)
+        .value("LE_INT", ExprProgram::Op::LE_INT)
+        .value("GT_INT", ExprProgram::Op::GT_INT)
+        .value("GE_INT", ExprProgram::Op::GE_INT)
+        .value("EQ_TEXT", ExprProgram::Op::EQ_TEXT)
+        .value("NE_TEXT", ExprProgram::Op::NE_TEXT)
+        .value("IN_LIST", ExprProgram::Op::IN_LIST)
+        .value("TRUTHY", ExprProgram::Op::TRUTHY)
+        .value("JUMP_IF_FALSE", ExprProgram::Op::JUMP_IF_FALSE)
+        .value("JUMP_IF_TRUE", ExprProgram::Op::JUMP_IF_TRUE)
+        .value("RETURN", ExprProgram::Op::RETURN);
+    
+    py::class_<ExprProgram>(m, "ExprProgram")
+        .def(py::init<bool>(), py::arg("coerce_numeric_text") = true)
+        .def("add_constant", &ExprProgram::AddConstant,
+             "Add a constant, returns its index (LOAD_CONST operand)",
+             py::arg("value"))
+        .def("add_list", &ExprProgram::AddList,
+             "Add an IN list, returns its index (IN_LIST operand)",
+             py::arg("values"))
+        .def("emit", &ExprProgram::Emit,
+             "Append an instruction, returns its address",
+             py::arg("op"), py::arg("dst") = 0, py::arg("a") = 0, py::arg("b") = 0)
+        .def("patch", &ExprProgram::Patch,
+             "Set the target of the jump at address",
+             py::arg("address"), py::arg("target"))
+        .def("evaluate", &ExprProgram::Evaluate,
+             "Evaluate for one row (tuple of column slots)",
+             py::arg("row"))
+        .def("filter", &ExprProgram::Filter,
+             "Indexes of the rows the predicate holds for",
+             py::arg("rows"))
+        .def("__len__", &ExprProgram::Size);
+    
+    // Hash join over in-memory key tuples (JOIN execution)
+    m.def("hash_join", &HashJoin::Join,
+          "Equi-join two lists of key tuples, returns (build index, probe index) pairs",
+          py::arg("build"), py::arg("probe"));
+    
     // Simple linear storage (Phase 1)
     py::class_<StorageEngine>(m, "StorageEngine")
         .def(py::init<const std::string&>())
@@ -407,59 +1345,198 @@ PYBIND11_MODULE(_storage_engine, m) {
     
     // B-Tree indexed storage (Phase 2)
     py::class_<IndexedStorageEngine>(m, "IndexedStorageEngine")
-        .def(py::init<const std::string&>())
+        .def(py::init<const std::string&, size_t, uint64_t>(),
+             py::arg("db_file"), py::arg("value_log_threshold") = 0,
+             py::arg("value_log_segment_size") = 0)
         .def("insert", &IndexedStorageEngine::insert,
              "Insert a key-value pair into B-Tree",
              py::arg("key"), py::arg("value"))
+        .def("get_with_version", &IndexedStorageEngine::get_with_version,
+             "Get (value, version) by key",
+             py::arg("key"))
+        .def("put_if_absent", &IndexedStorageEngine::put_if_absent,
+             "Insert only if key does not exist, returns True if written",
+             py::arg("key"), py::arg("value"))
+        .def("put_if_version", &IndexedStorageEngine::put_if_version,
+             "Overwrite only if the entry version matches, returns True if written",
+             py::arg("key"), py::arg("value"), py::arg("expected_version"))
+        .def("delete_if", &IndexedStorageEngine::delete_if,
+             "Delete only if the entry version matches, returns True if deleted",
+             py::arg("key"), py::arg("expected_version"))
+        .def("merge", &IndexedStorageEngine::merge,
+             "Merge operand into the value under key using a named merge operator",
+             py::arg("key"), py::arg("operand"), py::arg("op"))
+        .def("register_merge_operator", &IndexedStorageEngine::register_merge_operator,
+             "Register a user-defined merge operator fn(existing, operand) -> new value",
+             py::arg("name"), py::arg("fn"))
         .def("delete", &IndexedStorageEngine::remove,
              "Delete a key-value pair from B-Tree",
              py::arg("key"))
+        .def("delete_range", &IndexedStorageEngine::delete_range,
+             "Delete all keys in range [start_key, end_key]",
+             py::arg("start_key"), py::arg("end_key"))
         .def("get", &IndexedStorageEngine::get,
              "Get value by key from B-Tree",
              py::arg("key"))
         .def("range_scan", &IndexedStorageEngine::range_scan,
              "Scan keys in range [start_key, end_key]",
              py::arg("start_key"), py::arg("end_key"))
+        .def("multi_range_scan", &IndexedStorageEngine::multi_range_scan,
+             "Scan a list of (start_key, end_key) ranges in one forward pass",
+             py::arg("ranges"))
+        .def("merge_join", &IndexedStorageEngine::merge_join,
+             "Join the keys under two prefixes on their next encoded component, "
+             "returns (join value, left entries, right entries) per matching value; "
+             "max_groups > 0 returns one batch, the next starts after after_value",
+             py::arg("left_prefix"), py::arg("right_prefix"),
+             py::arg("after_value") = "", py::arg("max_groups") = 0)
         .def("flush", &IndexedStorageEngine::flush,
              "Flush all dirty pages to disk")
+        .def("collect_value_log", &IndexedStorageEngine::collect_value_log,
+             "Rewrite value log segments with at most max_live_ratio live bytes, returns bytes reclaimed",
+             py::arg("max_live_ratio") = 0.5)
+        .def("get_value_log_size", &IndexedStorageEngine::get_value_log_size,
+             "Total size of the value log segments in bytes")
+        .def("get_epoch_pending", &IndexedStorageEngine::get_epoch_pending,
+             "Evicted buffer frames not yet reclaimed")
         .def("get_cache_hit_rate", &IndexedStorageEngine::get_cache_hit_rate,
              "Get buffer pool cache hit rate");
     
     // Transactional storage with WAL (Phase 3)
     py::class_<TransactionalStorageEngine>(m, "TransactionalStorageEngine")
         .def(py::init<const std::string&>())
+        .def(py::init<const std::string&, const TransactionalStorageEngine::MergeFnMap&>(),
+             py::arg("db_file"), py::arg("merge_operators"))
+        .def(py::init<const std::string&, const TransactionalStorageEngine::MergeFnMap&, size_t>(),
+             py::arg("db_file"), py::arg("merge_operators"), py::arg("value_log_threshold"))
         .def("begin_transaction", &TransactionalStorageEngine::begin_transaction,
-             "Begin a new transaction, returns transaction ID")
+             "Begin a new transaction, returns transaction ID; read-only transactions log nothing "
+             "and read a snapshot; isolation is '', 'snapshot' or 'serializable'",
+             py::arg("read_only") = false, py::arg("isolation") = "")
         .def("commit_transaction", &TransactionalStorageEngine::commit_transaction,
-             "Commit a transaction",
-             py::arg("txn_id"))
+             "Commit a transaction, returns its commit LSN (wait_durable=False: do not wait for the log flush)",
+             py::arg("txn_id"), py::arg("wait_durable") = true)
+        .def("wait_durable", &TransactionalStorageEngine::wait_durable,
+             "Flush the log up to a commit LSN",
+             py::arg("lsn"))
+        .def("get_durable_lsn", &TransactionalStorageEngine::get_durable_lsn,
+             "Highest LSN flushed to disk")
         .def("abort_transaction", &TransactionalStorageEngine::abort_transaction,
              "Abort a transaction",
              py::arg("txn_id"))
+        .def("savepoint", &TransactionalStorageEngine::savepoint,
+             "Mark a savepoint in a transaction, returns its position",
+             py::arg("txn_id"))
+        .def("rollback_to", &TransactionalStorageEngine::rollback_to,
+             "Undo the writes of a transaction made after a savepoint",
+             py::arg("txn_id"), py::arg("savepoint"))
         .def("insert", &TransactionalStorageEngine::insert,
              "Insert with auto-transaction",
              py::arg("key"), py::arg("value"))
         .def("insert_txn", &TransactionalStorageEngine::insert_txn,
              "Insert within a transaction",
              py::arg("txn_id"), py::arg("key"), py::arg("value"))
+        .def("get_with_version", &TransactionalStorageEngine::get_with_version,
+             "Get (value, version) by key; version is the LSN of the last write",
+             py::arg("key"))
+        .def("put_if_absent", &TransactionalStorageEngine::put_if_absent,
+             "Insert only if key does not exist (auto-transaction)",
+             py::arg("key"), py::arg("value"))
+        .def("put_if_absent_txn", &TransactionalStorageEngine::put_if_absent_txn,
+             "Insert only if key does not exist, within a transaction",
+             py::arg("txn_id"), py::arg("key"), py::arg("value"))
+        .def("put_if_version", &TransactionalStorageEngine::put_if_version,
+             "Overwrite only if the entry version matches (auto-transaction)",
+             py::arg("key"), py::arg("value"), py::arg("expected_version"))
+        .def("put_if_version_txn", &TransactionalStorageEngine::put_if_version_txn,
+             "Overwrite only if the entry version matches, within a transaction",
+             py::arg("txn_id"), py::arg("key"), py::arg("value"), py::arg("expected_version"))
+        .def("delete_if", &TransactionalStorageEngine::delete_if,
+             "Delete only if the entry version matches (auto-transaction)",
+             py::arg("key"), py::arg("expected_version"))
+        .def("delete_if_txn", &TransactionalStorageEngine::delete_if_txn,
+             "Delete only if the entry version matches, within a transaction",
+             py::arg("txn_id"), py::arg("key"), py::arg("expected_version"))
+        .def("merge", &TransactionalStorageEngine::merge,
+             "Merge with auto-transaction, returns the new value",
+             py::arg("key"), py::arg("operand"), py::arg("op"))
+        .def("merge_txn", &TransactionalStorageEngine::merge_txn,
+             "Merge within a transaction, returns the new value",
+             py::arg("txn_id"), py::arg("key"), py::arg("operand"), py::arg("op"))
+        .def("register_merge_operator", &TransactionalStorageEngine::register_merge_operator,
+             "Register a user-defined merge operator fn(existing, operand) -> new value",
+             py::arg("name"), py::arg("fn"))
         .def("delete", &TransactionalStorageEngine::remove,
              "Delete with auto-transaction",
              py::arg("key"))
         .def("delete_txn", &TransactionalStorageEngine::remove_txn,
              "Delete within a transaction",
              py::arg("txn_id"), py::arg("key"))
+        .def("delete_range", &TransactionalStorageEngine::delete_range,
+             "Delete all keys in range [start_key, end_key] with auto-transaction",
+             py::arg("start_key"), py::arg("end_key"))
+        .def("delete_range_txn", &TransactionalStorageEngine::delete_range_txn,
+             "Delete all keys in range [start_key, end_key] within a transaction",
+             py::arg("txn_id"), py::arg("start_key"), py::arg("end_key"))
         .def("get", &TransactionalStorageEngine::get,
              "Get value by key",
              py::arg("key"))
+        .def("get_txn", &TransactionalStorageEngine::get_txn,
+             "Get value by key as seen by a transaction",
+             py::arg("txn_id"), py::arg("key"))
         .def("range_scan", &TransactionalStorageEngine::range_scan,
              "Scan keys in range [start_key, end_key]",
              py::arg("start_key"), py::arg("end_key"))
+        .def("range_scan_txn", &TransactionalStorageEngine::range_scan_txn,
+             "Scan keys in range [start_key, end_key] as seen by a transaction",
+             py::arg("txn_id"), py::arg("start_key"), py::arg("end_key"))
+        .def("multi_range_scan", &TransactionalStorageEngine::multi_range_scan,
+             "Scan a list of (start_key, end_key) ranges in one forward pass",
+             py::arg("ranges"))
+        .def("merge_join", &TransactionalStorageEngine::merge_join,
+             "Join the keys under two prefixes on their next encoded component, "
+             "returns (join value, left entries, right entries) per matching value; "
+             "max_groups > 0 returns one batch, the next starts after after_value",
+             py::arg("left_prefix"), py::arg("right_prefix"),
+             py::arg("after_value") = "", py::arg("max_groups") = 0)
         .def("checkpoint", &TransactionalStorageEngine::checkpoint,
              "Create checkpoint and truncate WAL")
         .def("flush", &TransactionalStorageEngine::flush,
              "Flush all changes to disk")
+        .def("collect_value_log", &TransactionalStorageEngine::collect_value_log,
+             "Rewrite value log segments with at most max_live_ratio live bytes, returns bytes reclaimed",
+             py::arg("max_live_ratio") = 0.5)
+        .def("get_value_log_size", &TransactionalStorageEngine::get_value_log_size,
+             "Total size of the value log segments in bytes")
         .def("get_cache_hit_rate", &TransactionalStorageEngine::get_cache_hit_rate,
              "Get buffer pool cache hit rate")
         .def("get_last_lsn", &TransactionalStorageEngine::get_last_lsn,
-             "Get last log sequence number");
+             "Get last log sequence number")
+        .def("set_checkpoint_policy", &TransactionalStorageEngine::set_checkpoint_policy,
+             "Checkpoint automatically on WAL bytes, elapsed seconds or estimated recovery ms (0 disables each)",
+             py::arg("max_wal_bytes"), py::arg("max_interval_seconds"), py::arg("recovery_target_ms"))
+        .def("get_wal_size", &TransactionalStorageEngine::get_wal_size,
+             "Bytes in the WAL")
+        .def("get_auto_checkpoints", &TransactionalStorageEngine::get_auto_checkpoints,
+             "Number of checkpoints taken by the checkpoint policy")
+        .def("read_changes", &TransactionalStorageEngine::read_changes,
+             "Committed changes after a commit LSN as (commit_lsn, lsn, txn_id, op, key, value, merge)",
+             py::arg("after_lsn"), py::arg("max_changes") = 0)
+        .def("register_change_consumer", &TransactionalStorageEngine::register_change_consumer,
+             "Register a change consumer (keeps an existing one's position), returns its position",
+             py::arg("name"), py::arg("from_lsn") = 0)
+        .def("ack_changes", &TransactionalStorageEngine::ack_changes,
+             "Acknowledge a consumer's changes up to a commit LSN",
+             py::arg("name"), py::arg("lsn"))
+        .def("drop_change_consumer", &TransactionalStorageEngine::drop_change_consumer,
+             "Remove a change consumer and release the log it retained",
+             py::arg("name"))
+        .def("finish_recovery", &TransactionalStorageEngine::finish_recovery,
+             "Redo all keys still pending after a restart")
+        .def("get_recovery_pending", &TransactionalStorageEngine::get_recovery_pending,
+             "Number of keys not yet redone after a restart")
+        .def("collect_versions", &TransactionalStorageEngine::collect_versions,
+             "Prune versions no running snapshot can read, returns how many")
+        .def("get_version_stats", &TransactionalStorageEngine::get_version_stats,
+             "Version chain metrics (counts, longest chain, oldest snapshot lag)");
 }
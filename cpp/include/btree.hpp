@@ -3,10 +3,13 @@
 #include "page.hpp"
 #include "page_manager.hpp"
 #include "buffer_pool.hpp"
+#include "merge_operator.hpp"
+#include "value_log.hpp"
 #include <string>
 #include <vector>
 #include <optional>
 #include <memory>
+#include <functional>
 
 namespace toydb {
 
@@ -18,6 +21,11 @@ namespace toydb {
  * - All values stored in leaf nodes
  * - Internal nodes only store keys for navigation
  * - Leaf nodes are linked for range scans
+ * - Each leaf entry carries a version (sequence number of its last write)
+ * - Optionally, large values live in a ValueLog and leaves hold pointers
+ * - Leaf writes append to a small unsorted delta area after the sorted
+ *   entries; point lookups probe it before the sorted entries, scans fold
+ *   it in, and it is consolidated when full
  * 
  * B-Tree order: Max number of children per node
  * For simplicity, we'll use a small order to fit in pages
@@ -27,6 +35,13 @@ public:
     // B-Tree configuration
     static constexpr size_t ORDER = 16;  // Max 16 keys per node
     static constexpr size_t MIN_KEYS = ORDER / 2;  // Min keys (for balancing)
+    static constexpr size_t LEAF_DELTA_CAPACITY = 8;  // Delta records per leaf
+    
+    // Leaf entry: value plus the version of its last write
+    struct Entry {
+        std::string value;
+        uint64_t version;
+    };
     
     explicit BTree(BufferPool* buffer_pool, PageManager* page_manager);
     ~BTree() = default;
@@ -37,28 +52,90 @@ public:
     // Open existing B-Tree from root page ID
     void OpenTree(PageID root_id);
     
-    // Insert key-value pair
-    bool Insert(const std::string& key, const std::string& value);
+    // Insert key-value pair.
+    // version: sequence number to stamp on the entry (e.g. the WAL LSN);
+    // 0 means "previous version + 1".
+    bool Insert(const std::string& key, const std::string& value, uint64_t version = 0);
+    
+    // Merge operand into the value stored under key, in place at the leaf.
+    // If version != 0 and the entry already carries a version >= version the
+    // merge is skipped (it was applied before - used by WAL replay).
+    // Returns the value stored under key afterwards.
+    std::string Merge(const std::string& key, const std::string& operand,
+                      const MergeOperator& op, uint64_t version = 0);
     
     // Search for a key
     std::optional<std::string> Search(const std::string& key);
     
+    // Search for a key, returning value and version
+    std::optional<Entry> SearchEntry(const std::string& key);
+    
+    // Conditional writes, checked and applied at the leaf in one descent.
+    // Return false (and change nothing) when the condition does not hold.
+    bool InsertIfAbsent(const std::string& key, const std::string& value, uint64_t version = 0);
+    bool InsertIfVersion(const std::string& key, const std::string& value,
+                         uint64_t expected_version, uint64_t version = 0);
+    
+    // Computes the new entry for a key from the current one (nullptr if the
+    // key is absent). Returning nullopt leaves the leaf untouched.
+    using UpsertFn = std::function<std::optional<Entry>(const Entry* existing)>;
+    
+    // Single-descent read-modify-write of one leaf entry (fn runs at the
+    // leaf; an exception from fn leaves the entry unchanged)
+    bool Upsert(const std::string& key, const UpsertFn& fn);
+    
     // Delete a key
     bool Delete(const std::string& key);
     
+    // Delete a key only if its current version matches
+    bool DeleteIfVersion(const std::string& key, uint64_t expected_version);
+    
+    // Delete all keys in [start_key, end_key]. Subtrees that lie entirely
+    // inside the range are freed without visiting their leaves; only the
+    // two boundary paths are rewritten.
+    void DeleteRange(const std::string& start_key, const std::string& end_key);
+    
     // Range scan: get all keys between start and end (inclusive)
     std::vector<std::pair<std::string, std::string>> RangeScan(
         const std::string& start_key, 
         const std::string& end_key
     );
     
-    // Get root page ID
+    // Scan several [start, end] ranges with one forward cursor. Ranges are
+    // sorted and overlapping ones coalesced first; the cursor stays on the
+    // current leaf when the next range starts inside it and only descends
+    // to skip over keys between ranges - from the lowest node of the last
+    // descent whose key range holds the next start, so nearby ranges (batched
+    // point lookups) reread one parent rather than the whole path. Results
+    // are in key order, each key at most once.
+    std::vector<std::pair<std::string, std::string>> MultiRangeScan(
+        std::vector<std::pair<std::string, std::string>> ranges
+    );
+    
+    // Forward cursor over [start_key, end_key] holding one leaf at a time
+    // (streaming scans; see Cursor below)
+    class Cursor;
+    Cursor Seek(const std::string& start_key, const std::string& end_key);
+    
+    // Store values longer than threshold bytes in value_log (leaves keep a
+    // ValuePointer). Pointers already in the tree are resolved whenever a
+    // value log is attached, whatever the threshold.
+    void SetValueLog(ValueLog* value_log, size_t threshold);
+    
+    // Rewrite sealed value log segments whose live bytes are at most
+    // max_live_ratio of their size: live values are re-appended, pointers
+    // swapped in place and the segment removed. Returns bytes reclaimed.
+    uint64_t CollectValueLog(double max_live_ratio = 0.5);
+    
+    // Get root page ID (fixed for the lifetime of the tree)
     PageID GetRootID() const { return root_page_id_; }
 
 private:
     BufferPool* buffer_pool_;
     PageManager* page_manager_;
     PageID root_page_id_;
+    ValueLog* value_log_;
+    size_t value_threshold_;
     
     // Node types
     enum class NodeType : uint8_t {
@@ -66,6 +143,13 @@ private:
         LEAF = 1       // Leaf node
     };
     
+    // One record of a leaf delta area
+    struct Delta {
+        std::string key;
+        std::string value;
+        uint64_t version;
+    };
+    
     // B-Tree node structure (stored in pages)
     struct BTreeNode {
         NodeType type;
@@ -75,31 +159,130 @@ private:
         // Keys and values (for leaf nodes) or child pointers (for internal nodes)
         std::vector<std::string> keys;
         std::vector<std::string> values;      // Only for leaf nodes
+        std::vector<uint64_t> versions;       // Only for leaf nodes
         std::vector<PageID> children;          // Only for internal nodes
         
-        BTreeNode() : type(NodeType::LEAF), num_keys(0), next_leaf(INVALID_PAGE_ID) {}
+        // Leaf delta area on the page (set by LoadNode): it starts where
+        // the sorted entries end and holds delta_count records. Unless
+        // folded into the arrays above, the records are kept in deltas
+        // (page order, later records win).
+        std::vector<Delta> deltas;
+        uint16_t delta_count;
+        size_t delta_offset;
+        size_t delta_end;
+        
+        BTreeNode()
+            : type(NodeType::LEAF), num_keys(0), next_leaf(INVALID_PAGE_ID),
+              delta_count(0), delta_offset(0), delta_end(0) {}
     };
     
-    // Load node from page
-    BTreeNode LoadNode(PageID page_id);
+    // Load node from page. fold_deltas merges the leaf delta records into
+    // the sorted arrays; otherwise they stay in node.deltas.
+    BTreeNode LoadNode(PageID page_id, bool fold_deltas = true);
+    
+    // Merge node.deltas into the sorted arrays (one linear pass)
+    void FoldDeltas(BTreeNode& node);
+    
+    // Entry for key in a leaf loaded without folding: the last matching
+    // delta record, else a binary search of the sorted entries
+    std::optional<Entry> ProbeLeaf(const BTreeNode& node, const std::string& key);
     
-    // Save node to page
+    // Number of distinct keys in a leaf loaded without folding
+    size_t LeafKeyCount(const BTreeNode& node);
+    
+    // Save node to page (leaves are written consolidated, delta area empty)
     void SaveNode(PageID page_id, const BTreeNode& node);
     
+    // Write one leaf entry into the delta area of a loaded leaf, touching
+    // only the record and the delta header in the frame (the buffer pool
+    // still writes the page back whole). Returns false when the area is
+    // full; the caller then consolidates with SaveNode.
+    bool AppendDelta(PageID page_id, const BTreeNode& node, const std::string& key,
+                     const std::string& value, uint64_t version);
+    
     // Allocate new node
     PageID AllocateNode(NodeType type);
     
+    // Leaf representation of a value: inline, or a pointer into the value log
+    std::string StoreValue(const std::string& key, std::string value);
+    
+    // Value for a leaf representation (reads the value log for pointers)
+    std::string LoadValue(const std::string& stored);
+    
+    // Leaf entry as stored (value not resolved)
+    std::optional<Entry> SearchStored(const std::string& key);
+    
+    // Swap a stored value in place if it still equals expected
+    bool ReplaceStored(const std::string& key, const std::string& expected,
+                       const std::string& replacement);
+    
     // Search within a node (returns child index or -1)
     int SearchInNode(const BTreeNode& node, const std::string& key);
     
-    // Insert into a non-full node
-    bool InsertNonFull(PageID page_id, const std::string& key, const std::string& value);
+    // Upsert into a non-full node
+    bool UpsertNonFull(PageID page_id, const std::string& key, const UpsertFn& fn);
+    
+    // Remove key from its leaf, optionally requiring a version match
+    bool DeleteEntry(const std::string& key, std::optional<uint64_t> expected_version);
+    
+    // Range delete below page_id; depth = levels above the leaves.
+    // Returns the leftmost and rightmost boundary leaves it kept.
+    std::pair<PageID, PageID> DeleteRangeInNode(PageID page_id, size_t depth,
+                                                const std::string& start_key,
+                                                const std::string& end_key);
+    
+    // Free every page of a subtree (leaves are freed without being read)
+    void FreeSubtree(PageID page_id, size_t depth);
+    
+    // Number of internal levels above the leaves
+    size_t TreeDepth();
     
     // Split a full child node
     void SplitChild(PageID parent_id, int child_index, PageID child_id);
     
     // Find leaf node for a given key
     PageID FindLeaf(const std::string& key);
+    
+    // An internal node on a descent path, with the upper bound of the
+    // keys routed through it (none on the rightmost path)
+    struct PathLevel {
+        BTreeNode node;
+        bool bounded;
+        std::string upper;
+    };
+    
+    // FindLeaf for keys visited in ascending order: descends from the
+    // deepest node of path still routing key instead of the root, and
+    // leaves the new descent in path
+    PageID FindLeafFrom(std::vector<PathLevel>& path, const std::string& key);
+};
+
+/**
+ * BTree::Cursor - Forward iteration along the leaf chain
+ *
+ * Keeps a copy of the current leaf and follows next_leaf pointers, so
+ * memory stays at one node however long the range. The tree must not
+ * be modified while a cursor is in use.
+ */
+class BTree::Cursor {
+public:
+    bool Valid() const { return valid_; }
+    const std::string& Key() const { return leaf_.keys[pos_]; }
+    std::string Value() const { return tree_->LoadValue(leaf_.values[pos_]); }
+    void Next();
+
+private:
+    friend class BTree;
+    Cursor(BTree* tree, const std::string& start_key, std::string end_key);
+
+    // Step over exhausted leaves; invalid past end_key or the last leaf
+    void Settle();
+
+    BTree* tree_;
+    BTreeNode leaf_;
+    size_t pos_ = 0;
+    std::string end_key_;
+    bool valid_ = false;
 };
 
 } // namespace toydb
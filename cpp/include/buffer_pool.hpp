@@ -2,6 +2,8 @@
 
 #include "page.hpp"
 #include "page_manager.hpp"
+#include "epoch_manager.hpp"
+#include "wal.hpp"
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -13,21 +15,42 @@ namespace toydb {
  * BufferPool - In-memory cache for pages with LRU eviction
  * 
  * Keeps frequently accessed pages in memory to reduce disk I/O
+ * 
+ * FetchPage hands out raw frame pointers, so a fetch costs no reference
+ * count update. Frames leaving the pool (eviction, discard) are retired
+ * to the pool's EpochManager and freed once no pinned thread can still
+ * hold them: callers pin Epochs() (EpochGuard) while using a page.
+ *
+ * With a WAL attached, a dirty page is never written before the log
+ * records of its changes: MarkDirty stamps the page with the last LSN
+ * handed out (changes are logged before they are applied), and eviction
+ * and FlushDirty flush the log up to that LSN first.
  */
 class BufferPool {
 public:
     explicit BufferPool(size_t capacity, PageManager* pm);
     ~BufferPool() = default;
 
-    // Fetch page (from cache or disk)
-    std::shared_ptr<Page> FetchPage(PageID page_id);
+    // Fetch page (from cache or disk); valid while the caller stays pinned
+    Page* FetchPage(PageID page_id);
+    
+    // Log that must be flushed before a dirty page is written (optional)
+    void SetWAL(WAL* wal) { wal_ = wal; }
     
     // Mark page as dirty (needs to be written back)
     void MarkDirty(PageID page_id);
     
-    // Flush all dirty pages
+    // Flush all dirty pages (and the log up to their LSNs), then mark the
+    // pages freed since the last flush free on disk
     void FlushDirty();
     
+    // Drop a page from the cache without writing it back (page was freed)
+    void DiscardPage(PageID page_id);
+    
+    // Reclamation domain for pages handed out by FetchPage
+    EpochManager& Epochs() { return epochs_; }
+    const EpochManager& Epochs() const { return epochs_; }
+    
     // Get cache hit rate (for debugging/stats)
     double GetHitRate() const {
         size_t total = cache_hits_ + cache_misses_;
@@ -37,6 +60,8 @@ public:
 private:
     size_t capacity_;
     PageManager* page_manager_;
+    WAL* wal_ = nullptr;
+    EpochManager epochs_;
     
     // LRU tracking: most recently used at front
     std::list<PageID> lru_list_;
@@ -54,8 +79,14 @@ private:
     // Evict least recently used page
     void Evict();
     
+    // Write a dirty page back, after the log records of its changes
+    void WriteBack(const std::shared_ptr<Page>& page);
+    
     // Move page to front of LRU list (mark as recently used)
     void Touch(PageID page_id);
+    
+    // Hand a frame that left the cache to epoch reclamation
+    void Retire(std::shared_ptr<Page> page);
 };
 
 } // namespace toydb
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "wal.hpp"
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace toydb {
+
+/**
+ * ChangeFeed - Change data capture from the WAL (logical decoding)
+ *
+ * Turns WAL records into the data changes of committed transactions, in
+ * commit order. A transaction's records are held back until its COMMIT
+ * record; aborted transactions produce nothing. Every change carries the
+ * LSN of its transaction's COMMIT record, which is the stream position:
+ * a reader that has processed everything up to commit LSN p resumes with
+ * Read(p).
+ *
+ * Named consumers keep their acknowledged position in a small state file
+ * (<db>.cdc) so they can resume after a restart. While consumers exist,
+ * decoded changes stay in memory and the WAL keeps the records they came
+ * from (RetainFrom) until the slowest consumer acknowledges them.
+ */
+class ChangeFeed {
+public:
+    struct Change {
+        uint64_t commit_lsn;   // Stream position
+        uint64_t lsn;          // LSN of the change record
+        uint64_t txn_id;
+        WAL::RecordType type;  // INSERT, UPDATE, DELETE, MERGE or DELETE_RANGE
+        std::string key;       // Start key for DELETE_RANGE
+        std::string value;     // End key for DELETE_RANGE,
+                               // the record value for MERGE (see WAL::LogMerge)
+    };
+
+    explicit ChangeFeed(const std::string& state_file);
+
+    // Decode records following the ones decoded so far (LSN order)
+    void Decode(const std::vector<WAL::WALRecord>& records);
+
+    // Changes of transactions committed after after_commit_lsn, oldest
+    // first. Only whole transactions; stops once max_changes (0: no
+    // limit) is reached.
+    std::vector<Change> Read(uint64_t after_commit_lsn, size_t max_changes) const;
+
+    // Add a consumer positioned at from_lsn; an existing consumer keeps
+    // its position. Returns the position.
+    uint64_t Register(const std::string& name, uint64_t from_lsn);
+
+    // The consumer has processed everything up to commit LSN lsn
+    void Ack(const std::string& name, uint64_t lsn);
+
+    void Drop(const std::string& name);
+
+    bool HasConsumers() const { return !consumers_.empty(); }
+
+    // Lowest LSN the WAL has to keep for consumers (UINT64_MAX: none)
+    uint64_t RetainFrom() const;
+
+    // Forget decoded changes (the log was truncated without retention)
+    void Reset();
+
+private:
+    std::string state_file_;
+    std::map<std::string, uint64_t> consumers_;               // Name -> acknowledged LSN
+    std::deque<Change> changes_;                              // Committed, in commit order
+    std::unordered_map<uint64_t, std::vector<Change>> open_;  // Uncommitted, per txn
+    uint64_t decoded_lsn_ = 0;                                // Last record decoded
+
+    // Drop changes every consumer has acknowledged
+    void Trim();
+
+    void LoadState();
+    void SaveState() const;
+};
+
+} // namespace toydb
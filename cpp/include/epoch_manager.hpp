@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace toydb {
+
+/**
+ * EpochManager - Epoch-based memory reclamation
+ *
+ * Lets readers use raw pointers into shared structures (buffer frames)
+ * without reference counting. A thread pins the manager for the duration
+ * of an operation; objects unlinked meanwhile are retired rather than
+ * deleted and only freed once every thread that could still see them has
+ * unpinned.
+ *
+ * - A global epoch advances when every pinned thread has observed it
+ * - Each thread publishes the epoch it pinned in its own slot
+ * - Retired objects wait in the retiring thread's limbo list, tagged
+ *   with the epoch at retirement; once the global epoch is two past
+ *   that tag no pinned thread can hold them and they are freed
+ * - Limbo lists are collected in batches of COLLECT_BATCH retirements;
+ *   an advance also frees what has expired in other threads' lists, so
+ *   the lists of exited threads do not wait for their slot to be reused
+ *
+ * Threads get a slot on first use and give it back when they exit; at
+ * most MAX_THREADS threads can use a manager at the same time.
+ */
+class EpochManager {
+public:
+    static constexpr size_t MAX_THREADS = 128;
+    static constexpr size_t COLLECT_BATCH = 64;
+
+    EpochManager() = default;
+    ~EpochManager() = default;
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    // Enter / leave a critical section (nestable per thread)
+    void Pin();
+    void Unpin();
+
+    // Drop this reference to object once no pinned thread can reach it
+    void Retire(std::shared_ptr<void> object);
+
+    template <typename T>
+    void Retire(T* ptr) {
+        Retire(std::shared_ptr<T>(ptr));
+    }
+
+    // Advance the epoch if possible and free what is safe on this thread
+    void Collect();
+
+    uint64_t CurrentEpoch() const { return global_epoch_.load(std::memory_order_acquire); }
+
+    // Objects retired but not yet freed (all threads)
+    size_t PendingCount() const { return pending_.load(std::memory_order_relaxed); }
+
+private:
+    struct Retired {
+        uint64_t epoch;
+        std::shared_ptr<void> object;
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0};  // Pinned epoch, 0 when not pinned
+        uint32_t depth = 0;              // Nesting (owner thread only)
+        std::mutex limbo_mutex;          // Owner appends, any collector frees
+        std::vector<Retired> limbo;
+        std::atomic<size_t> limbo_size{0};
+        size_t collect_at = COLLECT_BATCH;  // Owner thread only
+    };
+
+    std::atomic<uint64_t> global_epoch_{1};
+    std::atomic<size_t> pending_{0};
+    std::array<Slot, MAX_THREADS> slots_;
+
+    Slot& LocalSlot();
+
+    // Move the global epoch forward if every pinned thread has seen it,
+    // then free what expired in the other threads' limbo lists
+    void TryAdvance(const Slot& own);
+
+    // Free limbo entries at least two epochs old (skips the slot if
+    // another thread is collecting it and wait is false)
+    void FreeExpired(Slot& slot, bool wait);
+};
+
+/**
+ * EpochGuard - RAII pin of an EpochManager
+ */
+class EpochGuard {
+public:
+    explicit EpochGuard(EpochManager& epochs) : epochs_(epochs) { epochs_.Pin(); }
+    ~EpochGuard() { epochs_.Unpin(); }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+private:
+    EpochManager& epochs_;
+};
+
+} // namespace toydb
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "key_encoder.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace toydb {
+
+/**
+ * ExprProgram - Register-based bytecode for row predicates
+ *
+ * WHERE, JOIN ON and HAVING expressions are compiled once per query
+ * (toydb/expressions.py) and evaluated here over batches of rows. A row
+ * is a tuple of decoded column values; the compiler maps every column
+ * reference to a slot of that tuple.
+ *
+ * There are two register files: value registers point at a row slot or
+ * a constant (nothing is copied), flag registers hold comparison
+ * results. AND / OR compile to conditional jumps, so the right operand
+ * is skipped once the result is known:
+ *
+ *   a > 30 AND name = 'x'     LOAD_COLUMN v0 <- row[0]
+ *                             LOAD_COLUMN v1 <- row[1]
+ *                             LOAD_CONST  v2 <- 30
+ *                             LOAD_CONST  v3 <- 'x'
+ *                             GT_INT      f0 <- v0 > v2
+ *                             JUMP_IF_FALSE f0 -> 7
+ *                             EQ_TEXT     f0 <- v1 = v3
+ *                             RETURN      f0
+ *
+ * Typed comparisons (INT, TEXT) are picked by the compiler from column
+ * and constant types; they fall back to the generic comparison when an
+ * operand has another type at run time. Generic comparisons keep the
+ * executor's rules: INT and FLOAT compare by value, text that looks
+ * numeric compares as a number if coerce_numeric_text is set, equality
+ * across other types is false and ordering across them throws.
+ */
+class ExprProgram {
+public:
+    using Value = KeyEncoder::Value;
+
+    enum class Op : uint8_t {
+        LOAD_COLUMN,    // v[dst] = row[a]
+        LOAD_CONST,     // v[dst] = constant a
+        EQ, NE, LT, LE, GT, GE,                          // f[dst] = v[a] op v[b]
+        EQ_INT, NE_INT, LT_INT, LE_INT, GT_INT, GE_INT,  // Both INT
+        EQ_TEXT, NE_TEXT,                                // Both TEXT, no coercion
+        IN_LIST,        // f[dst] = v[a] equals a value of list b
+        TRUTHY,         // f[dst] = v[a] is not NULL, 0 or ''
+        JUMP_IF_FALSE,  // if !f[a] goto b
+        JUMP_IF_TRUE,   // if f[a] goto b
+        RETURN,         // result f[a]
+    };
+
+    struct Instruction {
+        Op op;
+        uint16_t dst;
+        uint16_t a;
+        uint16_t b;
+    };
+
+    explicit ExprProgram(bool coerce_numeric_text = true);
+
+    // Building; the returned index is the operand of LOAD_CONST / IN_LIST
+    uint16_t AddConstant(const Value& value);
+    uint16_t AddList(const std::vector<Value>& values);
+
+    // Append an instruction, returns its address (jump target)
+    uint16_t Emit(Op op, uint16_t dst = 0, uint16_t a = 0, uint16_t b = 0);
+
+    // Point the jump at address to target
+    void Patch(uint16_t address, uint16_t target);
+
+    size_t Size() const { return code_.size(); }
+
+    // Evaluate for one row
+    bool Evaluate(const std::vector<Value>& row) const;
+
+    // Indexes of the rows the predicate holds for, in order
+    std::vector<size_t> Filter(const std::vector<std::vector<Value>>& rows) const;
+
+private:
+    // Registers reused across the rows of a batch
+    struct Registers {
+        std::vector<const Value*> values;
+        std::vector<uint8_t> flags;
+    };
+
+    Registers NewRegisters() const;
+    bool Run(const std::vector<Value>& row, Registers& regs) const;
+
+    bool coerce_numeric_text_;
+    std::vector<Instruction> code_;
+    std::vector<Value> constants_;
+    std::vector<std::vector<Value>> lists_;
+    size_t num_values_ = 0;
+    size_t num_flags_ = 0;
+};
+
+} // namespace toydb
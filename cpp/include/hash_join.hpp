@@ -0,0 +1,42 @@
+#pragma once
+
+#include "key_encoder.hpp"
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace toydb {
+
+/**
+ * HashJoin - Equi-join of two in-memory inputs on one or more key columns
+ *
+ * The build side's key tuples are hashed into buckets once; every probe
+ * tuple then checks only its bucket. Keys match under the plain equality
+ * JOIN ON uses (see ExprProgram with coerce_numeric_text off): INT and
+ * FLOAT by value, TEXT by bytes, NULL only NULL; text that looks numeric
+ * is not a number.
+ */
+class HashJoin {
+public:
+    using Value = KeyEncoder::Value;
+    using Key = std::vector<Value>;
+
+    explicit HashJoin(std::vector<Key> build);
+
+    // (build index, probe index) of every matching pair, in probe order
+    std::vector<std::pair<size_t, size_t>> Probe(const std::vector<Key>& probe) const;
+
+    // Build on one input, probe with the other
+    static std::vector<std::pair<size_t, size_t>> Join(std::vector<Key> build,
+                                                      const std::vector<Key>& probe);
+
+private:
+    static size_t Hash(const Key& key);
+    static bool Equal(const Key& a, const Key& b);
+
+    std::vector<Key> build_;
+    std::unordered_map<size_t, std::vector<size_t>> buckets_;  // Hash -> build indexes
+};
+
+} // namespace toydb
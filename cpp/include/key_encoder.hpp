@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <variant>
+#include <cstdint>
+
+namespace toydb {
+
+/**
+ * KeyEncoder - Order-preserving (memcomparable) encoding of typed tuples
+ *
+ * Encodes a tuple of (NULL, INT, FLOAT, TEXT) values into a byte string
+ * whose plain byte order (std::string / memcmp) equals the tuple order,
+ * so composite index keys need no custom comparator in the B-Tree:
+ *
+ *   NULL  -> TAG_NULL                       (sorts before any value)
+ *   INT   -> TAG_INT   + 16 hex digits of (v XOR sign bit), big-endian
+ *   FLOAT -> TAG_FLOAT + 16 hex digits of the IEEE-754 bits, sign-flipped
+ *            (negative: all bits inverted, positive: sign bit set)
+ *   TEXT  -> TAG_TEXT  + bytes, 0x00 escaped as 0x00 0x01, ends 0x00 0x00
+ *
+ * Numbers are hex-armored and tags are ASCII, so an encoded key is valid
+ * UTF-8 whenever its TEXT components are (keys round-trip through Python
+ * str). Every component starts with a tag below '~', so prefix + "~" is
+ * an upper bound for all keys extending an encoded prefix.
+ */
+class KeyEncoder {
+public:
+    using Value = std::variant<std::monostate, int64_t, double, std::string>;
+
+    static constexpr char TAG_NULL = 0x01;
+    static constexpr char TAG_INT = 0x02;
+    static constexpr char TAG_FLOAT = 0x03;
+    static constexpr char TAG_TEXT = 0x04;
+
+    // Append one component to the key being built
+    KeyEncoder& AppendNull();
+    KeyEncoder& AppendInt(int64_t value);
+    KeyEncoder& AppendFloat(double value);
+    KeyEncoder& AppendText(const std::string& value);
+    KeyEncoder& Append(const Value& value);
+
+    // Encoded key so far
+    const std::string& Key() const { return key_; }
+
+    // Encode a whole tuple
+    static std::string Encode(const std::vector<Value>& values);
+
+    // Decode an encoded key back into its tuple (throws on malformed input)
+    static std::vector<Value> Decode(const std::string& key);
+
+    // Length of the encoded component starting at pos (throws on malformed input)
+    static size_t ComponentSize(const std::string& key, size_t pos);
+
+private:
+    void AppendHex64(uint64_t bits);
+
+    std::string key_;
+};
+
+} // namespace toydb
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "btree.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace toydb {
+
+/**
+ * MergeJoin - Equi-join of two key ranges already sorted on the join value
+ *
+ * Each input is every key under a prefix whose next component (see
+ * KeyEncoder) is the join value, e.g. the entries of an index led by the
+ * join column:
+ *
+ *   __index__:idx_users_id:     <id>      <row id>...
+ *   __index__:idx_orders_user:  <user_id> <row id>...
+ *
+ * Encoded keys sort by value, so both inputs are streamed in lockstep
+ * through B+Tree cursors: the side with the smaller join value advances,
+ * and equal values form a group. Only the current group is buffered, so
+ * memory does not depend on the size of either input; callers that hand
+ * groups on in batches resume a new join after the last value they saw
+ * (after_value) instead of collecting every group. Join values are
+ * compared as encoded bytes: INT 1 and FLOAT 1.0 do not match, and NULLs
+ * do match each other (callers filter them out).
+ */
+class MergeJoin {
+public:
+    using Entry = std::pair<std::string, std::string>;
+
+    // Entries of both sides sharing one join value
+    struct Group {
+        std::vector<Entry> left;
+        std::vector<Entry> right;
+    };
+
+    // after_value: start with the first join value above it (empty: with
+    // the first join value)
+    MergeJoin(BTree* left_tree, const std::string& left_prefix,
+              BTree* right_tree, const std::string& right_prefix,
+              const std::string& after_value = "");
+
+    // Next group of matching entries; false once either side is exhausted
+    bool Next(Group& group);
+
+    // Encoded join value of key: the component right after prefix_size
+    static std::string JoinValue(const std::string& key, size_t prefix_size);
+
+private:
+    BTree::Cursor left_;
+    BTree::Cursor right_;
+    size_t left_prefix_size_;
+    size_t right_prefix_size_;
+};
+
+} // namespace toydb
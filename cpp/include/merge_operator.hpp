@@ -0,0 +1,134 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+
+namespace toydb {
+
+/**
+ * MergeOperator - Read-modify-write applied in place at the B-Tree leaf
+ *
+ * A merge combines the value currently stored under a key (if any) with
+ * an operand and returns the new value. The engine logs only the operand,
+ * so counters and append-only lists avoid a get/insert round trip.
+ *
+ * Merge() must be deterministic: recovery replays logged operands through
+ * the same operator. It may throw to reject an operand (the write is then
+ * not applied).
+ */
+class MergeOperator {
+public:
+    virtual ~MergeOperator() = default;
+
+    // Name used to look the operator up (and stored in the WAL)
+    virtual std::string Name() const = 0;
+
+    // Combine existing value (nullopt if key absent) with operand
+    virtual std::string Merge(const std::optional<std::string>& existing,
+                              const std::string& operand) const = 0;
+};
+
+/**
+ * "add" - 64-bit integer addition on decimal strings (a sum that would
+ * overflow rejects the operand)
+ */
+class IntAddOperator : public MergeOperator {
+public:
+    std::string Name() const override { return "add"; }
+    std::string Merge(const std::optional<std::string>& existing,
+                      const std::string& operand) const override;
+};
+
+/**
+ * "max" - Keep the larger of two 64-bit integers
+ */
+class IntMaxOperator : public MergeOperator {
+public:
+    std::string Name() const override { return "max"; }
+    std::string Merge(const std::optional<std::string>& existing,
+                      const std::string& operand) const override;
+};
+
+/**
+ * "append" - Append operand to the existing string, separated by a delimiter
+ */
+class StringAppendOperator : public MergeOperator {
+public:
+    explicit StringAppendOperator(std::string delimiter = ",")
+        : delimiter_(std::move(delimiter)) {}
+
+    std::string Name() const override { return "append"; }
+    std::string Merge(const std::optional<std::string>& existing,
+                      const std::string& operand) const override;
+
+private:
+    std::string delimiter_;
+};
+
+/**
+ * "posting_add" / "posting_remove" - Add or remove a decimal row ID in a
+ * PostingList-encoded value (non-unique secondary index entries)
+ */
+class PostingAddOperator : public MergeOperator {
+public:
+    std::string Name() const override { return "posting_add"; }
+    std::string Merge(const std::optional<std::string>& existing,
+                      const std::string& operand) const override;
+};
+
+class PostingRemoveOperator : public MergeOperator {
+public:
+    std::string Name() const override { return "posting_remove"; }
+    std::string Merge(const std::optional<std::string>& existing,
+                      const std::string& operand) const override;
+};
+
+/**
+ * User-defined merge operator backed by a callable
+ */
+class FunctionMergeOperator : public MergeOperator {
+public:
+    using MergeFn = std::function<std::string(const std::optional<std::string>&,
+                                              const std::string&)>;
+
+    FunctionMergeOperator(std::string name, MergeFn fn)
+        : name_(std::move(name)), fn_(std::move(fn)) {}
+
+    std::string Name() const override { return name_; }
+    std::string Merge(const std::optional<std::string>& existing,
+                      const std::string& operand) const override {
+        return fn_(existing, operand);
+    }
+
+private:
+    std::string name_;
+    MergeFn fn_;
+};
+
+/**
+ * MergeOperatorRegistry - Name -> operator lookup
+ *
+ * Built-in operators (add, max, append, posting_add, posting_remove)
+ * are always registered.
+ */
+class MergeOperatorRegistry {
+public:
+    MergeOperatorRegistry();
+
+    // Register (or replace) an operator under its Name()
+    void Register(std::shared_ptr<MergeOperator> op);
+
+    // Find operator by name (nullptr if unknown)
+    const MergeOperator* Find(const std::string& name) const;
+
+    // Find operator by name, throws if unknown
+    const MergeOperator& Get(const std::string& name) const;
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<MergeOperator>> operators_;
+};
+
+} // namespace toydb
@@ -46,6 +46,11 @@ public:
     char* GetData() { return data_.get(); }
     const char* GetData() const { return data_.get(); }
 
+    // LSN of the last logged change applied to the page (kept in memory
+    // only: the log must be flushed up to it before the page is written)
+    uint64_t GetLSN() const { return lsn_; }
+    void SetLSN(uint64_t lsn) { lsn_ = lsn; }
+
     // Get header
     Header& GetHeader() { return header_; }
     const Header& GetHeader() const { return header_; }
@@ -64,6 +69,7 @@ public:
 
 private:
     Header header_;
+    uint64_t lsn_ = 0;
     std::unique_ptr<char[]> data_;  // 4KB data buffer
 };
 
@@ -4,6 +4,8 @@
 #include <string>
 #include <fstream>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <memory>
 
 namespace toydb {
@@ -21,9 +23,19 @@ public:
     explicit PageManager(const std::string& db_file);
     ~PageManager();
 
-    // Allocate a new page
+    // Allocate a new page (reuses freed pages first)
     PageID AllocatePage();
     
+    // Return a page to the free list. Its free marker reaches the disk
+    // with the next WriteFreePages; opening the file rebuilds the list
+    // from those markers.
+    void FreePage(PageID page_id);
+    
+    // Mark pages freed since the last call as free on disk. Called once
+    // the pages that referenced them are written, so a crash leaks a
+    // freed page at worst and never reuses one still linked in.
+    void WriteFreePages();
+    
     // Read page from disk
     std::shared_ptr<Page> ReadPage(PageID page_id);
     
@@ -40,12 +52,19 @@ private:
     std::string db_file_;
     std::fstream file_;
     PageID next_page_id_;  // Next available page ID
+    std::vector<PageID> free_pages_;  // Freed pages available for reuse
+    std::unordered_set<PageID> unmarked_free_;  // Free, marker not on disk yet
     
-    // Simple cache: page_id -> Page
+    // Pages allocated but not yet written: page_id -> Page. Served by
+    // ReadPage until the first write; afterwards the disk copy is current
+    // and the buffer pool decides how long the page stays in memory.
     std::unordered_map<PageID, std::shared_ptr<Page>> cache_;
     
     // Open/create database file
     void OpenOrCreateFile();
+    
+    // Rebuild the free list from the page headers on disk
+    void LoadFreePages();
 };
 
 } // namespace toydb
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace toydb {
+
+/**
+ * PostingList - Compressed sorted list of row IDs
+ *
+ * Non-unique secondary indexes store one key per distinct column value
+ * followed by the row IDs holding it. IDs are sorted, deduplicated and
+ * delta-encoded (first ID absolute, then gaps), each number written as a
+ * little-endian base-32 varint in printable ASCII:
+ *
+ *   '0'..'O'  5 payload bits, more digits follow
+ *   'P'..'o'  5 payload bits, last digit of the number
+ *
+ * Gaps between nearby rows take 2-3 bytes instead of a full key each,
+ * and the encoding stays valid UTF-8 (values round-trip through Python).
+ */
+class PostingList {
+public:
+    // Encode IDs (sorted and deduplicated first)
+    static std::string Encode(std::vector<uint64_t> ids);
+
+    // Decode into sorted IDs (throws on malformed input)
+    static std::vector<uint64_t> Decode(const std::string& data);
+
+    // Add / remove one ID, returns the new encoding
+    static std::string Add(const std::string& data, uint64_t id);
+    static std::string Remove(const std::string& data, uint64_t id);
+
+private:
+    static void AppendVarint(std::string& out, uint64_t value);
+};
+
+} // namespace toydb
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+
+namespace toydb {
+
+/**
+ * SnapshotManager - Snapshot reads and serializable snapshot isolation
+ *
+ * Writers update B-Tree entries in place. Each write first records the
+ * committed value it replaces as a version of the key, pending while the
+ * writer is open and ending at the writer's commit sequence number once
+ * it commits. A snapshot transaction sees, for every key, the oldest
+ * version that ended after its snapshot was taken, or the tree value
+ * when there is none. Concurrent snapshot writers of one key conflict
+ * (first updater wins).
+ *
+ * Serializable transactions also take SIREAD locks on the keys and
+ * ranges they read. Reading past a newer version, or writing a key a
+ * concurrent transaction holds a SIREAD lock on, is an rw-antidependency
+ * reader -> writer. A transaction with both an incoming and an outgoing
+ * rw-antidependency is the pivot of a possible write-skew cycle and is
+ * aborted; all other transactions commit as under snapshot isolation.
+ * SIREAD locks of a committed transaction live on until no transaction
+ * that overlapped it is running.
+ *
+ * Transactions begun without an isolation level are not tracked: they
+ * read the tree and are never aborted here, but their writes still
+ * become versions so snapshot readers do not see them early.
+ *
+ * Version GC: a committed version that ended at or before the oldest
+ * running snapshot can never be read again. Such versions are pruned
+ * from every chain a read or write touches, by an optional sweeper
+ * thread that walks a bounded number of chains per pass, and all at once
+ * when no snapshot is running. GetVersionStats() reports chain lengths
+ * and how far the oldest snapshot lags, which points at long-running
+ * transactions holding versions back.
+ *
+ * All public methods are thread-safe (one mutex).
+ */
+class SnapshotManager {
+public:
+    enum class Isolation : uint8_t {
+        NONE = 0,          // Reads see the latest tree state
+        SNAPSHOT = 1,      // Reads see commits made before begin
+        SERIALIZABLE = 2   // Snapshot reads + rw-antidependency checks
+    };
+
+    struct VersionStats {
+        size_t versions;             // Versions kept (pending and committed)
+        size_t keys;                 // Keys with at least one version
+        size_t max_chain_length;     // Longest version chain
+        uint64_t oldest_snapshot_lag;  // Commits since the oldest running snapshot
+        uint64_t oldest_snapshot_txn;  // Transaction holding it (0: none running)
+        uint64_t pruned;             // Versions reclaimed so far
+    };
+
+    SnapshotManager() = default;
+    ~SnapshotManager();
+
+    // Parse "", "snapshot" or "serializable"
+    static Isolation ParseIsolation(const std::string& name);
+
+    // Start tracking a transaction at the current commit sequence number
+    void Begin(uint64_t txn_id, Isolation isolation);
+
+    // Whether a transaction reads from a snapshot
+    bool IsTracked(uint64_t txn_id) const;
+
+    // Whether writers outside explicit transactions must record versions
+    // (a snapshot transaction is running)
+    bool VersionsNeeded() const;
+
+    // Throw if txn_id may not write key: another transaction has an
+    // uncommitted write of it, a snapshot writer would overwrite a commit
+    // it cannot see, or the write would complete a dangerous structure
+    void CheckWrite(uint64_t txn_id, const std::string& key) const;
+
+    // Record a write of key by txn_id; before is the committed value it
+    // replaces (nullopt: key absent). Only the first write per key counts.
+    void RecordWrite(uint64_t txn_id, const std::string& key,
+                     const std::optional<std::string>& before);
+
+    // Version of key visible to txn_id, or nullopt when the tree value is
+    // visible. The inner nullopt means the key did not exist. Takes a
+    // SIREAD lock for serializable transactions (may throw).
+    std::optional<std::optional<std::string>> Read(uint64_t txn_id, const std::string& key);
+
+    // Replace the tree rows of a range scan of [start_key, end_key] with
+    // the versions visible to txn_id. Locks the whole range.
+    void ReadRange(uint64_t txn_id, const std::string& start_key, const std::string& end_key,
+                   std::vector<std::pair<std::string, std::string>>& rows);
+
+    // False if a serializable transaction must abort instead of commit
+    bool CanCommit(uint64_t txn_id) const;
+
+    // Finish a transaction: its pending versions end at a new commit
+    // sequence number (Commit) or are dropped (Abort)
+    void Commit(uint64_t txn_id);
+    void Abort(uint64_t txn_id);
+
+    // Versions currently kept (pending and committed)
+    size_t VersionCount() const;
+
+    VersionStats GetVersionStats() const;
+
+    // Prune unreadable versions from up to max_keys chains, continuing
+    // where the last call stopped (0: all chains). Returns versions pruned.
+    size_t CollectVersions(size_t max_keys = 0);
+
+    // Run CollectVersions(keys_per_pass) every interval on a background
+    // thread until StopSweeper() or destruction
+    void StartSweeper(std::chrono::milliseconds interval, size_t keys_per_pass);
+    void StopSweeper();
+
+private:
+    static constexpr uint64_t PENDING = UINT64_MAX;
+
+    struct Version {
+        std::optional<std::string> value;  // nullopt: key absent
+        uint64_t end_seq;                  // Commit that replaced it (PENDING while open)
+        uint64_t writer;                   // Transaction that replaced it
+    };
+
+    struct TxnState {
+        Isolation isolation = Isolation::NONE;
+        uint64_t snapshot_seq = 0;
+        uint64_t commit_seq = 0;      // Set once committed
+        std::set<uint64_t> in_conflicts;   // Concurrent txns that read past our writes
+        std::set<uint64_t> out_conflicts;  // Concurrent txns whose writes we read past
+        std::set<std::string> read_keys;
+        std::vector<std::pair<std::string, std::string>> read_ranges;
+    };
+
+    mutable std::mutex mutex_;
+    uint64_t commit_seq_ = 0;
+    size_t active_ = 0;                                     // Running tracked txns
+    uint64_t oldest_snapshot_ = UINT64_MAX;                 // Of running tracked txns
+    size_t committed_versions_ = 0;                         // Versions no longer pending
+    uint64_t pruned_ = 0;
+    std::string sweep_cursor_;                              // Next chain to sweep
+    std::map<std::string, std::vector<Version>> versions_;  // Ordered by end_seq
+    std::unordered_map<uint64_t, TxnState> txns_;           // Tracked txns (and committed
+                                                            // ones still overlapping)
+    std::unordered_map<uint64_t, std::vector<std::string>> pending_;  // Keys written per txn
+
+    std::thread sweeper_;
+    std::mutex sweeper_mutex_;
+    std::condition_variable sweeper_cv_;
+    bool sweeper_stop_ = false;
+
+    // Visible version of key at a snapshot (nullptr: tree value)
+    const Version* Visible(const std::vector<Version>& chain, uint64_t txn_id,
+                           uint64_t snapshot_seq) const;
+
+    // Whether an rw-antidependency reader -> writer would complete a
+    // dangerous structure around an already committed transaction
+    bool CompletesPivot(uint64_t reader, uint64_t writer) const;
+
+    // Record an rw-antidependency reader -> writer
+    void MarkConflict(uint64_t reader, uint64_t writer);
+
+    // Whether a committed txn overlapped txn_id (or txn_id is running)
+    bool Concurrent(const TxnState& other, uint64_t txn_id) const;
+
+    bool Locked(const TxnState& state, const std::string& key) const;
+
+    // Drop committed txn states no running txn overlaps; drop all
+    // committed versions when no snapshot is running
+    void Prune();
+
+    // Recompute oldest_snapshot_ after a tracked txn begins or ends
+    void UpdateOldestSnapshot();
+
+    // Remove committed versions that ended at or before the oldest
+    // running snapshot from one chain; returns how many
+    size_t PruneChain(std::vector<Version>& chain);
+};
+
+} // namespace toydb
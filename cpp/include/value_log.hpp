@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace toydb {
+
+// Location of a value in the value log
+struct ValuePointer {
+    uint32_t segment;  // Segment file number
+    uint64_t offset;   // Offset of the value bytes within the segment
+    uint32_t length;   // Value length
+};
+
+/**
+ * ValueLog - Append-only storage for large values (key-value separation)
+ *
+ * Large values are appended here and B-Tree leaves keep a small
+ * ValuePointer instead, so leaves stay dense and splits, scans and range
+ * deletes move pointers rather than payloads.
+ *
+ * The log is a series of segment files <base>.<n>. Records are written
+ * to the active segment; once it grows past the segment size (SEGMENT_SIZE
+ * unless configured) a new one is
+ * started. Record layout:
+ *
+ *   [key_len: u32][value_len: u32][key][value]
+ *
+ * The key lets garbage collection ask the tree whether a record is still
+ * referenced. Overwritten and deleted values become garbage in place;
+ * collecting a sealed segment re-appends its live records and removes
+ * the file.
+ */
+class ValueLog {
+public:
+    static constexpr uint64_t SEGMENT_SIZE = 4 * 1024 * 1024;
+
+    struct Record {
+        std::string key;
+        ValuePointer pointer;
+        std::string value;
+    };
+
+    // Opens existing segments; no file is created until the first append.
+    // segment_size: bytes after which a new segment is started (0: SEGMENT_SIZE)
+    explicit ValueLog(const std::string& base_path, uint64_t segment_size = 0);
+    ~ValueLog();
+
+    // Append a value, written through to the OS before returning so no
+    // leaf can reference bytes that are not in the file
+    ValuePointer Append(const std::string& key, const std::string& value);
+
+    // Read the value a pointer refers to
+    std::string Read(const ValuePointer& pointer);
+
+    // Segments no longer appended to (candidates for collection)
+    std::vector<uint32_t> SealedSegments() const;
+
+    // All complete records of a segment, in file order
+    std::vector<Record> ReadSegment(uint32_t segment);
+
+    // Size in bytes of a segment (0 if unknown)
+    uint64_t SegmentSize(uint32_t segment) const;
+
+    // Delete a segment file (after its live records were moved)
+    void DropSegment(uint32_t segment);
+
+    // Bytes across all segments, live or not
+    uint64_t TotalSize() const;
+
+    // Force appended records to disk
+    void Flush();
+
+private:
+    std::string base_path_;
+    uint64_t segment_size_;
+    std::map<uint32_t, uint64_t> segments_;  // segment -> size
+    uint32_t active_segment_;
+    std::ofstream writer_;
+    std::map<uint32_t, std::unique_ptr<std::ifstream>> readers_;
+
+    std::string SegmentPath(uint32_t segment) const;
+
+    // Start appending to a new segment
+    void OpenActive(uint32_t segment);
+
+    // Cached read handle for a segment
+    std::ifstream& Reader(uint32_t segment);
+};
+
+} // namespace toydb
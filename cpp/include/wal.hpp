@@ -1,8 +1,12 @@
 #pragma once
 
 #include "page.hpp"
+#include <array>
+#include <atomic>
 #include <string>
 #include <fstream>
+#include <mutex>
+#include <optional>
 #include <vector>
 #include <cstdint>
 
@@ -16,9 +20,16 @@ namespace toydb {
  * 
  * WAL Protocol:
  * 1. Write operation to log
- * 2. Flush log to disk
- * 3. Apply operation to database
+ * 2. Apply operation to database
+ * 3. Flush log to disk up to the COMMIT record (FlushTo)
  * 4. Checkpoint periodically
+ *
+ * Records are appended to one of LOG_STRIPES in-memory buffers picked by
+ * the calling thread, so concurrent writers do not contend on one append
+ * point. LSNs come from a global atomic counter, taken while holding the
+ * stripe lock; Flush locks every stripe, merges their records by LSN and
+ * writes them out. Every LSN handed out before a flush is therefore in
+ * that flush, and the file stays in LSN order.
  */
 class WAL {
 public:
@@ -30,7 +41,10 @@ public:
         CHECKPOINT = 4,
         BEGIN_TXN = 5,
         COMMIT_TXN = 6,
-        ABORT_TXN = 7
+        ABORT_TXN = 7,
+        MERGE = 8,         // value = operator name + '\0' + operand + result (see LogMerge)
+        DELETE_RANGE = 9,  // key = start key, value = end key (inclusive)
+        UNDO = 10          // value = before-image of key (see LogUndo)
     };
     
     // WAL record structure
@@ -61,6 +75,26 @@ public:
                        const std::string& key, const std::string& value);
     uint64_t LogDelete(uint64_t txn_id, PageID page_id,
                        const std::string& key);
+    // MERGE: the operand (recovery reapplies it) and the merged value
+    // (for change data capture)
+    uint64_t LogMerge(uint64_t txn_id, PageID page_id,
+                      const std::string& key, const std::string& op_name,
+                      const std::string& operand, const std::string& result);
+    uint64_t LogDeleteRange(uint64_t txn_id, PageID page_id,
+                            const std::string& start_key, const std::string& end_key);
+    
+    // Split a MERGE record value into operator name, operand and result
+    static void DecodeMerge(const WALRecord& record, std::string& op_name,
+                            std::string& operand, std::string& result);
+    
+    // Before-image of key for a write of an explicit transaction, logged
+    // after the write so recovery can roll it back if the transaction
+    // never commits. before_value nullopt: the key did not exist.
+    uint64_t LogUndo(uint64_t txn_id, PageID page_id, const std::string& key,
+                     const std::optional<std::string>& before_value, uint64_t before_version);
+    
+    // Split an UNDO record value; returns false if the key did not exist
+    static bool DecodeUndo(const WALRecord& record, std::string& value, uint64_t& version);
     
     // Transaction operations
     uint64_t LogBeginTxn(uint64_t txn_id);
@@ -73,21 +107,60 @@ public:
     // Force log to disk
     void Flush();
     
+    // Force log to disk unless every record up to lsn already is
+    void FlushTo(uint64_t lsn);
+    
+    // Highest LSN known to be on disk
+    uint64_t GetFlushedLSN() const { return flushed_lsn_.load(std::memory_order_acquire); }
+    
     // Recovery
     std::vector<WALRecord> ReadLog();
-    uint64_t GetLastLSN() const { return current_lsn_; }
     
-    // Truncate log (after checkpoint)
-    void Truncate();
+    // Complete records from byte offset on, up to max_lsn; offset is
+    // advanced past them so the next call continues where this one stopped
+    std::vector<WALRecord> ReadLog(uint64_t& offset, uint64_t max_lsn = UINT64_MAX);
+    uint64_t GetLastLSN() const { return current_lsn_.load(std::memory_order_acquire); }
+    
+    // LSN the next logged record will receive
+    uint64_t NextLSN() const { return GetLastLSN() + 1; }
+    
+    // Bytes in the log (written and buffered)
+    uint64_t GetSize() const { return size_.load(std::memory_order_relaxed); }
+    
+    // Truncate log (after checkpoint). LSNs keep increasing across
+    // truncation since they are stamped on B-Tree entries as versions.
+    // Records from keep_from_lsn on are kept ahead of the new checkpoint
+    // record (recovery skips them; change data capture still reads them).
+    void Truncate(uint64_t keep_from_lsn = UINT64_MAX);
 
 private:
+    static constexpr size_t LOG_STRIPES = 16;
+    
+    // Per-thread append buffer: serialized records in LSN order
+    struct alignas(64) Stripe {
+        std::mutex mutex;
+        std::vector<char> data;
+        std::vector<std::pair<uint64_t, size_t>> records;  // (LSN, offset in data)
+    };
+    
     std::string wal_file_;
     std::fstream log_;
-    uint64_t current_lsn_;
+    std::mutex file_mutex_;             // Serializes flushes and file access
+    std::atomic<uint64_t> current_lsn_;
+    std::atomic<uint64_t> flushed_lsn_;
+    std::atomic<uint64_t> size_;
+    std::array<Stripe, LOG_STRIPES> stripes_;
     
     // Internal logging
     uint64_t WriteRecord(const WALRecord& record);
     
+    // Stripe of the calling thread
+    Stripe& LocalStripe();
+    
+    // Merge all stripes into the file in LSN order, returns the last LSN
+    // handed out so far (caller holds file_mutex_)
+    uint64_t WriteStripes();
+    
     // Compute checksum
     uint32_t ComputeChecksum(const WALRecord& record);
     
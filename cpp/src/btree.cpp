@@ -4,10 +4,49 @@
 
 namespace toydb {
 
+namespace {
+
+// Leaf values starting with VALUE_TAG are tagged: VALUE_TAG + POINTER_TAG +
+// ValuePointer, or VALUE_TAG + INLINE_TAG + a value that itself starts
+// with VALUE_TAG. Every other value is stored as is.
+constexpr char VALUE_TAG = '\0';
+constexpr char POINTER_TAG = 'P';
+constexpr char INLINE_TAG = 'I';
+constexpr size_t POINTER_SIZE = 2 + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
+// On-page type tag of a leaf whose sorted entries are followed by a delta
+// area: [count: u16] then records [key_len: u16][key][val_len: u16][value]
+// [version: u64], in write order (later records win). Plain leaves use
+// NodeType::LEAF.
+constexpr uint8_t LEAF_DELTA_TAG = 2;
+
+std::string EncodePointer(const ValuePointer& pointer) {
+    std::string stored = {VALUE_TAG, POINTER_TAG};
+    stored.append(reinterpret_cast<const char*>(&pointer.segment), sizeof(pointer.segment));
+    stored.append(reinterpret_cast<const char*>(&pointer.offset), sizeof(pointer.offset));
+    stored.append(reinterpret_cast<const char*>(&pointer.length), sizeof(pointer.length));
+    return stored;
+}
+
+ValuePointer DecodePointer(const std::string& stored) {
+    ValuePointer pointer;
+    size_t offset = 2;
+    std::memcpy(&pointer.segment, stored.data() + offset, sizeof(pointer.segment));
+    offset += sizeof(pointer.segment);
+    std::memcpy(&pointer.offset, stored.data() + offset, sizeof(pointer.offset));
+    offset += sizeof(pointer.offset);
+    std::memcpy(&pointer.length, stored.data() + offset, sizeof(pointer.length));
+    return pointer;
+}
+
+} // namespace
+
 BTree::BTree(BufferPool* buffer_pool, PageManager* page_manager)
     : buffer_pool_(buffer_pool), 
       page_manager_(page_manager),
-      root_page_id_(INVALID_PAGE_ID) {}
+      root_page_id_(INVALID_PAGE_ID),
+      value_log_(nullptr),
+      value_threshold_(0) {}
 
 PageID BTree::CreateTree() {
     // Allocate root node (starts as a leaf)
@@ -31,7 +70,8 @@ PageID BTree::AllocateNode(NodeType type) {
     return page_id;
 }
 
-BTree::BTreeNode BTree::LoadNode(PageID page_id) {
+BTree::BTreeNode BTree::LoadNode(PageID page_id, bool fold_deltas) {
+    EpochGuard guard(buffer_pool_->Epochs());  // Keeps the frame alive while decoding
     auto page = buffer_pool_->FetchPage(page_id);
     if (!page) {
         throw std::runtime_error("Failed to load B-Tree node");
@@ -45,7 +85,8 @@ BTree::BTreeNode BTree::LoadNode(PageID page_id) {
     // Read type, num_keys, next_leaf
     uint8_t type_val;
     page->ReadData(offset, reinterpret_cast<char*>(&type_val), sizeof(uint8_t));
-    node.type = static_cast<NodeType>(type_val);
+    bool has_delta = (type_val == LEAF_DELTA_TAG);
+    node.type = has_delta ? NodeType::LEAF : static_cast<NodeType>(type_val);
     offset += sizeof(uint8_t);
     
     page->ReadData(offset, reinterpret_cast<char*>(&node.num_keys), sizeof(uint16_t));
@@ -62,9 +103,11 @@ BTree::BTreeNode BTree::LoadNode(PageID page_id) {
         offset += sizeof(uint16_t);
         
         // Read key data
-        char key_buf[256];
-        page->ReadData(offset, key_buf, key_len);
-        node.keys.emplace_back(key_buf, key_len);
+        std::string key(key_len, '\0');
+        if (!page->ReadData(offset, &key[0], key_len)) {
+            throw std::runtime_error("Corrupt B-Tree node: key past end of page");
+        }
+        node.keys.push_back(std::move(key));
         offset += key_len;
     }
     
@@ -75,11 +118,53 @@ BTree::BTreeNode BTree::LoadNode(PageID page_id) {
             page->ReadData(offset, reinterpret_cast<char*>(&val_len), sizeof(uint16_t));
             offset += sizeof(uint16_t);
             
-            char val_buf[256];
-            page->ReadData(offset, val_buf, val_len);
-            node.values.emplace_back(val_buf, val_len);
+            std::string value(val_len, '\0');
+            if (!page->ReadData(offset, &value[0], val_len)) {
+                throw std::runtime_error("Corrupt B-Tree node: value past end of page");
+            }
+            node.values.push_back(std::move(value));
             offset += val_len;
         }
+        
+        // Read entry versions
+        for (uint16_t i = 0; i < node.num_keys; ++i) {
+            uint64_t version;
+            page->ReadData(offset, reinterpret_cast<char*>(&version), sizeof(uint64_t));
+            node.versions.push_back(version);
+            offset += sizeof(uint64_t);
+        }
+        
+        // Delta area, in page order; later records win
+        node.delta_offset = offset;
+        if (has_delta) {
+            page->ReadData(offset, reinterpret_cast<char*>(&node.delta_count), sizeof(uint16_t));
+            offset += sizeof(uint16_t);
+            
+            for (uint16_t i = 0; i < node.delta_count; ++i) {
+                uint16_t key_len, val_len;
+                uint64_t version;
+                page->ReadData(offset, reinterpret_cast<char*>(&key_len), sizeof(uint16_t));
+                offset += sizeof(uint16_t);
+                std::string key(key_len, '\0');
+                page->ReadData(offset, &key[0], key_len);
+                offset += key_len;
+                
+                page->ReadData(offset, reinterpret_cast<char*>(&val_len), sizeof(uint16_t));
+                offset += sizeof(uint16_t);
+                std::string value(val_len, '\0');
+                page->ReadData(offset, &value[0], val_len);
+                offset += val_len;
+                
+                page->ReadData(offset, reinterpret_cast<char*>(&version), sizeof(uint64_t));
+                offset += sizeof(uint64_t);
+                
+                node.deltas.push_back(Delta{std::move(key), std::move(value), version});
+            }
+        }
+        node.delta_end = offset;
+        if (fold_deltas) {
+            FoldDeltas(node);
+        }
     } else {
         // Read child pointers for internal nodes
         // Internal nodes have num_keys + 1 children
@@ -94,7 +179,89 @@ BTree::BTreeNode BTree::LoadNode(PageID page_id) {
     return node;
 }
 
+void BTree::FoldDeltas(BTreeNode& node) {
+    if (node.deltas.empty()) {
+        return;
+    }
+    
+    // Latest record per key, in key order (stable sort keeps page order
+    // among equal keys, so the last of each run wins)
+    std::vector<Delta> deltas = std::move(node.deltas);
+    node.deltas.clear();
+    std::stable_sort(deltas.begin(), deltas.end(),
+                     [](const Delta& a, const Delta& b) { return a.key < b.key; });
+    std::vector<Delta> latest;
+    for (auto& delta : deltas) {
+        if (!latest.empty() && latest.back().key == delta.key) {
+            latest.back() = std::move(delta);
+        } else {
+            latest.push_back(std::move(delta));
+        }
+    }
+    
+    // Merge the two sorted runs
+    std::vector<std::string> keys, values;
+    std::vector<uint64_t> versions;
+    keys.reserve(node.num_keys + latest.size());
+    values.reserve(node.num_keys + latest.size());
+    versions.reserve(node.num_keys + latest.size());
+    size_t i = 0;
+    for (auto& delta : latest) {
+        while (i < node.num_keys && node.keys[i] < delta.key) {
+            keys.push_back(std::move(node.keys[i]));
+            values.push_back(std::move(node.values[i]));
+            versions.push_back(node.versions[i]);
+            ++i;
+        }
+        if (i < node.num_keys && node.keys[i] == delta.key) {
+            ++i;  // Replaced by the delta record
+        }
+        keys.push_back(std::move(delta.key));
+        values.push_back(std::move(delta.value));
+        versions.push_back(delta.version);
+    }
+    for (; i < node.num_keys; ++i) {
+        keys.push_back(std::move(node.keys[i]));
+        values.push_back(std::move(node.values[i]));
+        versions.push_back(node.versions[i]);
+    }
+    
+    node.keys = std::move(keys);
+    node.values = std::move(values);
+    node.versions = std::move(versions);
+    node.num_keys = node.keys.size();
+}
+
+std::optional<BTree::Entry> BTree::ProbeLeaf(const BTreeNode& node, const std::string& key) {
+    for (auto it = node.deltas.rbegin(); it != node.deltas.rend(); ++it) {
+        if (it->key == key) {
+            return Entry{it->value, it->version};
+        }
+    }
+    
+    int pos = SearchInNode(node, key);
+    if (pos < node.num_keys && node.keys[pos] == key) {
+        return Entry{node.values[pos], node.versions[pos]};
+    }
+    return std::nullopt;
+}
+
+size_t BTree::LeafKeyCount(const BTreeNode& node) {
+    size_t count = node.num_keys;
+    for (size_t i = 0; i < node.deltas.size(); ++i) {
+        const std::string& key = node.deltas[i].key;
+        bool seen = std::any_of(node.deltas.begin(), node.deltas.begin() + i,
+                                [&](const Delta& d) { return d.key == key; });
+        int pos = SearchInNode(node, key);
+        if (!seen && (pos >= node.num_keys || node.keys[pos] != key)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
 void BTree::SaveNode(PageID page_id, const BTreeNode& node) {
+    EpochGuard guard(buffer_pool_->Epochs());
     auto page = buffer_pool_->FetchPage(page_id);
     if (!page) {
         throw std::runtime_error("Failed to save B-Tree node");
@@ -133,6 +300,12 @@ void BTree::SaveNode(PageID page_id, const BTreeNode& node) {
             page->WriteData(offset, value.c_str(), val_len);
             offset += val_len;
         }
+        
+        // Write entry versions
+        for (uint64_t version : node.versions) {
+            page->WriteData(offset, reinterpret_cast<const char*>(&version), sizeof(uint64_t));
+            offset += sizeof(uint64_t);
+        }
     } else {
         // Write child pointers for internal nodes
         for (PageID child_id : node.children) {
@@ -144,6 +317,48 @@ void BTree::SaveNode(PageID page_id, const BTreeNode& node) {
     buffer_pool_->MarkDirty(page_id);
 }
 
+bool BTree::AppendDelta(PageID page_id, const BTreeNode& node, const std::string& key,
+                        const std::string& value, uint64_t version) {
+    // The first record goes after the (new) count field
+    size_t start = node.delta_count == 0 ? node.delta_offset + sizeof(uint16_t) : node.delta_end;
+    size_t record_size = sizeof(uint16_t) + key.size() + sizeof(uint16_t) + value.size() +
+                         sizeof(uint64_t);
+    if (node.delta_count >= LEAF_DELTA_CAPACITY || start + record_size > PAGE_SIZE) {
+        return false;
+    }
+    
+    EpochGuard guard(buffer_pool_->Epochs());
+    auto page = buffer_pool_->FetchPage(page_id);
+    if (!page) {
+        throw std::runtime_error("Failed to save B-Tree node");
+    }
+    
+    size_t offset = start;
+    uint16_t key_len = key.size();
+    page->WriteData(offset, reinterpret_cast<const char*>(&key_len), sizeof(uint16_t));
+    offset += sizeof(uint16_t);
+    page->WriteData(offset, key.data(), key_len);
+    offset += key_len;
+    
+    uint16_t val_len = value.size();
+    page->WriteData(offset, reinterpret_cast<const char*>(&val_len), sizeof(uint16_t));
+    offset += sizeof(uint16_t);
+    page->WriteData(offset, value.data(), val_len);
+    offset += val_len;
+    
+    page->WriteData(offset, reinterpret_cast<const char*>(&version), sizeof(uint64_t));
+    
+    uint16_t count = node.delta_count + 1;
+    page->WriteData(node.delta_offset, reinterpret_cast<const char*>(&count), sizeof(uint16_t));
+    if (node.delta_count == 0) {
+        page->WriteData(sizeof(Page::Header), reinterpret_cast<const char*>(&LEAF_DELTA_TAG),
+                        sizeof(uint8_t));
+    }
+    
+    buffer_pool_->MarkDirty(page_id);
+    return true;
+}
+
 int BTree::SearchInNode(const BTreeNode& node, const std::string& key) {
     // Binary search for key position
     int left = 0, right = node.num_keys - 1;
@@ -183,68 +398,179 @@ PageID BTree::FindLeaf(const std::string& key) {
     }
 }
 
+PageID BTree::FindLeafFrom(std::vector<PathLevel>& path, const std::string& key) {
+    if (root_page_id_ == INVALID_PAGE_ID) {
+        return INVALID_PAGE_ID;
+    }
+    
+    // Keys ascend, so a level keeps routing them until one passes its bound
+    while (!path.empty() && path.back().bounded && key > path.back().upper) {
+        path.pop_back();
+    }
+    
+    // Child of the deepest level for key, with the bound it inherits
+    bool bounded = false;
+    std::string upper;
+    auto route = [&](const PathLevel& level) {
+        int pos = SearchInNode(level.node, key);
+        if (pos < level.node.num_keys) {
+            bounded = true;
+            upper = level.node.keys[pos];
+        } else {
+            bounded = level.bounded;
+            upper = level.upper;
+        }
+        return level.node.children[pos];
+    };
+    
+    PageID current = path.empty() ? root_page_id_ : route(path.back());
+    while (true) {
+        BTreeNode node = LoadNode(current);
+        if (node.type == NodeType::LEAF) {
+            return current;
+        }
+        path.push_back({std::move(node), bounded, upper});
+        current = route(path.back());
+    }
+}
+
 std::optional<std::string> BTree::Search(const std::string& key) {
+    auto entry = SearchEntry(key);
+    if (!entry) {
+        return std::nullopt;
+    }
+    return std::move(entry->value);
+}
+
+std::optional<BTree::Entry> BTree::SearchEntry(const std::string& key) {
+    auto entry = SearchStored(key);
+    if (entry) {
+        entry->value = LoadValue(entry->value);
+    }
+    return entry;
+}
+
+std::optional<BTree::Entry> BTree::SearchStored(const std::string& key) {
     PageID leaf_id = FindLeaf(key);
     if (leaf_id == INVALID_PAGE_ID) {
         return std::nullopt;
     }
     
-    BTreeNode leaf = LoadNode(leaf_id);
-    
-    // Search for key in leaf
-    for (size_t i = 0; i < leaf.num_keys; ++i) {
-        if (leaf.keys[i] == key) {
-            return leaf.values[i];
+    return ProbeLeaf(LoadNode(leaf_id, false), key);
+}
+
+bool BTree::Insert(const std::string& key, const std::string& value, uint64_t version) {
+    return Upsert(key, [&](const Entry* existing) -> std::optional<Entry> {
+        uint64_t new_version = version;
+        if (new_version == 0) {
+            new_version = existing ? existing->version + 1 : 1;
         }
-    }
-    
-    return std::nullopt;
+        return Entry{value, new_version};
+    });
+}
+
+bool BTree::InsertIfAbsent(const std::string& key, const std::string& value, uint64_t version) {
+    return Upsert(key, [&](const Entry* existing) -> std::optional<Entry> {
+        if (existing) {
+            return std::nullopt;
+        }
+        return Entry{value, version != 0 ? version : 1};
+    });
+}
+
+bool BTree::InsertIfVersion(const std::string& key, const std::string& value,
+                            uint64_t expected_version, uint64_t version) {
+    return Upsert(key, [&](const Entry* existing) -> std::optional<Entry> {
+        if (!existing || existing->version != expected_version) {
+            return std::nullopt;
+        }
+        return Entry{value, version != 0 ? version : existing->version + 1};
+    });
+}
+
+std::string BTree::Merge(const std::string& key, const std::string& operand,
+                         const MergeOperator& op, uint64_t version) {
+    std::string result;
+    Upsert(key, [&](const Entry* existing) -> std::optional<Entry> {
+        if (version != 0 && existing && existing->version >= version) {
+            // Already reflected in this entry (WAL replay)
+            result = existing->value;
+            return std::nullopt;
+        }
+        
+        std::optional<std::string> current;
+        if (existing) {
+            current = existing->value;
+        }
+        result = op.Merge(current, operand);
+        
+        uint64_t new_version = version;
+        if (new_version == 0) {
+            new_version = existing ? existing->version + 1 : 1;
+        }
+        return Entry{result, new_version};
+    });
+    return result;
 }
 
-bool BTree::Insert(const std::string& key, const std::string& value) {
+bool BTree::Upsert(const std::string& key, const UpsertFn& fn) {
     if (root_page_id_ == INVALID_PAGE_ID) {
         CreateTree();
     }
     
-    BTreeNode root = LoadNode(root_page_id_);
+    BTreeNode root = LoadNode(root_page_id_, false);
     
-    // If root is full, split it
-    if (root.num_keys >= ORDER - 1) {
-        PageID new_root_id = AllocateNode(NodeType::INTERNAL);
+    // If root is full, split it. The root keeps its page (engines reopen
+    // the tree by page ID), so its contents move to a new left child and
+    // the tree grows above it.
+    if (LeafKeyCount(root) >= ORDER - 1) {
+        FoldDeltas(root);
+        PageID left_id = AllocateNode(root.type);
+        SaveNode(left_id, root);
+        
         BTreeNode new_root;
         new_root.type = NodeType::INTERNAL;
         new_root.num_keys = 0;
-        new_root.children.push_back(root_page_id_);
-        
-        SaveNode(new_root_id, new_root);
+        new_root.children.push_back(left_id);
         
-        SplitChild(new_root_id, 0, root_page_id_);
+        SaveNode(root_page_id_, new_root);
         
-        root_page_id_ = new_root_id;
+        SplitChild(root_page_id_, 0, left_id);
     }
     
-    return InsertNonFull(root_page_id_, key, value);
+    return UpsertNonFull(root_page_id_, key, fn);
 }
 
-bool BTree::InsertNonFull(PageID page_id, const std::string& key, const std::string& value) {
-    BTreeNode node = LoadNode(page_id);
+bool BTree::UpsertNonFull(PageID page_id, const std::string& key, const UpsertFn& fn) {
+    BTreeNode node = LoadNode(page_id, false);
     
     if (node.type == NodeType::LEAF) {
-        // Find insertion position
-        int pos = SearchInNode(node, key);
+        std::optional<Entry> existing = ProbeLeaf(node, key);
+        if (existing) {
+            existing->value = LoadValue(existing->value);
+        }
+        auto updated = fn(existing ? &*existing : nullptr);
+        if (!updated) {
+            return false;
+        }
         
-        // Check if key already exists
-        if (pos < node.num_keys && node.keys[pos] == key) {
-            // Update existing value
-            node.values[pos] = value;
-            SaveNode(page_id, node);
+        // Delta record, or consolidate when the delta area is full
+        std::string stored = StoreValue(key, std::move(updated->value));
+        if (AppendDelta(page_id, node, key, stored, updated->version)) {
             return true;
         }
         
-        // Insert new key-value pair
-        node.keys.insert(node.keys.begin() + pos, key);
-        node.values.insert(node.values.begin() + pos, value);
-        node.num_keys++;
+        FoldDeltas(node);
+        int pos = SearchInNode(node, key);
+        if (pos < node.num_keys && node.keys[pos] == key) {
+            node.values[pos] = std::move(stored);
+            node.versions[pos] = updated->version;
+        } else {
+            node.keys.insert(node.keys.begin() + pos, key);
+            node.values.insert(node.values.begin() + pos, std::move(stored));
+            node.versions.insert(node.versions.begin() + pos, updated->version);
+            node.num_keys++;
+        }
         
         SaveNode(page_id, node);
         return true;
@@ -253,10 +579,10 @@ bool BTree::InsertNonFull(PageID page_id, const std::string& key, const std::str
         int pos = SearchInNode(node, key);
         PageID child_id = node.children[pos];
         
-        BTreeNode child = LoadNode(child_id);
+        BTreeNode child = LoadNode(child_id, false);
         
         // If child is full, split it first
-        if (child.num_keys >= ORDER - 1) {
+        if (LeafKeyCount(child) >= ORDER - 1) {
             SplitChild(page_id, pos, child_id);
             
             // After split, determine which child to insert into
@@ -267,7 +593,7 @@ bool BTree::InsertNonFull(PageID page_id, const std::string& key, const std::str
             child_id = node.children[pos];
         }
         
-        return InsertNonFull(child_id, key, value);
+        return UpsertNonFull(child_id, key, fn);
     }
 }
 
@@ -289,26 +615,32 @@ void BTree::SplitChild(PageID parent_id, int child_index, PageID child_id) {
     if (child.type == NodeType::LEAF) {
         // For leaf nodes, copy values and link siblings
         sibling.values.assign(child.values.begin() + mid, child.values.end());
+        sibling.versions.assign(child.versions.begin() + mid, child.versions.end());
         sibling.next_leaf = child.next_leaf;
         child.next_leaf = sibling_id;
         
         // Truncate child
         child.keys.resize(mid);
         child.values.resize(mid);
-        child.num_keys = mid;
-    } else {
-        // For internal nodes, move children pointers
-        sibling.children.assign(child.children.begin() + mid, child.children.end());
-        
-        child.keys.resize(mid);
-        child.children.resize(mid + 1);
+        child.versions.resize(mid);
         child.num_keys = mid;
     }
     
     // Promote separator key to parent.
     // For leaf nodes we use the max key of the left child so that
     // SearchInNode (first >= key) keeps equality on the left child.
-    std::string promoted_key = child.type == NodeType::LEAF ? child.keys[mid - 1] : child.keys[mid - 1];
+    std::string promoted_key = child.keys[mid - 1];
+    
+    if (child.type == NodeType::INTERNAL) {
+        // For internal nodes, move children pointers. The promoted key
+        // leaves the child, so each child page has exactly one parent
+        // (required by DeleteRange, which frees whole subtrees).
+        sibling.children.assign(child.children.begin() + mid, child.children.end());
+        
+        child.keys.resize(mid - 1);
+        child.children.resize(mid);
+        child.num_keys = mid - 1;
+    }
     
     parent.keys.insert(parent.keys.begin() + child_index, promoted_key);
     parent.children.insert(parent.children.begin() + child_index + 1, sibling_id);
@@ -321,18 +653,33 @@ void BTree::SplitChild(PageID parent_id, int child_index, PageID child_id) {
 }
 
 bool BTree::Delete(const std::string& key) {
+    return DeleteEntry(key, std::nullopt);
+}
+
+bool BTree::DeleteIfVersion(const std::string& key, uint64_t expected_version) {
+    return DeleteEntry(key, expected_version);
+}
+
+bool BTree::DeleteEntry(const std::string& key, std::optional<uint64_t> expected_version) {
+    // Returns true once the key has been found (deleted or not)
+    bool deleted = false;
     auto delete_from_leaf = [&](PageID id, BTreeNode& node) -> bool {
         int p = SearchInNode(node, key);
         if (p >= static_cast<int>(node.num_keys) || node.keys[p] != key) {
             return false;
         }
+        if (expected_version && node.versions[p] != *expected_version) {
+            return true;
+        }
 
         // Remove key/value pair from leaf.
         // Note: merge/rebalance is not implemented yet.
         node.keys.erase(node.keys.begin() + p);
         node.values.erase(node.values.begin() + p);
+        node.versions.erase(node.versions.begin() + p);
         node.num_keys--;
         SaveNode(id, node);
+        deleted = true;
         return true;
     };
 
@@ -343,7 +690,7 @@ bool BTree::Delete(const std::string& key) {
 
     BTreeNode leaf = LoadNode(leaf_id);
     if (delete_from_leaf(leaf_id, leaf)) {
-        return true;
+        return deleted;
     }
 
     // Fallback scan in case internal separators are stale.
@@ -362,7 +709,7 @@ bool BTree::Delete(const std::string& key) {
     while (cursor != INVALID_PAGE_ID) {
         BTreeNode n = LoadNode(cursor);
         if (delete_from_leaf(cursor, n)) {
-            return true;
+            return deleted;
         }
         cursor = n.next_leaf;
     }
@@ -370,6 +717,92 @@ bool BTree::Delete(const std::string& key) {
     return false;
 }
 
+void BTree::DeleteRange(const std::string& start_key, const std::string& end_key) {
+    if (root_page_id_ == INVALID_PAGE_ID || start_key > end_key) {
+        return;
+    }
+    
+    DeleteRangeInNode(root_page_id_, TreeDepth(), start_key, end_key);
+}
+
+std::pair<PageID, PageID> BTree::DeleteRangeInNode(PageID page_id, size_t depth,
+                                                   const std::string& start_key,
+                                                   const std::string& end_key) {
+    BTreeNode node = LoadNode(page_id);
+    
+    if (node.type == NodeType::LEAF) {
+        // Boundary leaf: trim the covered keys (the leaf stays, possibly empty)
+        auto first = std::lower_bound(node.keys.begin(), node.keys.end(), start_key);
+        auto last = std::upper_bound(node.keys.begin(), node.keys.end(), end_key);
+        if (first != last) {
+            size_t lo = first - node.keys.begin();
+            size_t hi = last - node.keys.begin();
+            node.keys.erase(first, last);
+            node.values.erase(node.values.begin() + lo, node.values.begin() + hi);
+            node.versions.erase(node.versions.begin() + lo, node.versions.begin() + hi);
+            node.num_keys = node.keys.size();
+            SaveNode(page_id, node);
+        }
+        return {page_id, page_id};
+    }
+    
+    // Children a and b hold the range boundaries; everything strictly
+    // between them is covered and dropped together with its separators.
+    int a = SearchInNode(node, start_key);
+    int b = SearchInNode(node, end_key);
+    
+    if (b > a + 1) {
+        for (int i = a + 1; i < b; ++i) {
+            FreeSubtree(node.children[i], depth - 1);
+        }
+        node.children.erase(node.children.begin() + a + 1, node.children.begin() + b);
+        node.keys.erase(node.keys.begin() + a + 1, node.keys.begin() + b);
+        node.num_keys = node.keys.size();
+        SaveNode(page_id, node);
+    }
+    
+    auto left = DeleteRangeInNode(node.children[a], depth - 1, start_key, end_key);
+    if (b == a) {
+        return left;
+    }
+    auto right = DeleteRangeInNode(node.children[a + 1], depth - 1, start_key, end_key);
+    
+    // Splice the leaf chain over the freed leaves
+    BTreeNode left_leaf = LoadNode(left.second);
+    if (left_leaf.next_leaf != right.first) {
+        left_leaf.next_leaf = right.first;
+        SaveNode(left.second, left_leaf);
+    }
+    
+    return {left.first, right.second};
+}
+
+void BTree::FreeSubtree(PageID page_id, size_t depth) {
+    if (depth > 0) {
+        BTreeNode node = LoadNode(page_id);
+        for (PageID child_id : node.children) {
+            FreeSubtree(child_id, depth - 1);
+        }
+    }
+    
+    buffer_pool_->DiscardPage(page_id);
+    page_manager_->FreePage(page_id);
+}
+
+size_t BTree::TreeDepth() {
+    size_t depth = 0;
+    PageID current = root_page_id_;
+    
+    while (true) {
+        BTreeNode node = LoadNode(current);
+        if (node.type == NodeType::LEAF) {
+            return depth;
+        }
+        current = node.children[0];
+        depth++;
+    }
+}
+
 std::vector<std::pair<std::string, std::string>> BTree::RangeScan(
     const std::string& start_key, 
     const std::string& end_key
@@ -388,7 +821,7 @@ std::vector<std::pair<std::string, std::string>> BTree::RangeScan(
         
         for (size_t i = 0; i < leaf.num_keys; ++i) {
             if (leaf.keys[i] >= start_key && leaf.keys[i] <= end_key) {
-                results.emplace_back(leaf.keys[i], leaf.values[i]);
+                results.emplace_back(leaf.keys[i], LoadValue(leaf.values[i]));
             } else if (leaf.keys[i] > end_key) {
                 return results;  // Done
             }
@@ -401,4 +834,191 @@ std::vector<std::pair<std::string, std::string>> BTree::RangeScan(
     return results;
 }
 
+std::vector<std::pair<std::string, std::string>> BTree::MultiRangeScan(
+    std::vector<std::pair<std::string, std::string>> ranges
+) {
+    std::vector<std::pair<std::string, std::string>> results;
+    
+    if (root_page_id_ == INVALID_PAGE_ID || ranges.empty()) {
+        return results;
+    }
+    
+    // Sort by start and coalesce overlaps so the cursor only moves forward
+    std::sort(ranges.begin(), ranges.end());
+    std::vector<std::pair<std::string, std::string>> merged;
+    for (auto& range : ranges) {
+        if (range.first > range.second) {
+            continue;  // Empty range
+        }
+        if (!merged.empty() && range.first <= merged.back().second) {
+            merged.back().second = std::max(merged.back().second, range.second);
+        } else {
+            merged.push_back(std::move(range));
+        }
+    }
+    
+    BTreeNode leaf;
+    bool positioned = false;
+    size_t pos = 0;
+    std::vector<PathLevel> path;
+    
+    for (const auto& [start_key, end_key] : merged) {
+        // Stay on the current leaf if the range starts inside it, otherwise
+        // descend again to skip the keys between the ranges
+        if (!positioned || leaf.num_keys == 0 || leaf.keys.back() < start_key) {
+            leaf = LoadNode(FindLeafFrom(path, start_key));
+            positioned = true;
+            pos = 0;
+        }
+        pos = std::lower_bound(leaf.keys.begin() + pos, leaf.keys.end(), start_key) -
+              leaf.keys.begin();
+        
+        while (true) {
+            if (pos == leaf.num_keys) {
+                if (leaf.next_leaf == INVALID_PAGE_ID) {
+                    return results;  // End of tree: later ranges are empty
+                }
+                leaf = LoadNode(leaf.next_leaf);
+                pos = 0;
+                continue;
+            }
+            if (leaf.keys[pos] > end_key) {
+                break;  // Next range may start on this leaf
+            }
+            results.emplace_back(leaf.keys[pos], LoadValue(leaf.values[pos]));
+            ++pos;
+        }
+    }
+    
+    return results;
+}
+
+BTree::Cursor BTree::Seek(const std::string& start_key, const std::string& end_key) {
+    return Cursor(this, start_key, end_key);
+}
+
+BTree::Cursor::Cursor(BTree* tree, const std::string& start_key, std::string end_key)
+    : tree_(tree), end_key_(std::move(end_key)) {
+    PageID leaf_id = tree_->FindLeaf(start_key);
+    if (leaf_id == INVALID_PAGE_ID) {
+        return;
+    }
+    leaf_ = tree_->LoadNode(leaf_id);
+    pos_ = std::lower_bound(leaf_.keys.begin(), leaf_.keys.end(), start_key) -
+           leaf_.keys.begin();
+    valid_ = true;
+    Settle();
+}
+
+void BTree::Cursor::Next() {
+    if (valid_) {
+        ++pos_;
+        Settle();
+    }
+}
+
+void BTree::Cursor::Settle() {
+    while (pos_ == leaf_.num_keys) {
+        if (leaf_.next_leaf == INVALID_PAGE_ID) {
+            valid_ = false;
+            return;
+        }
+        leaf_ = tree_->LoadNode(leaf_.next_leaf);
+        pos_ = 0;
+    }
+    if (leaf_.keys[pos_] > end_key_) {
+        valid_ = false;
+    }
+}
+
+void BTree::SetValueLog(ValueLog* value_log, size_t threshold) {
+    value_log_ = value_log;
+    value_threshold_ = threshold;
+}
+
+std::string BTree::StoreValue(const std::string& key, std::string value) {
+    if (value_log_ && value_threshold_ > 0 && value.size() > value_threshold_) {
+        return EncodePointer(value_log_->Append(key, value));
+    }
+    if (!value.empty() && value[0] == VALUE_TAG) {
+        return std::string{VALUE_TAG, INLINE_TAG} + value;
+    }
+    return value;
+}
+
+std::string BTree::LoadValue(const std::string& stored) {
+    if (stored.size() < 2 || stored[0] != VALUE_TAG) {
+        return stored;
+    }
+    if (stored[1] == INLINE_TAG) {
+        return stored.substr(2);
+    }
+    if (stored[1] == POINTER_TAG && stored.size() == POINTER_SIZE) {
+        if (!value_log_) {
+            throw std::runtime_error("Value log pointer found but no value log is open");
+        }
+        return value_log_->Read(DecodePointer(stored));
+    }
+    return stored;
+}
+
+bool BTree::ReplaceStored(const std::string& key, const std::string& expected,
+                          const std::string& replacement) {
+    PageID leaf_id = FindLeaf(key);
+    if (leaf_id == INVALID_PAGE_ID) {
+        return false;
+    }
+    
+    BTreeNode leaf = LoadNode(leaf_id);
+    int pos = SearchInNode(leaf, key);
+    if (pos >= leaf.num_keys || leaf.keys[pos] != key || leaf.values[pos] != expected) {
+        return false;
+    }
+    
+    leaf.values[pos] = replacement;
+    SaveNode(leaf_id, leaf);
+    return true;
+}
+
+uint64_t BTree::CollectValueLog(double max_live_ratio) {
+    if (!value_log_) {
+        return 0;
+    }
+    
+    uint64_t reclaimed = 0;
+    for (uint32_t segment : value_log_->SealedSegments()) {
+        auto records = value_log_->ReadSegment(segment);
+        
+        // A record is live while its key still points at it
+        std::vector<const ValueLog::Record*> live;
+        uint64_t live_bytes = 0;
+        for (const auto& record : records) {
+            auto entry = SearchStored(record.key);
+            if (entry && entry->value == EncodePointer(record.pointer)) {
+                live.push_back(&record);
+                live_bytes += 2 * sizeof(uint32_t) + record.key.size() + record.value.size();
+            }
+        }
+        
+        uint64_t size = value_log_->SegmentSize(segment);
+        if (live_bytes > max_live_ratio * size) {
+            continue;
+        }
+        
+        for (const auto* record : live) {
+            ValuePointer moved = value_log_->Append(record->key, record->value);
+            ReplaceStored(record->key, EncodePointer(record->pointer), EncodePointer(moved));
+        }
+        
+        // Moved values and the leaves pointing at them must be on disk
+        // before the old copies disappear
+        value_log_->Flush();
+        buffer_pool_->FlushDirty();
+        value_log_->DropSegment(segment);
+        reclaimed += size - live_bytes;
+    }
+    
+    return reclaimed;
+}
+
 } // namespace toydb
@@ -6,13 +6,13 @@ namespace toydb {
 BufferPool::BufferPool(size_t capacity, PageManager* pm)
     : capacity_(capacity), page_manager_(pm) {}
 
-std::shared_ptr<Page> BufferPool::FetchPage(PageID page_id) {
+Page* BufferPool::FetchPage(PageID page_id) {
     // Check if page is in cache
     auto it = cache_.find(page_id);
     if (it != cache_.end()) {
         cache_hits_++;
         Touch(page_id);
-        return it->second.first;
+        return it->second.first.get();
     }
     
     cache_misses_++;
@@ -33,21 +33,43 @@ std::shared_ptr<Page> BufferPool::FetchPage(PageID page_id) {
     lru_list_.push_front(page_id);
     cache_[page_id] = {page, lru_list_.begin()};
     
-    return page;
+    return page.get();
 }
 
 void BufferPool::MarkDirty(PageID page_id) {
     dirty_pages_.insert(page_id);
+    
+    auto it = cache_.find(page_id);
+    if (wal_ && it != cache_.end()) {
+        it->second.first->SetLSN(wal_->GetLastLSN());
+    }
 }
 
 void BufferPool::FlushDirty() {
+    // The first write flushes the log; later ones find it flushed
     for (PageID page_id : dirty_pages_) {
         auto it = cache_.find(page_id);
         if (it != cache_.end()) {
-            page_manager_->WritePage(it->second.first);
+            WriteBack(it->second.first);
         }
     }
     dirty_pages_.clear();
+    
+    // Freed pages are marked once nothing written refers to them
+    page_manager_->WriteFreePages();
+}
+
+void BufferPool::DiscardPage(PageID page_id) {
+    dirty_pages_.erase(page_id);
+    
+    auto it = cache_.find(page_id);
+    if (it == cache_.end()) {
+        return;
+    }
+    
+    lru_list_.erase(it->second.second);
+    Retire(std::move(it->second.first));
+    cache_.erase(it);
 }
 
 void BufferPool::Evict() {
@@ -58,20 +80,29 @@ void BufferPool::Evict() {
     // Get least recently used page (back of list)
     PageID evict_id = lru_list_.back();
     
-    // If dirty, flush to disk
+    // If dirty, flush to disk. Writing the victim alone could leave half
+    // of a split on disk (a parent pointing at a child never written), so
+    // every dirty page goes out with it, as in FlushDirty.
     if (dirty_pages_.count(evict_id)) {
-        auto it = cache_.find(evict_id);
-        if (it != cache_.end()) {
-            page_manager_->WritePage(it->second.first);
-        }
-        dirty_pages_.erase(evict_id);
+        FlushDirty();
     }
     
     // Remove from cache
-    cache_.erase(evict_id);
+    auto it = cache_.find(evict_id);
+    if (it != cache_.end()) {
+        Retire(std::move(it->second.first));
+        cache_.erase(it);
+    }
     lru_list_.pop_back();
 }
 
+void BufferPool::WriteBack(const std::shared_ptr<Page>& page) {
+    if (wal_) {
+        wal_->FlushTo(page->GetLSN());
+    }
+    page_manager_->WritePage(page);
+}
+
 void BufferPool::Touch(PageID page_id) {
     auto it = cache_.find(page_id);
     if (it == cache_.end()) {
@@ -84,4 +115,9 @@ void BufferPool::Touch(PageID page_id) {
     it->second.second = lru_list_.begin();
 }
 
+void BufferPool::Retire(std::shared_ptr<Page> page) {
+    // A pinned reader may still use the frame through a raw pointer
+    epochs_.Retire(std::move(page));
+}
+
 } // namespace toydb
@@ -0,0 +1,164 @@
+#include "change_feed.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace toydb {
+
+ChangeFeed::ChangeFeed(const std::string& state_file) : state_file_(state_file) {
+    LoadState();
+}
+
+void ChangeFeed::Decode(const std::vector<WAL::WALRecord>& records) {
+    for (const auto& record : records) {
+        if (record.lsn <= decoded_lsn_) {
+            continue;  // Retained records seen before a truncation
+        }
+        decoded_lsn_ = record.lsn;
+
+        switch (record.type) {
+            case WAL::RecordType::INSERT:
+            case WAL::RecordType::UPDATE:
+            case WAL::RecordType::DELETE:
+            case WAL::RecordType::MERGE:
+            case WAL::RecordType::DELETE_RANGE: {
+                Change change{0, record.lsn, record.txn_id, record.type, record.key, record.value};
+                if (record.txn_id == 0) {
+                    change.commit_lsn = record.lsn;  // Logged outside any transaction
+                    changes_.push_back(std::move(change));
+                } else {
+                    open_[record.txn_id].push_back(std::move(change));
+                }
+                break;
+            }
+            case WAL::RecordType::COMMIT_TXN: {
+                auto it = open_.find(record.txn_id);
+                if (it == open_.end()) {
+                    break;
+                }
+                for (auto& change : it->second) {
+                    change.commit_lsn = record.lsn;
+                    changes_.push_back(std::move(change));
+                }
+                open_.erase(it);
+                break;
+            }
+            case WAL::RecordType::ABORT_TXN:
+                open_.erase(record.txn_id);
+                break;
+            default:
+                break;
+        }
+    }
+    Trim();
+}
+
+std::vector<ChangeFeed::Change> ChangeFeed::Read(uint64_t after_commit_lsn,
+                                                 size_t max_changes) const {
+    std::vector<Change> result;
+    auto it = std::upper_bound(changes_.begin(), changes_.end(), after_commit_lsn,
+                               [](uint64_t lsn, const Change& change) {
+                                   return lsn < change.commit_lsn;
+                               });
+    for (; it != changes_.end(); ++it) {
+        // Stop at a transaction boundary once the batch is full
+        if (max_changes > 0 && result.size() >= max_changes &&
+            it->commit_lsn != result.back().commit_lsn) {
+            break;
+        }
+        result.push_back(*it);
+    }
+    return result;
+}
+
+uint64_t ChangeFeed::Register(const std::string& name, uint64_t from_lsn) {
+    auto [it, added] = consumers_.emplace(name, from_lsn);
+    if (added) {
+        SaveState();
+    }
+    return it->second;
+}
+
+void ChangeFeed::Ack(const std::string& name, uint64_t lsn) {
+    auto it = consumers_.find(name);
+    if (it == consumers_.end()) {
+        throw std::runtime_error("Unknown change consumer: " + name);
+    }
+    if (lsn > it->second) {
+        it->second = lsn;
+        SaveState();
+        Trim();
+    }
+}
+
+void ChangeFeed::Drop(const std::string& name) {
+    if (consumers_.erase(name)) {
+        SaveState();
+        Trim();
+    }
+}
+
+uint64_t ChangeFeed::RetainFrom() const {
+    if (consumers_.empty()) {
+        return UINT64_MAX;
+    }
+    uint64_t keep = UINT64_MAX;
+    for (const auto& change : changes_) {
+        keep = std::min(keep, change.lsn);
+    }
+    for (const auto& [txn_id, changes] : open_) {
+        if (!changes.empty()) {
+            keep = std::min(keep, changes.front().lsn);
+        }
+    }
+    return keep;
+}
+
+void ChangeFeed::Reset() {
+    changes_.clear();
+    open_.clear();
+}
+
+void ChangeFeed::Trim() {
+    if (consumers_.empty()) {
+        return;  // Kept until the log is truncated
+    }
+    uint64_t slowest = UINT64_MAX;
+    for (const auto& [name, lsn] : consumers_) {
+        slowest = std::min(slowest, lsn);
+    }
+    while (!changes_.empty() && changes_.front().commit_lsn <= slowest) {
+        changes_.pop_front();
+    }
+}
+
+void ChangeFeed::LoadState() {
+    // One consumer per line: <acknowledged lsn> <name>
+    std::ifstream in(state_file_);
+    uint64_t lsn;
+    std::string name;
+    while (in >> lsn && std::getline(in >> std::ws, name)) {
+        consumers_[name] = lsn;
+    }
+}
+
+void ChangeFeed::SaveState() const {
+    // Write a new file and rename it so a crash leaves the old or new state
+    std::string tmp = state_file_ + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        for (const auto& [name, lsn] : consumers_) {
+            out << lsn << ' ' << name << '\n';
+        }
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("Failed to write change consumer state: " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), state_file_.c_str()) != 0) {
+        throw std::runtime_error("Failed to replace change consumer state: " + state_file_);
+    }
+}
+
+} // namespace toydb
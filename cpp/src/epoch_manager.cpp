@@ -0,0 +1,149 @@
+#include "epoch_manager.hpp"
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+
+namespace toydb {
+
+namespace {
+
+// Process-wide slot indexes: a thread takes one on first use and returns
+// it when it exits, so slot arrays stay small under thread churn
+std::mutex index_mutex;
+std::vector<size_t> free_indexes;
+size_t next_index = 0;
+
+struct ThreadIndex {
+    size_t value;
+
+    ThreadIndex() {
+        std::lock_guard<std::mutex> lock(index_mutex);
+        if (!free_indexes.empty()) {
+            value = free_indexes.back();
+            free_indexes.pop_back();
+        } else {
+            value = next_index++;
+        }
+    }
+
+    ~ThreadIndex() {
+        std::lock_guard<std::mutex> lock(index_mutex);
+        free_indexes.push_back(value);
+    }
+};
+
+size_t LocalIndex() {
+    thread_local ThreadIndex index;
+    return index.value;
+}
+
+} // namespace
+
+EpochManager::Slot& EpochManager::LocalSlot() {
+    size_t index = LocalIndex();
+    if (index >= MAX_THREADS) {
+        throw std::runtime_error("Too many threads for epoch manager (max " +
+                                 std::to_string(MAX_THREADS) + ")");
+    }
+    return slots_[index];
+}
+
+void EpochManager::Pin() {
+    Slot& slot = LocalSlot();
+    if (slot.depth++ > 0) {
+        return;
+    }
+
+    // Publish the epoch, then make sure it is still current so a
+    // concurrent advance cannot have missed the pin
+    uint64_t epoch = global_epoch_.load();
+    while (true) {
+        slot.epoch.store(epoch);
+        uint64_t now = global_epoch_.load();
+        if (now == epoch) {
+            break;
+        }
+        epoch = now;
+    }
+}
+
+void EpochManager::Unpin() {
+    Slot& slot = LocalSlot();
+    if (--slot.depth > 0) {
+        return;
+    }
+    slot.epoch.store(0, std::memory_order_release);
+
+    if (slot.limbo_size.load(std::memory_order_relaxed) >= slot.collect_at) {
+        Collect();
+    }
+}
+
+void EpochManager::Retire(std::shared_ptr<void> object) {
+    Slot& slot = LocalSlot();
+    size_t size;
+    {
+        std::lock_guard<std::mutex> lock(slot.limbo_mutex);
+        slot.limbo.push_back(Retired{global_epoch_.load(), std::move(object)});
+        size = slot.limbo.size();
+        slot.limbo_size.store(size, std::memory_order_relaxed);
+    }
+    pending_.fetch_add(1, std::memory_order_relaxed);
+
+    if (size >= slot.collect_at) {
+        Collect();
+    }
+}
+
+void EpochManager::Collect() {
+    Slot& slot = LocalSlot();
+    TryAdvance(slot);
+    FreeExpired(slot, true);
+    slot.collect_at = slot.limbo_size.load(std::memory_order_relaxed) + COLLECT_BATCH;
+}
+
+void EpochManager::TryAdvance(const Slot& own) {
+    uint64_t epoch = global_epoch_.load();
+    for (const auto& slot : slots_) {
+        uint64_t pinned = slot.epoch.load();
+        if (pinned != 0 && pinned != epoch) {
+            return;  // A thread still runs in an older epoch
+        }
+    }
+    if (!global_epoch_.compare_exchange_strong(epoch, epoch + 1)) {
+        return;
+    }
+
+    // Lists of threads that exited (or retire rarely) would otherwise
+    // keep their frames until the owner collects again
+    for (auto& slot : slots_) {
+        if (&slot != &own && slot.limbo_size.load(std::memory_order_relaxed) > 0) {
+            FreeExpired(slot, false);
+        }
+    }
+}
+
+void EpochManager::FreeExpired(Slot& slot, bool wait) {
+    std::unique_lock<std::mutex> lock(slot.limbo_mutex, std::defer_lock);
+    if (wait) {
+        lock.lock();
+    } else if (!lock.try_lock()) {
+        return;
+    }
+
+    uint64_t epoch = global_epoch_.load();
+    auto expired = std::partition(slot.limbo.begin(), slot.limbo.end(),
+                                  [epoch](const Retired& r) { return r.epoch + 2 > epoch; });
+
+    // Dropped after the lock is released: destructors may be slow
+    std::vector<Retired> freed(std::make_move_iterator(expired),
+                               std::make_move_iterator(slot.limbo.end()));
+    slot.limbo.erase(expired, slot.limbo.end());
+    slot.limbo_size.store(slot.limbo.size(), std::memory_order_relaxed);
+    lock.unlock();
+
+    pending_.fetch_sub(freed.size(), std::memory_order_relaxed);
+}
+
+} // namespace toydb
@@ -0,0 +1,327 @@
+#include "expr_vm.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace toydb {
+
+namespace {
+
+using Value = ExprProgram::Value;
+
+enum class Cmp { EQ, NE, LT, LE, GT, GE };
+
+// Value registers start out pointing here
+const Value NULL_VALUE;
+
+// A value as seen by a generic comparison
+struct Operand {
+    enum class Kind { NUL, NUMBER, TEXT } kind;
+    bool is_int = false;
+    int64_t i = 0;
+    double d = 0.0;
+    const std::string* text = nullptr;
+};
+
+// Text made of digits, '.' and '-' (the executor's test) parsed as a
+// number; false if it is not one ("1-2", "1.2.3")
+bool ParseNumericText(const std::string& s, Operand& out) {
+    bool has_digit = false;
+    for (char c : s) {
+        if (c >= '0' && c <= '9') {
+            has_digit = true;
+        } else if (c != '.' && c != '-') {
+            return false;
+        }
+    }
+    if (!has_digit) {
+        return false;
+    }
+
+    char* end;
+    if (s.find('.') == std::string::npos) {
+        errno = 0;
+        long long value = std::strtoll(s.c_str(), &end, 10);
+        if (*end == '\0' && errno != ERANGE) {
+            out.kind = Operand::Kind::NUMBER;
+            out.is_int = true;
+            out.i = value;
+            return true;
+        }
+        // Out of INT range: compared as a FLOAT below
+    }
+    double value = std::strtod(s.c_str(), &end);
+    if (*end != '\0') {
+        return false;
+    }
+    out.kind = Operand::Kind::NUMBER;
+    out.d = value;
+    return true;
+}
+
+Operand Classify(const Value& value, bool coerce_numeric_text) {
+    Operand op;
+    if (const auto* i = std::get_if<int64_t>(&value)) {
+        op.kind = Operand::Kind::NUMBER;
+        op.is_int = true;
+        op.i = *i;
+    } else if (const auto* d = std::get_if<double>(&value)) {
+        op.kind = Operand::Kind::NUMBER;
+        op.d = *d;
+    } else if (const auto* s = std::get_if<std::string>(&value)) {
+        if (!coerce_numeric_text || !ParseNumericText(*s, op)) {
+            op.kind = Operand::Kind::TEXT;
+            op.text = s;
+        }
+    } else {
+        op.kind = Operand::Kind::NUL;
+    }
+    return op;
+}
+
+const char* KindName(const Operand& op) {
+    switch (op.kind) {
+        case Operand::Kind::NUMBER: return "number";
+        case Operand::Kind::TEXT: return "text";
+        default: return "NULL";
+    }
+}
+
+bool Holds(int order, Cmp cmp) {
+    switch (cmp) {
+        case Cmp::EQ: return order == 0;
+        case Cmp::NE: return order != 0;
+        case Cmp::LT: return order < 0;
+        case Cmp::LE: return order <= 0;
+        case Cmp::GT: return order > 0;
+        default: return order >= 0;
+    }
+}
+
+bool CompareValues(const Value& a, const Value& b, Cmp cmp, bool coerce_numeric_text) {
+    Operand x = Classify(a, coerce_numeric_text);
+    Operand y = Classify(b, coerce_numeric_text);
+
+    int order;
+    if (x.kind == Operand::Kind::NUMBER && y.kind == Operand::Kind::NUMBER) {
+        if (x.is_int && y.is_int) {
+            order = (x.i > y.i) - (x.i < y.i);
+        } else {
+            double l = x.is_int ? static_cast<double>(x.i) : x.d;
+            double r = y.is_int ? static_cast<double>(y.i) : y.d;
+            order = (l > r) - (l < r);
+        }
+    } else if (x.kind == Operand::Kind::TEXT && y.kind == Operand::Kind::TEXT) {
+        // Byte order of UTF-8 is code point order
+        int c = x.text->compare(*y.text);
+        order = (c > 0) - (c < 0);
+    } else {
+        // NULLs or different types: equal only if both are NULL, no order
+        bool equal = x.kind == Operand::Kind::NUL && y.kind == Operand::Kind::NUL;
+        if (cmp == Cmp::EQ) {
+            return equal;
+        }
+        if (cmp == Cmp::NE) {
+            return !equal;
+        }
+        throw std::runtime_error(std::string("Cannot order ") + KindName(x) +
+                                 " and " + KindName(y));
+    }
+    return Holds(order, cmp);
+}
+
+// Fast path when both operands hold T, generic comparison otherwise
+template <typename T>
+bool CompareTyped(const Value& a, const Value& b, Cmp cmp, bool coerce_numeric_text) {
+    const T* x = std::get_if<T>(&a);
+    const T* y = std::get_if<T>(&b);
+    if (!x || !y) {
+        return CompareValues(a, b, cmp, coerce_numeric_text);
+    }
+    return Holds((*x > *y) - (*x < *y), cmp);
+}
+
+bool Truthy(const Value& value) {
+    if (const auto* i = std::get_if<int64_t>(&value)) {
+        return *i != 0;
+    }
+    if (const auto* d = std::get_if<double>(&value)) {
+        return *d != 0.0;
+    }
+    if (const auto* s = std::get_if<std::string>(&value)) {
+        return !s->empty();
+    }
+    return false;
+}
+
+Cmp CmpOf(ExprProgram::Op op, ExprProgram::Op first) {
+    return static_cast<Cmp>(static_cast<int>(op) - static_cast<int>(first));
+}
+
+} // namespace
+
+ExprProgram::ExprProgram(bool coerce_numeric_text)
+    : coerce_numeric_text_(coerce_numeric_text) {}
+
+uint16_t ExprProgram::AddConstant(const Value& value) {
+    if (constants_.size() >= UINT16_MAX) {
+        throw std::runtime_error("Expression has too many constants");
+    }
+    constants_.push_back(value);
+    return static_cast<uint16_t>(constants_.size() - 1);
+}
+
+uint16_t ExprProgram::AddList(const std::vector<Value>& values) {
+    if (lists_.size() >= UINT16_MAX) {
+        throw std::runtime_error("Expression has too many IN lists");
+    }
+    lists_.push_back(values);
+    return static_cast<uint16_t>(lists_.size() - 1);
+}
+
+uint16_t ExprProgram::Emit(Op op, uint16_t dst, uint16_t a, uint16_t b) {
+    if (code_.size() >= UINT16_MAX) {
+        throw std::runtime_error("Expression is too large");
+    }
+
+    // Operands must name registers / constants defined so far
+    auto check = [](bool ok, const char* what) {
+        if (!ok) {
+            throw std::runtime_error(std::string("Bad expression instruction: ") + what);
+        }
+    };
+    switch (op) {
+        case Op::LOAD_COLUMN:
+            num_values_ = std::max<size_t>(num_values_, dst + 1);
+            break;
+        case Op::LOAD_CONST:
+            check(a < constants_.size(), "unknown constant");
+            num_values_ = std::max<size_t>(num_values_, dst + 1);
+            break;
+        case Op::IN_LIST:
+            check(a < num_values_, "unset value register");
+            check(b < lists_.size(), "unknown IN list");
+            num_flags_ = std::max<size_t>(num_flags_, dst + 1);
+            break;
+        case Op::TRUTHY:
+            check(a < num_values_, "unset value register");
+            num_flags_ = std::max<size_t>(num_flags_, dst + 1);
+            break;
+        case Op::JUMP_IF_FALSE:
+        case Op::JUMP_IF_TRUE:
+        case Op::RETURN:
+            check(a < num_flags_, "unset flag register");
+            break;
+        default:  // Comparisons
+            check(a < num_values_ && b < num_values_, "unset value register");
+            num_flags_ = std::max<size_t>(num_flags_, dst + 1);
+            break;
+    }
+
+    code_.push_back({op, dst, a, b});
+    return static_cast<uint16_t>(code_.size() - 1);
+}
+
+void ExprProgram::Patch(uint16_t address, uint16_t target) {
+    if (address >= code_.size() || (code_[address].op != Op::JUMP_IF_FALSE &&
+                                    code_[address].op != Op::JUMP_IF_TRUE)) {
+        throw std::runtime_error("Bad expression instruction: patched instruction is not a jump");
+    }
+    code_[address].b = target;
+}
+
+ExprProgram::Registers ExprProgram::NewRegisters() const {
+    return {std::vector<const Value*>(num_values_, &NULL_VALUE),
+            std::vector<uint8_t>(num_flags_, 0)};
+}
+
+bool ExprProgram::Run(const std::vector<Value>& row, Registers& regs) const {
+    size_t pc = 0;
+    while (pc < code_.size()) {
+        const Instruction& in = code_[pc++];
+        switch (in.op) {
+            case Op::LOAD_COLUMN:
+                if (in.a >= row.size()) {
+                    throw std::runtime_error("Row has no column slot " + std::to_string(in.a));
+                }
+                regs.values[in.dst] = &row[in.a];
+                break;
+            case Op::LOAD_CONST:
+                regs.values[in.dst] = &constants_[in.a];
+                break;
+            case Op::EQ:
+            case Op::NE:
+            case Op::LT:
+            case Op::LE:
+            case Op::GT:
+            case Op::GE:
+                regs.flags[in.dst] = CompareValues(*regs.values[in.a], *regs.values[in.b],
+                                                   CmpOf(in.op, Op::EQ), coerce_numeric_text_);
+                break;
+            case Op::EQ_INT:
+            case Op::NE_INT:
+            case Op::LT_INT:
+            case Op::LE_INT:
+            case Op::GT_INT:
+            case Op::GE_INT:
+                regs.flags[in.dst] = CompareTyped<int64_t>(*regs.values[in.a], *regs.values[in.b],
+                                                           CmpOf(in.op, Op::EQ_INT),
+                                                           coerce_numeric_text_);
+                break;
+            case Op::EQ_TEXT:
+            case Op::NE_TEXT:
+                regs.flags[in.dst] = CompareTyped<std::string>(*regs.values[in.a], *regs.values[in.b],
+                                                               CmpOf(in.op, Op::EQ_TEXT),
+                                                               coerce_numeric_text_);
+                break;
+            case Op::IN_LIST: {
+                // Plain equality, like Python's "in"
+                const Value& value = *regs.values[in.a];
+                bool found = false;
+                for (const auto& item : lists_[in.b]) {
+                    if (CompareValues(value, item, Cmp::EQ, false)) {
+                        found = true;
+                        break;
+                    }
+                }
+                regs.flags[in.dst] = found;
+                break;
+            }
+            case Op::TRUTHY:
+                regs.flags[in.dst] = Truthy(*regs.values[in.a]);
+                break;
+            case Op::JUMP_IF_FALSE:
+                if (!regs.flags[in.a]) {
+                    pc = in.b;
+                }
+                break;
+            case Op::JUMP_IF_TRUE:
+                if (regs.flags[in.a]) {
+                    pc = in.b;
+                }
+                break;
+            case Op::RETURN:
+                return regs.flags[in.a] != 0;
+        }
+    }
+    throw std::runtime_error("Expression program ended without RETURN");
+}
+
+bool ExprProgram::Evaluate(const std::vector<Value>& row) const {
+    Registers regs = NewRegisters();
+    return Run(row, regs);
+}
+
+std::vector<size_t> ExprProgram::Filter(const std::vector<std::vector<Value>>& rows) const {
+    Registers regs = NewRegisters();
+    std::vector<size_t> selected;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (Run(rows[i], regs)) {
+            selected.push_back(i);
+        }
+    }
+    return selected;
+}
+
+} // namespace toydb
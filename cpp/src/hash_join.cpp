@@ -0,0 +1,90 @@
+#include "hash_join.hpp"
+#include <functional>
+#include <string>
+
+namespace toydb {
+
+namespace {
+
+// Numbers hash by their double value, so 1 and 1.0 share a bucket
+size_t HashValue(const HashJoin::Value& value) {
+    if (const auto* i = std::get_if<int64_t>(&value)) {
+        double d = static_cast<double>(*i);
+        return d == 0.0 ? 0 : std::hash<double>()(d);
+    }
+    if (const auto* d = std::get_if<double>(&value)) {
+        return *d == 0.0 ? 0 : std::hash<double>()(*d);  // -0.0 == 0.0
+    }
+    if (const auto* s = std::get_if<std::string>(&value)) {
+        return std::hash<std::string>()(*s);
+    }
+    return 0x9e3779b97f4a7c15ULL;  // NULL
+}
+
+bool ValuesEqual(const HashJoin::Value& a, const HashJoin::Value& b) {
+    const auto* ai = std::get_if<int64_t>(&a);
+    const auto* bi = std::get_if<int64_t>(&b);
+    if (ai && bi) {
+        return *ai == *bi;
+    }
+    const auto* ad = std::get_if<double>(&a);
+    const auto* bd = std::get_if<double>(&b);
+    if ((ai || ad) && (bi || bd)) {
+        double x = ai ? static_cast<double>(*ai) : *ad;
+        double y = bi ? static_cast<double>(*bi) : *bd;
+        return x == y;
+    }
+    return a == b;  // TEXT by bytes, NULL == NULL, different types unequal
+}
+
+} // namespace
+
+HashJoin::HashJoin(std::vector<Key> build) : build_(std::move(build)) {
+    buckets_.reserve(build_.size());
+    for (size_t i = 0; i < build_.size(); ++i) {
+        buckets_[Hash(build_[i])].push_back(i);
+    }
+}
+
+std::vector<std::pair<size_t, size_t>> HashJoin::Probe(const std::vector<Key>& probe) const {
+    std::vector<std::pair<size_t, size_t>> matches;
+    for (size_t j = 0; j < probe.size(); ++j) {
+        auto it = buckets_.find(Hash(probe[j]));
+        if (it == buckets_.end()) {
+            continue;
+        }
+        for (size_t i : it->second) {
+            if (Equal(build_[i], probe[j])) {
+                matches.emplace_back(i, j);
+            }
+        }
+    }
+    return matches;
+}
+
+std::vector<std::pair<size_t, size_t>> HashJoin::Join(std::vector<Key> build,
+                                                      const std::vector<Key>& probe) {
+    return HashJoin(std::move(build)).Probe(probe);
+}
+
+size_t HashJoin::Hash(const Key& key) {
+    size_t h = key.size();
+    for (const auto& value : key) {
+        h ^= HashValue(value) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+bool HashJoin::Equal(const Key& a, const Key& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!ValuesEqual(a[i], b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace toydb
@@ -0,0 +1,177 @@
+#include "key_encoder.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace toydb {
+
+namespace {
+
+constexpr uint64_t SIGN_BIT = 0x8000000000000000ULL;
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+// Parse 16 lowercase hex digits starting at pos
+uint64_t ParseHex64(const std::string& key, size_t pos) {
+    if (pos + 16 > key.size()) {
+        throw std::runtime_error("Malformed key: truncated number");
+    }
+
+    uint64_t bits = 0;
+    for (size_t i = pos; i < pos + 16; ++i) {
+        char c = key[i];
+        int nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        } else {
+            throw std::runtime_error("Malformed key: bad hex digit");
+        }
+        bits = (bits << 4) | static_cast<uint64_t>(nibble);
+    }
+    return bits;
+}
+
+} // namespace
+
+KeyEncoder& KeyEncoder::AppendNull() {
+    key_.push_back(TAG_NULL);
+    return *this;
+}
+
+KeyEncoder& KeyEncoder::AppendInt(int64_t value) {
+    key_.push_back(TAG_INT);
+    // Flipping the sign bit maps INT64_MIN..INT64_MAX onto 0..UINT64_MAX
+    AppendHex64(static_cast<uint64_t>(value) ^ SIGN_BIT);
+    return *this;
+}
+
+KeyEncoder& KeyEncoder::AppendFloat(double value) {
+    if (value == 0.0) {
+        value = 0.0;  // -0.0 and 0.0 compare equal, encode them the same
+    }
+
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits = (bits & SIGN_BIT) ? ~bits : (bits | SIGN_BIT);
+
+    key_.push_back(TAG_FLOAT);
+    AppendHex64(bits);
+    return *this;
+}
+
+KeyEncoder& KeyEncoder::AppendText(const std::string& value) {
+    key_.push_back(TAG_TEXT);
+    for (char c : value) {
+        key_.push_back(c);
+        if (c == '\0') {
+            key_.push_back('\x01');
+        }
+    }
+    key_.push_back('\0');
+    key_.push_back('\0');
+    return *this;
+}
+
+KeyEncoder& KeyEncoder::Append(const Value& value) {
+    if (std::holds_alternative<int64_t>(value)) {
+        return AppendInt(std::get<int64_t>(value));
+    } else if (std::holds_alternative<double>(value)) {
+        return AppendFloat(std::get<double>(value));
+    } else if (std::holds_alternative<std::string>(value)) {
+        return AppendText(std::get<std::string>(value));
+    }
+    return AppendNull();
+}
+
+void KeyEncoder::AppendHex64(uint64_t bits) {
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        key_.push_back(HEX_DIGITS[(bits >> shift) & 0xF]);
+    }
+}
+
+std::string KeyEncoder::Encode(const std::vector<Value>& values) {
+    KeyEncoder encoder;
+    for (const auto& value : values) {
+        encoder.Append(value);
+    }
+    return encoder.Key();
+}
+
+std::vector<KeyEncoder::Value> KeyEncoder::Decode(const std::string& key) {
+    std::vector<Value> values;
+    size_t pos = 0;
+
+    while (pos < key.size()) {
+        char tag = key[pos++];
+
+        if (tag == TAG_NULL) {
+            values.emplace_back(std::monostate{});
+        } else if (tag == TAG_INT) {
+            uint64_t bits = ParseHex64(key, pos) ^ SIGN_BIT;
+            values.emplace_back(static_cast<int64_t>(bits));
+            pos += 16;
+        } else if (tag == TAG_FLOAT) {
+            uint64_t bits = ParseHex64(key, pos);
+            bits = (bits & SIGN_BIT) ? (bits & ~SIGN_BIT) : ~bits;
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            values.emplace_back(value);
+            pos += 16;
+        } else if (tag == TAG_TEXT) {
+            std::string text;
+            while (true) {
+                if (pos + 1 >= key.size()) {
+                    throw std::runtime_error("Malformed key: unterminated text");
+                }
+                if (key[pos] != '\0') {
+                    text.push_back(key[pos++]);
+                } else if (key[pos + 1] == '\x01') {
+                    text.push_back('\0');
+                    pos += 2;
+                } else if (key[pos + 1] == '\0') {
+                    pos += 2;
+                    break;
+                } else {
+                    throw std::runtime_error("Malformed key: bad text escape");
+                }
+            }
+            values.emplace_back(std::move(text));
+        } else {
+            throw std::runtime_error("Malformed key: unknown type tag");
+        }
+    }
+
+    return values;
+}
+
+size_t KeyEncoder::ComponentSize(const std::string& key, size_t pos) {
+    if (pos >= key.size()) {
+        throw std::runtime_error("Malformed key: missing component");
+    }
+
+    char tag = key[pos];
+    if (tag == TAG_NULL) {
+        return 1;
+    }
+    if (tag == TAG_INT || tag == TAG_FLOAT) {
+        if (pos + 17 > key.size()) {
+            throw std::runtime_error("Malformed key: truncated number");
+        }
+        return 17;
+    }
+    if (tag == TAG_TEXT) {
+        // Ends at the first 0x00 0x00; 0x00 0x01 is an escaped NUL
+        for (size_t i = pos + 1; i + 1 < key.size(); ++i) {
+            if (key[i] == '\0') {
+                if (key[i + 1] == '\0') {
+                    return i + 2 - pos;
+                }
+                ++i;
+            }
+        }
+        throw std::runtime_error("Malformed key: unterminated text");
+    }
+    throw std::runtime_error("Malformed key: unknown type tag");
+}
+
+} // namespace toydb
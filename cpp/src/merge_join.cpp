@@ -0,0 +1,66 @@
+#include "merge_join.hpp"
+#include "key_encoder.hpp"
+
+namespace toydb {
+
+namespace {
+
+// Every key starting with prefix (0xFF never occurs in UTF-8 keys)
+std::string PrefixEnd(const std::string& prefix) {
+    return prefix + '\xff';
+}
+
+} // namespace
+
+MergeJoin::MergeJoin(BTree* left_tree, const std::string& left_prefix,
+                     BTree* right_tree, const std::string& right_prefix,
+                     const std::string& after_value)
+    : left_(left_tree->Seek(left_prefix + after_value, PrefixEnd(left_prefix))),
+      right_(right_tree->Seek(right_prefix + after_value, PrefixEnd(right_prefix))),
+      left_prefix_size_(left_prefix.size()),
+      right_prefix_size_(right_prefix.size()) {
+    if (after_value.empty()) {
+        return;
+    }
+    // Encoded components are prefix-free, so the keys of after_value come
+    // first from the seek position on
+    while (left_.Valid() && JoinValue(left_.Key(), left_prefix_size_) == after_value) {
+        left_.Next();
+    }
+    while (right_.Valid() && JoinValue(right_.Key(), right_prefix_size_) == after_value) {
+        right_.Next();
+    }
+}
+
+std::string MergeJoin::JoinValue(const std::string& key, size_t prefix_size) {
+    return key.substr(prefix_size, KeyEncoder::ComponentSize(key, prefix_size));
+}
+
+bool MergeJoin::Next(Group& group) {
+    group.left.clear();
+    group.right.clear();
+
+    while (left_.Valid() && right_.Valid()) {
+        std::string value = JoinValue(left_.Key(), left_prefix_size_);
+        int order = value.compare(JoinValue(right_.Key(), right_prefix_size_));
+        if (order < 0) {
+            left_.Next();
+        } else if (order > 0) {
+            right_.Next();
+        } else {
+            // Equal keys are adjacent on both sides
+            do {
+                group.left.emplace_back(left_.Key(), left_.Value());
+                left_.Next();
+            } while (left_.Valid() && JoinValue(left_.Key(), left_prefix_size_) == value);
+            do {
+                group.right.emplace_back(right_.Key(), right_.Value());
+                right_.Next();
+            } while (right_.Valid() && JoinValue(right_.Key(), right_prefix_size_) == value);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace toydb
@@ -0,0 +1,100 @@
+#include "merge_operator.hpp"
+#include "posting_list.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace toydb {
+
+namespace {
+
+// Parse a whole string as a signed 64-bit integer
+int64_t ParseInt(const std::string& s) {
+    size_t pos = 0;
+    int64_t v = std::stoll(s, &pos);
+    if (pos != s.size()) {
+        throw std::invalid_argument("Not an integer: " + s);
+    }
+    return v;
+}
+
+// Parse a whole string as an unsigned 64-bit row ID
+uint64_t ParseRowID(const std::string& s) {
+    size_t pos = 0;
+    uint64_t v = std::stoull(s, &pos);
+    if (pos != s.size() || s[0] == '-') {
+        throw std::invalid_argument("Not a row ID: " + s);
+    }
+    return v;
+}
+
+} // namespace
+
+std::string IntAddOperator::Merge(const std::optional<std::string>& existing,
+                                  const std::string& operand) const {
+    int64_t delta = ParseInt(operand);
+    if (!existing.has_value()) {
+        return std::to_string(delta);
+    }
+    int64_t sum;
+    if (__builtin_add_overflow(ParseInt(existing.value()), delta, &sum)) {
+        throw std::overflow_error("Integer overflow adding " + operand + " to " + existing.value());
+    }
+    return std::to_string(sum);
+}
+
+std::string IntMaxOperator::Merge(const std::optional<std::string>& existing,
+                                  const std::string& operand) const {
+    int64_t candidate = ParseInt(operand);
+    if (!existing.has_value()) {
+        return std::to_string(candidate);
+    }
+    return std::to_string(std::max(ParseInt(existing.value()), candidate));
+}
+
+std::string StringAppendOperator::Merge(const std::optional<std::string>& existing,
+                                        const std::string& operand) const {
+    if (!existing.has_value() || existing->empty()) {
+        return operand;
+    }
+    return existing.value() + delimiter_ + operand;
+}
+
+std::string PostingAddOperator::Merge(const std::optional<std::string>& existing,
+                                      const std::string& operand) const {
+    return PostingList::Add(existing.value_or(""), ParseRowID(operand));
+}
+
+std::string PostingRemoveOperator::Merge(const std::optional<std::string>& existing,
+                                         const std::string& operand) const {
+    return PostingList::Remove(existing.value_or(""), ParseRowID(operand));
+}
+
+MergeOperatorRegistry::MergeOperatorRegistry() {
+    Register(std::make_shared<IntAddOperator>());
+    Register(std::make_shared<IntMaxOperator>());
+    Register(std::make_shared<StringAppendOperator>());
+    Register(std::make_shared<PostingAddOperator>());
+    Register(std::make_shared<PostingRemoveOperator>());
+}
+
+void MergeOperatorRegistry::Register(std::shared_ptr<MergeOperator> op) {
+    if (!op) {
+        throw std::invalid_argument("Merge operator must not be null");
+    }
+    operators_[op->Name()] = std::move(op);
+}
+
+const MergeOperator* MergeOperatorRegistry::Find(const std::string& name) const {
+    auto it = operators_.find(name);
+    return it != operators_.end() ? it->second.get() : nullptr;
+}
+
+const MergeOperator& MergeOperatorRegistry::Get(const std::string& name) const {
+    const MergeOperator* op = Find(name);
+    if (!op) {
+        throw std::runtime_error("Unknown merge operator: " + name);
+    }
+    return *op;
+}
+
+} // namespace toydb
@@ -1,9 +1,17 @@
 #include "page_manager.hpp"
+#include <cstring>
 #include <stdexcept>
 #include <iostream>
 
 namespace toydb {
 
+namespace {
+
+// Page header type of a page on the free list (see Page::Header)
+constexpr uint16_t FREE_PAGE_TYPE = 0;
+
+} // namespace
+
 PageManager::PageManager(const std::string& db_file) 
     : db_file_(db_file), next_page_id_(1) {
     OpenOrCreateFile();
@@ -43,11 +51,37 @@ void PageManager::OpenOrCreateFile() {
             // Corrupted file or wrong page size
             std::cerr << "Warning: Database file size mismatch" << std::endl;
         }
+        
+        LoadFreePages();
+    }
+}
+
+void PageManager::LoadFreePages() {
+    // Only the header of each page is read. Pages never written read
+    // back as zeros (page ID 0) and are not taken for free ones.
+    Page::Header header;
+    for (PageID page_id = 1; page_id < next_page_id_; ++page_id) {
+        file_.seekg(static_cast<std::streamoff>(page_id - 1) * PAGE_SIZE, std::ios::beg);
+        file_.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file_.good()) {
+            file_.clear();
+            break;
+        }
+        if (header.page_id == page_id && header.page_type == FREE_PAGE_TYPE) {
+            free_pages_.push_back(page_id);
+        }
     }
 }
 
 PageID PageManager::AllocatePage() {
-    PageID new_id = next_page_id_++;
+    PageID new_id;
+    if (!free_pages_.empty()) {
+        new_id = free_pages_.back();
+        free_pages_.pop_back();
+        unmarked_free_.erase(new_id);
+    } else {
+        new_id = next_page_id_++;
+    }
     
     // Create new page
     auto page = std::make_shared<Page>(new_id);
@@ -59,6 +93,27 @@ PageID PageManager::AllocatePage() {
     return new_id;
 }
 
+void PageManager::FreePage(PageID page_id) {
+    if (page_id == INVALID_PAGE_ID || page_id >= next_page_id_) {
+        return;
+    }
+    
+    // Drop cached copy; the page is re-initialized when reallocated
+    cache_.erase(page_id);
+    free_pages_.push_back(page_id);
+    unmarked_free_.insert(page_id);
+}
+
+void PageManager::WriteFreePages() {
+    for (PageID page_id : unmarked_free_) {
+        auto page = std::make_shared<Page>(page_id);
+        page->SetPageType(FREE_PAGE_TYPE);
+        std::memcpy(page->GetData(), &page->GetHeader(), sizeof(Page::Header));
+        WritePage(page);
+    }
+    unmarked_free_.clear();
+}
+
 std::shared_ptr<Page> PageManager::ReadPage(PageID page_id) {
     if (page_id == INVALID_PAGE_ID || page_id >= next_page_id_) {
         return nullptr;
@@ -116,11 +171,14 @@ bool PageManager::WritePage(const std::shared_ptr<Page>& page) {
         return false;
     }
     
+    cache_.erase(page_id);
     return true;
 }
 
 void PageManager::FlushAll() {
-    for (const auto& [page_id, page] : cache_) {
+    // WritePage drops each written page from the cache
+    for (auto it = cache_.begin(); it != cache_.end();) {
+        auto page = (it++)->second;
         WritePage(page);
     }
     
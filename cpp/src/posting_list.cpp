@@ -0,0 +1,94 @@
+#include "posting_list.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace toydb {
+
+namespace {
+
+constexpr char MORE_BASE = '0';   // '0'..'O': more digits follow
+constexpr char LAST_BASE = 'P';   // 'P'..'o': last digit
+
+} // namespace
+
+std::string PostingList::Encode(std::vector<uint64_t> ids) {
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    std::string out;
+    uint64_t prev = 0;
+    for (uint64_t id : ids) {
+        AppendVarint(out, id - prev);
+        prev = id;
+    }
+    return out;
+}
+
+std::vector<uint64_t> PostingList::Decode(const std::string& data) {
+    std::vector<uint64_t> ids;
+    uint64_t prev = 0;
+    uint64_t value = 0;
+    int shift = 0;
+
+    for (char c : data) {
+        uint64_t digit;
+        bool last;
+        if (c >= MORE_BASE && c < MORE_BASE + 32) {
+            digit = c - MORE_BASE;
+            last = false;
+        } else if (c >= LAST_BASE && c < LAST_BASE + 32) {
+            digit = c - LAST_BASE;
+            last = true;
+        } else {
+            throw std::runtime_error("Malformed posting list");
+        }
+
+        if (shift > 60) {
+            throw std::runtime_error("Malformed posting list: varint too long");
+        }
+        value |= digit << shift;
+        shift += 5;
+
+        if (last) {
+            prev += value;
+            ids.push_back(prev);
+            value = 0;
+            shift = 0;
+        }
+    }
+
+    if (shift != 0) {
+        throw std::runtime_error("Malformed posting list: truncated varint");
+    }
+    return ids;
+}
+
+std::string PostingList::Add(const std::string& data, uint64_t id) {
+    auto ids = Decode(data);
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it != ids.end() && *it == id) {
+        return data;
+    }
+    ids.insert(it, id);
+    return Encode(std::move(ids));
+}
+
+std::string PostingList::Remove(const std::string& data, uint64_t id) {
+    auto ids = Decode(data);
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it == ids.end() || *it != id) {
+        return data;
+    }
+    ids.erase(it);
+    return Encode(std::move(ids));
+}
+
+void PostingList::AppendVarint(std::string& out, uint64_t value) {
+    while (value >= 32) {
+        out.push_back(static_cast<char>(MORE_BASE + (value & 31)));
+        value >>= 5;
+    }
+    out.push_back(static_cast<char>(LAST_BASE + value));
+}
+
+} // namespace toydb
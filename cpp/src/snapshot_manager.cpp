@@ -0,0 +1,488 @@
+#include "snapshot_manager.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace toydb {
+
+SnapshotManager::Isolation SnapshotManager::ParseIsolation(const std::string& name) {
+    if (name.empty()) {
+        return Isolation::NONE;
+    }
+    if (name == "snapshot") {
+        return Isolation::SNAPSHOT;
+    }
+    if (name == "serializable") {
+        return Isolation::SERIALIZABLE;
+    }
+    throw std::invalid_argument("Unknown isolation level: " + name);
+}
+
+SnapshotManager::~SnapshotManager() {
+    StopSweeper();
+}
+
+void SnapshotManager::Begin(uint64_t txn_id, Isolation isolation) {
+    if (isolation == Isolation::NONE) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    TxnState state;
+    state.isolation = isolation;
+    state.snapshot_seq = commit_seq_;
+    txns_[txn_id] = std::move(state);
+    active_++;
+    oldest_snapshot_ = std::min(oldest_snapshot_, commit_seq_);
+}
+
+bool SnapshotManager::IsTracked(uint64_t txn_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = txns_.find(txn_id);
+    return it != txns_.end() && it->second.commit_seq == 0;
+}
+
+bool SnapshotManager::VersionsNeeded() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_ > 0;
+}
+
+const SnapshotManager::Version* SnapshotManager::Visible(const std::vector<Version>& chain,
+                                                         uint64_t txn_id,
+                                                         uint64_t snapshot_seq) const {
+    for (const auto& version : chain) {
+        if (version.end_seq == PENDING && version.writer == txn_id) {
+            return nullptr;  // Own write: the tree holds it
+        }
+    }
+    for (const auto& version : chain) {
+        if (version.end_seq > snapshot_seq) {
+            return &version;
+        }
+    }
+    return nullptr;
+}
+
+bool SnapshotManager::Concurrent(const TxnState& other, uint64_t txn_id) const {
+    if (other.commit_seq == 0) {
+        return true;
+    }
+    auto it = txns_.find(txn_id);
+    return it != txns_.end() && other.commit_seq > it->second.snapshot_seq;
+}
+
+bool SnapshotManager::Locked(const TxnState& state, const std::string& key) const {
+    if (state.read_keys.count(key)) {
+        return true;
+    }
+    for (const auto& [start, end] : state.read_ranges) {
+        if (key >= start && key <= end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SnapshotManager::CompletesPivot(uint64_t reader, uint64_t writer) const {
+    // A new edge gives the reader an outgoing and the writer an incoming
+    // conflict; if that completes a pivot that already committed, only
+    // the transaction acting now can still be aborted.
+    auto r = txns_.find(reader);
+    if (r != txns_.end() && r->second.commit_seq != 0 && !r->second.in_conflicts.empty()) {
+        return true;
+    }
+    auto w = txns_.find(writer);
+    return w != txns_.end() && w->second.commit_seq != 0 && !w->second.out_conflicts.empty();
+}
+
+void SnapshotManager::MarkConflict(uint64_t reader, uint64_t writer) {
+    auto r = txns_.find(reader);
+    if (r != txns_.end()) {
+        r->second.out_conflicts.insert(writer);
+    }
+    auto w = txns_.find(writer);
+    if (w != txns_.end()) {
+        w->second.in_conflicts.insert(reader);
+    }
+}
+
+void SnapshotManager::CheckWrite(uint64_t txn_id, const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto self = txns_.find(txn_id);
+    bool tracked = self != txns_.end() && self->second.commit_seq == 0;
+
+    auto chain = versions_.find(key);
+    if (tracked && chain != versions_.end()) {
+        for (const auto& version : chain->second) {
+            if (version.writer == txn_id) {
+                continue;
+            }
+            if (version.end_seq == PENDING) {
+                throw std::runtime_error("Write conflict on key '" + key + "': transaction " +
+                                         std::to_string(version.writer) + " has not finished");
+            }
+            if (version.end_seq > self->second.snapshot_seq) {
+                throw std::runtime_error("Write conflict on key '" + key +
+                                         "': changed after transaction " +
+                                         std::to_string(txn_id) + " began");
+            }
+        }
+    }
+
+    for (const auto& [reader, state] : txns_) {
+        if (reader != txn_id && state.isolation == Isolation::SERIALIZABLE &&
+            Locked(state, key) && Concurrent(state, txn_id) && CompletesPivot(reader, txn_id)) {
+            throw std::runtime_error("Serialization failure: writing '" + key +
+                                     "' would complete a dependency cycle");
+        }
+    }
+}
+
+void SnapshotManager::RecordWrite(uint64_t txn_id, const std::string& key,
+                                  const std::optional<std::string>& before) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& chain = versions_[key];
+    PruneChain(chain);
+    for (const auto& version : chain) {
+        if (version.end_seq == PENDING) {
+            return;  // Only the first uncommitted write keeps the committed value
+        }
+    }
+    chain.push_back(Version{before, PENDING, txn_id});
+    pending_[txn_id].push_back(key);
+
+    for (const auto& [reader, state] : txns_) {
+        if (reader != txn_id && state.isolation == Isolation::SERIALIZABLE &&
+            Locked(state, key) && Concurrent(state, txn_id)) {
+            MarkConflict(reader, txn_id);
+        }
+    }
+}
+
+std::optional<std::optional<std::string>> SnapshotManager::Read(uint64_t txn_id,
+                                                                const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto self = txns_.find(txn_id);
+    if (self == txns_.end() || self->second.commit_seq != 0) {
+        return std::nullopt;
+    }
+    TxnState& state = self->second;
+    if (state.isolation == Isolation::SERIALIZABLE) {
+        state.read_keys.insert(key);
+    }
+
+    auto chain = versions_.find(key);
+    if (chain == versions_.end()) {
+        return std::nullopt;
+    }
+    PruneChain(chain->second);
+    if (chain->second.empty()) {
+        versions_.erase(chain);
+        return std::nullopt;
+    }
+
+    const Version* visible = Visible(chain->second, txn_id, state.snapshot_seq);
+    if (!visible) {
+        return std::nullopt;
+    }
+
+    if (state.isolation == Isolation::SERIALIZABLE) {
+        // Reading past a newer version: rw-antidependency to its writer
+        for (const auto& version : chain->second) {
+            if (version.end_seq > state.snapshot_seq && CompletesPivot(txn_id, version.writer)) {
+                throw std::runtime_error("Serialization failure: reading '" + key +
+                                         "' would complete a dependency cycle");
+            }
+        }
+        for (const auto& version : chain->second) {
+            if (version.end_seq > state.snapshot_seq) {
+                MarkConflict(txn_id, version.writer);
+            }
+        }
+    }
+    return visible->value;
+}
+
+void SnapshotManager::ReadRange(uint64_t txn_id, const std::string& start_key,
+                                const std::string& end_key,
+                                std::vector<std::pair<std::string, std::string>>& rows) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto self = txns_.find(txn_id);
+    if (self == txns_.end() || self->second.commit_seq != 0) {
+        return;
+    }
+    TxnState& state = self->second;
+    if (start_key > end_key) {
+        return;
+    }
+    if (state.isolation == Isolation::SERIALIZABLE) {
+        state.read_ranges.emplace_back(start_key, end_key);
+    }
+
+    // Visible versions of keys in range; they override the tree rows
+    std::map<std::string, std::optional<std::string>> overrides;
+    auto first = versions_.lower_bound(start_key);
+    auto last = versions_.upper_bound(end_key);
+    for (auto it = first; it != last;) {
+        PruneChain(it->second);
+        if (it->second.empty()) {
+            it = versions_.erase(it);
+            continue;
+        }
+        const Version* visible = Visible(it->second, txn_id, state.snapshot_seq);
+        if (visible) {
+            overrides.emplace(it->first, visible->value);
+        }
+        ++it;
+    }
+    if (overrides.empty()) {
+        return;
+    }
+
+    if (state.isolation == Isolation::SERIALIZABLE) {
+        for (const auto& [key, value] : overrides) {
+            for (const auto& version : versions_.at(key)) {
+                if (version.end_seq > state.snapshot_seq &&
+                    CompletesPivot(txn_id, version.writer)) {
+                    throw std::runtime_error("Serialization failure: reading '" + key +
+                                             "' would complete a dependency cycle");
+                }
+            }
+        }
+        for (const auto& [key, value] : overrides) {
+            for (const auto& version : versions_.at(key)) {
+                if (version.end_seq > state.snapshot_seq) {
+                    MarkConflict(txn_id, version.writer);
+                }
+            }
+        }
+    }
+
+    // Merge the sorted tree rows with the overrides
+    std::vector<std::pair<std::string, std::string>> merged;
+    merged.reserve(rows.size() + overrides.size());
+    auto over = overrides.begin();
+    for (auto& row : rows) {
+        while (over != overrides.end() && over->first < row.first) {
+            if (over->second) {
+                merged.emplace_back(over->first, *over->second);
+            }
+            ++over;
+        }
+        if (over != overrides.end() && over->first == row.first) {
+            if (over->second) {
+                merged.emplace_back(over->first, *over->second);
+            }
+            ++over;
+        } else {
+            merged.push_back(std::move(row));
+        }
+    }
+    for (; over != overrides.end(); ++over) {
+        if (over->second) {
+            merged.emplace_back(over->first, *over->second);
+        }
+    }
+    rows = std::move(merged);
+}
+
+bool SnapshotManager::CanCommit(uint64_t txn_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = txns_.find(txn_id);
+    if (it == txns_.end() || it->second.isolation != Isolation::SERIALIZABLE) {
+        return true;
+    }
+    return it->second.in_conflicts.empty() || it->second.out_conflicts.empty();
+}
+
+void SnapshotManager::Commit(uint64_t txn_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t seq = ++commit_seq_;
+
+    auto written = pending_.find(txn_id);
+    if (written != pending_.end()) {
+        for (const auto& key : written->second) {
+            for (auto& version : versions_[key]) {
+                if (version.end_seq == PENDING && version.writer == txn_id) {
+                    version.end_seq = seq;
+                    committed_versions_++;
+                }
+            }
+        }
+        pending_.erase(written);
+    }
+
+    auto it = txns_.find(txn_id);
+    if (it != txns_.end() && it->second.commit_seq == 0) {
+        active_--;
+        if (it->second.isolation == Isolation::SERIALIZABLE) {
+            it->second.commit_seq = seq;  // SIREAD locks outlive the commit
+        } else {
+            txns_.erase(it);
+        }
+    }
+
+    Prune();
+}
+
+void SnapshotManager::Abort(uint64_t txn_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto written = pending_.find(txn_id);
+    if (written != pending_.end()) {
+        for (const auto& key : written->second) {
+            auto chain = versions_.find(key);
+            if (chain == versions_.end()) {
+                continue;
+            }
+            auto& versions = chain->second;
+            versions.erase(std::remove_if(versions.begin(), versions.end(),
+                                          [txn_id](const Version& v) {
+                                              return v.end_seq == PENDING && v.writer == txn_id;
+                                          }),
+                           versions.end());
+            if (versions.empty()) {
+                versions_.erase(chain);
+            }
+        }
+        pending_.erase(written);
+    }
+
+    auto it = txns_.find(txn_id);
+    if (it != txns_.end() && it->second.commit_seq == 0) {
+        active_--;
+        txns_.erase(it);
+    }
+
+    // Conflicts with an aborted transaction no longer matter
+    for (auto& [other, state] : txns_) {
+        state.in_conflicts.erase(txn_id);
+        state.out_conflicts.erase(txn_id);
+    }
+
+    Prune();
+}
+
+size_t SnapshotManager::VersionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& [key, chain] : versions_) {
+        count += chain.size();
+    }
+    return count;
+}
+
+SnapshotManager::VersionStats SnapshotManager::GetVersionStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    VersionStats stats{0, versions_.size(), 0, 0, 0, pruned_};
+    for (const auto& [key, chain] : versions_) {
+        stats.versions += chain.size();
+        stats.max_chain_length = std::max(stats.max_chain_length, chain.size());
+    }
+    if (active_ > 0) {
+        stats.oldest_snapshot_lag = commit_seq_ - oldest_snapshot_;
+        stats.oldest_snapshot_txn = UINT64_MAX;
+        for (const auto& [txn_id, state] : txns_) {
+            if (state.commit_seq == 0 && state.snapshot_seq == oldest_snapshot_) {
+                stats.oldest_snapshot_txn = std::min(stats.oldest_snapshot_txn, txn_id);
+            }
+        }
+    }
+    return stats;
+}
+
+size_t SnapshotManager::CollectVersions(size_t max_keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t budget = versions_.size();
+    if (max_keys > 0) {
+        budget = std::min(budget, max_keys);
+    }
+
+    // Walk the chains round-robin from where the last pass stopped
+    size_t pruned = 0;
+    auto it = versions_.lower_bound(sweep_cursor_);
+    for (size_t i = 0; i < budget && !versions_.empty(); i++) {
+        if (it == versions_.end()) {
+            it = versions_.begin();
+        }
+        pruned += PruneChain(it->second);
+        it = it->second.empty() ? versions_.erase(it) : std::next(it);
+    }
+    sweep_cursor_ = it == versions_.end() ? std::string() : it->first;
+    return pruned;
+}
+
+void SnapshotManager::StartSweeper(std::chrono::milliseconds interval, size_t keys_per_pass) {
+    if (sweeper_.joinable()) {
+        return;
+    }
+    sweeper_stop_ = false;
+    sweeper_ = std::thread([this, interval, keys_per_pass] {
+        std::unique_lock<std::mutex> lock(sweeper_mutex_);
+        while (!sweeper_cv_.wait_for(lock, interval, [this] { return sweeper_stop_; })) {
+            CollectVersions(keys_per_pass);
+        }
+    });
+}
+
+void SnapshotManager::StopSweeper() {
+    if (!sweeper_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sweeper_mutex_);
+        sweeper_stop_ = true;
+    }
+    sweeper_cv_.notify_all();
+    sweeper_.join();
+}
+
+void SnapshotManager::UpdateOldestSnapshot() {
+    oldest_snapshot_ = UINT64_MAX;
+    for (const auto& [txn_id, state] : txns_) {
+        if (state.commit_seq == 0) {
+            oldest_snapshot_ = std::min(oldest_snapshot_, state.snapshot_seq);
+        }
+    }
+}
+
+size_t SnapshotManager::PruneChain(std::vector<Version>& chain) {
+    uint64_t oldest = oldest_snapshot_;
+    auto kept = std::remove_if(chain.begin(), chain.end(), [oldest](const Version& v) {
+        return v.end_seq != PENDING && v.end_seq <= oldest;
+    });
+    size_t removed = static_cast<size_t>(chain.end() - kept);
+    chain.erase(kept, chain.end());
+    committed_versions_ -= removed;
+    pruned_ += removed;
+    return removed;
+}
+
+void SnapshotManager::Prune() {
+    UpdateOldestSnapshot();
+    if (active_ > 0) {
+        // Committed serializable txns matter while an overlapping one runs
+        for (auto it = txns_.begin(); it != txns_.end();) {
+            if (it->second.commit_seq != 0 && it->second.commit_seq <= oldest_snapshot_) {
+                it = txns_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return;
+    }
+
+    // No snapshot is running: only uncommitted writes need their versions
+    txns_.clear();
+    if (committed_versions_ == 0) {
+        return;
+    }
+    for (auto it = versions_.begin(); it != versions_.end();) {
+        auto& versions = it->second;
+        versions.erase(std::remove_if(versions.begin(), versions.end(),
+                                      [](const Version& v) { return v.end_seq != PENDING; }),
+                       versions.end());
+        it = versions.empty() ? versions_.erase(it) : std::next(it);
+    }
+    pruned_ += committed_versions_;
+    committed_versions_ = 0;
+}
+
+} // namespace toydb
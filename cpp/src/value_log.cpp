@@ -0,0 +1,196 @@
+#include "value_log.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+
+namespace toydb {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t RECORD_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+} // namespace
+
+ValueLog::ValueLog(const std::string& base_path, uint64_t segment_size)
+    : base_path_(base_path),
+      segment_size_(segment_size > 0 ? segment_size : SEGMENT_SIZE),
+      active_segment_(1) {
+
+    // Find existing segments: <base>.<n>
+    fs::path base(base_path_);
+    fs::path dir = base.parent_path().empty() ? fs::path(".") : base.parent_path();
+    std::string prefix = base.filename().string() + ".";
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        std::string number = name.substr(prefix.size());
+        if (!std::all_of(number.begin(), number.end(),
+                         [](unsigned char c) { return std::isdigit(c) != 0; })) {
+            continue;
+        }
+        segments_[static_cast<uint32_t>(std::stoul(number))] = entry.file_size();
+    }
+
+    // Never append after a possibly torn tail: start a fresh segment
+    if (!segments_.empty()) {
+        active_segment_ = segments_.rbegin()->first + 1;
+    }
+}
+
+ValueLog::~ValueLog() {
+    if (writer_.is_open()) {
+        writer_.flush();
+        writer_.close();
+    }
+}
+
+std::string ValueLog::SegmentPath(uint32_t segment) const {
+    return base_path_ + "." + std::to_string(segment);
+}
+
+void ValueLog::OpenActive(uint32_t segment) {
+    if (writer_.is_open()) {
+        writer_.flush();
+        writer_.close();
+    }
+
+    active_segment_ = segment;
+    writer_.open(SegmentPath(segment), std::ios::binary | std::ios::app);
+    if (!writer_.is_open()) {
+        throw std::runtime_error("Failed to open value log segment: " + SegmentPath(segment));
+    }
+    segments_.emplace(segment, 0);
+}
+
+ValuePointer ValueLog::Append(const std::string& key, const std::string& value) {
+    uint64_t record_size = RECORD_HEADER_SIZE + key.size() + value.size();
+
+    if (!writer_.is_open()) {
+        OpenActive(active_segment_);
+    } else if (segments_[active_segment_] > 0 &&
+               segments_[active_segment_] + record_size > segment_size_) {
+        OpenActive(active_segment_ + 1);
+    }
+
+    uint64_t start = segments_[active_segment_];
+    uint32_t key_len = key.size();
+    uint32_t value_len = value.size();
+
+    writer_.write(reinterpret_cast<const char*>(&key_len), sizeof(key_len));
+    writer_.write(reinterpret_cast<const char*>(&value_len), sizeof(value_len));
+    writer_.write(key.data(), key.size());
+    writer_.write(value.data(), value.size());
+    writer_.flush();
+    if (!writer_) {
+        throw std::runtime_error("Failed to append to value log");
+    }
+
+    segments_[active_segment_] = start + record_size;
+    return ValuePointer{active_segment_, start + RECORD_HEADER_SIZE + key.size(), value_len};
+}
+
+std::ifstream& ValueLog::Reader(uint32_t segment) {
+    auto it = readers_.find(segment);
+    if (it == readers_.end()) {
+        auto reader = std::make_unique<std::ifstream>(SegmentPath(segment), std::ios::binary);
+        if (!reader->is_open()) {
+            throw std::runtime_error("Missing value log segment: " + SegmentPath(segment));
+        }
+        it = readers_.emplace(segment, std::move(reader)).first;
+    }
+
+    it->second->clear();  // Segment may have grown since the last read
+    return *it->second;
+}
+
+std::string ValueLog::Read(const ValuePointer& pointer) {
+    std::ifstream& reader = Reader(pointer.segment);
+
+    std::string value(pointer.length, '\0');
+    reader.seekg(pointer.offset);
+    reader.read(&value[0], pointer.length);
+    if (static_cast<size_t>(reader.gcount()) != pointer.length) {
+        throw std::runtime_error("Truncated value log record in segment " +
+                                 std::to_string(pointer.segment));
+    }
+    return value;
+}
+
+std::vector<uint32_t> ValueLog::SealedSegments() const {
+    std::vector<uint32_t> sealed;
+    for (const auto& [segment, size] : segments_) {
+        if (segment != active_segment_) {
+            sealed.push_back(segment);
+        }
+    }
+    return sealed;
+}
+
+std::vector<ValueLog::Record> ValueLog::ReadSegment(uint32_t segment) {
+    std::vector<Record> records;
+    std::ifstream& reader = Reader(segment);
+    reader.seekg(0);
+
+    uint64_t offset = 0;
+    while (true) {
+        uint32_t key_len, value_len;
+        reader.read(reinterpret_cast<char*>(&key_len), sizeof(key_len));
+        reader.read(reinterpret_cast<char*>(&value_len), sizeof(value_len));
+        if (!reader) {
+            break;
+        }
+
+        Record record;
+        record.key.resize(key_len);
+        record.value.resize(value_len);
+        reader.read(&record.key[0], key_len);
+        reader.read(&record.value[0], value_len);
+        if (!reader) {
+            break;  // Torn tail of a crashed append
+        }
+
+        record.pointer = ValuePointer{segment, offset + RECORD_HEADER_SIZE + key_len, value_len};
+        offset += RECORD_HEADER_SIZE + key_len + value_len;
+        records.push_back(std::move(record));
+    }
+
+    return records;
+}
+
+uint64_t ValueLog::SegmentSize(uint32_t segment) const {
+    auto it = segments_.find(segment);
+    return it != segments_.end() ? it->second : 0;
+}
+
+void ValueLog::DropSegment(uint32_t segment) {
+    if (segment == active_segment_) {
+        throw std::runtime_error("Cannot drop the active value log segment");
+    }
+    readers_.erase(segment);
+    segments_.erase(segment);
+    std::remove(SegmentPath(segment).c_str());
+}
+
+uint64_t ValueLog::TotalSize() const {
+    uint64_t total = 0;
+    for (const auto& [segment, size] : segments_) {
+        total += size;
+    }
+    return total;
+}
+
+void ValueLog::Flush() {
+    if (writer_.is_open()) {
+        writer_.flush();
+    }
+}
+
+} // namespace toydb
@@ -1,11 +1,23 @@
 #include "wal.hpp"
+#include <algorithm>
 #include <cstring>
+#include <functional>
 #include <stdexcept>
+#include <thread>
+#include <tuple>
 
 namespace toydb {
 
+namespace {
+
+// val_len of a value of LONG_VALUE bytes or more: the real length follows
+// as [val_len:4]. Shorter values keep the original two-byte field.
+constexpr uint16_t LONG_VALUE = 0xFFFF;
+
+} // namespace
+
 WAL::WAL(const std::string& wal_file) 
-    : wal_file_(wal_file), current_lsn_(0) {
+    : wal_file_(wal_file), current_lsn_(0), flushed_lsn_(0), size_(0) {
     
     // Try to open existing WAL file
     log_.open(wal_file_, std::ios::in | std::ios::out | std::ios::binary);
@@ -27,6 +39,7 @@ WAL::WAL(const std::string& wal_file)
         // Existing WAL - read last LSN
         log_.seekg(0, std::ios::end);
         size_t file_size = log_.tellg();
+        size_ = file_size;
         
         if (file_size > 0) {
             // Read all records to find max LSN
@@ -36,6 +49,7 @@ WAL::WAL(const std::string& wal_file)
             }
         }
     }
+    flushed_lsn_ = current_lsn_.load();
 }
 
 WAL::~WAL() {
@@ -80,6 +94,93 @@ uint64_t WAL::LogDelete(uint64_t txn_id, PageID page_id,
     return WriteRecord(record);
 }
 
+uint64_t WAL::LogDeleteRange(uint64_t txn_id, PageID page_id,
+                             const std::string& start_key, const std::string& end_key) {
+    WALRecord record;
+    record.type = RecordType::DELETE_RANGE;
+    record.txn_id = txn_id;
+    record.page_id = page_id;
+    record.key = start_key;
+    record.value = end_key;
+    
+    return WriteRecord(record);
+}
+
+uint64_t WAL::LogMerge(uint64_t txn_id, PageID page_id,
+                       const std::string& key, const std::string& op_name,
+                       const std::string& operand, const std::string& result) {
+    WALRecord record;
+    record.type = RecordType::MERGE;
+    record.txn_id = txn_id;
+    record.page_id = page_id;
+    record.key = key;
+    
+    // [op_name] '\0' [operand_len:4] [operand] [result]
+    record.value = op_name;
+    record.value.push_back('\0');
+    uint32_t operand_len = operand.size();
+    for (int i = 0; i < 4; ++i) {
+        record.value.push_back((operand_len >> (i * 8)) & 0xFF);
+    }
+    record.value += operand;
+    record.value += result;
+    
+    return WriteRecord(record);
+}
+
+void WAL::DecodeMerge(const WALRecord& record, std::string& op_name,
+                      std::string& operand, std::string& result) {
+    size_t sep = record.value.find('\0');
+    if (sep == std::string::npos || record.value.size() < sep + 5) {
+        throw std::runtime_error("Malformed MERGE record at LSN " + std::to_string(record.lsn));
+    }
+    uint32_t operand_len = 0;
+    for (int i = 0; i < 4; ++i) {
+        operand_len |= static_cast<uint32_t>(static_cast<uint8_t>(record.value[sep + 1 + i]))
+                       << (i * 8);
+    }
+    if (record.value.size() < sep + 5 + operand_len) {
+        throw std::runtime_error("Malformed MERGE record at LSN " + std::to_string(record.lsn));
+    }
+    op_name = record.value.substr(0, sep);
+    operand = record.value.substr(sep + 5, operand_len);
+    result = record.value.substr(sep + 5 + operand_len);
+}
+
+uint64_t WAL::LogUndo(uint64_t txn_id, PageID page_id, const std::string& key,
+                      const std::optional<std::string>& before_value, uint64_t before_version) {
+    WALRecord record;
+    record.type = RecordType::UNDO;
+    record.txn_id = txn_id;
+    record.page_id = page_id;
+    record.key = key;
+    
+    // [version:8] [value], or empty when the key did not exist
+    if (before_value) {
+        for (int i = 0; i < 8; ++i) {
+            record.value.push_back((before_version >> (i * 8)) & 0xFF);
+        }
+        record.value += *before_value;
+    }
+    
+    return WriteRecord(record);
+}
+
+bool WAL::DecodeUndo(const WALRecord& record, std::string& value, uint64_t& version) {
+    if (record.value.empty()) {
+        return false;
+    }
+    if (record.value.size() < 8) {
+        throw std::runtime_error("Malformed UNDO record at LSN " + std::to_string(record.lsn));
+    }
+    version = 0;
+    for (int i = 0; i < 8; ++i) {
+        version |= static_cast<uint64_t>(static_cast<uint8_t>(record.value[i])) << (i * 8);
+    }
+    value = record.value.substr(8);
+    return true;
+}
+
 uint64_t WAL::LogBeginTxn(uint64_t txn_id) {
     WALRecord record;
     record.type = RecordType::BEGIN_TXN;
@@ -112,24 +213,80 @@ uint64_t WAL::LogCheckpoint() {
     return WriteRecord(record);
 }
 
+WAL::Stripe& WAL::LocalStripe() {
+    thread_local const size_t index =
+        std::hash<std::thread::id>{}(std::this_thread::get_id()) % LOG_STRIPES;
+    return stripes_[index];
+}
+
 uint64_t WAL::WriteRecord(const WALRecord& record_in) {
     WALRecord record = record_in;
-    record.lsn = ++current_lsn_;
+    Stripe& stripe = LocalStripe();
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    
+    // Taken under the stripe lock so a flush never misses an LSN
+    record.lsn = current_lsn_.fetch_add(1, std::memory_order_acq_rel) + 1;
     record.checksum = ComputeChecksum(record);
     
-    std::vector<char> buffer;
+    thread_local std::vector<char> buffer;
     SerializeRecord(record, buffer);
     
-    // Append to log
-    log_.seekp(0, std::ios::end);
-    log_.write(buffer.data(), buffer.size());
+    // Append to this thread's buffer
+    stripe.records.emplace_back(record.lsn, stripe.data.size());
+    stripe.data.insert(stripe.data.end(), buffer.begin(), buffer.end());
+    size_.fetch_add(buffer.size(), std::memory_order_relaxed);
     
     return record.lsn;
 }
 
+uint64_t WAL::WriteStripes() {
+    std::array<std::unique_lock<std::mutex>, LOG_STRIPES> locks;
+    for (size_t i = 0; i < LOG_STRIPES; i++) {
+        locks[i] = std::unique_lock<std::mutex>(stripes_[i].mutex);
+    }
+    uint64_t last = current_lsn_.load(std::memory_order_acquire);
+    
+    // (LSN, stripe, record) of every buffered record, in LSN order
+    std::vector<std::tuple<uint64_t, size_t, size_t>> order;
+    for (size_t i = 0; i < LOG_STRIPES; i++) {
+        for (size_t j = 0; j < stripes_[i].records.size(); j++) {
+            order.emplace_back(stripes_[i].records[j].first, i, j);
+        }
+    }
+    if (order.empty()) {
+        return last;
+    }
+    std::sort(order.begin(), order.end());
+    
+    log_.seekp(0, std::ios::end);
+    for (const auto& [lsn, i, j] : order) {
+        const Stripe& stripe = stripes_[i];
+        size_t begin = stripe.records[j].second;
+        size_t end = j + 1 < stripe.records.size() ? stripe.records[j + 1].second
+                                                   : stripe.data.size();
+        log_.write(stripe.data.data() + begin, end - begin);
+    }
+    for (auto& stripe : stripes_) {
+        stripe.data.clear();
+        stripe.records.clear();
+    }
+    return last;
+}
+
 void WAL::Flush() {
+    std::lock_guard<std::mutex> lock(file_mutex_);
     if (log_.is_open()) {
+        uint64_t last = WriteStripes();
         log_.flush();
+        if (last > flushed_lsn_.load(std::memory_order_relaxed)) {
+            flushed_lsn_.store(last, std::memory_order_release);
+        }
+    }
+}
+
+void WAL::FlushTo(uint64_t lsn) {
+    if (lsn > flushed_lsn_) {
+        Flush();
     }
 }
 
@@ -156,6 +313,16 @@ uint32_t WAL::ComputeChecksum(const WALRecord& record) {
 void WAL::SerializeRecord(const WALRecord& record, std::vector<char>& buffer) {
     // Record format:
     // [type:1] [lsn:8] [txn_id:8] [page_id:4] [key_len:2] [key:N] [val_len:2] [val:M] [checksum:4]
+    // with [val_len:2] = LONG_VALUE followed by [val_len:4] for values of 64 KB or more
+    
+    if (record.key.size() > UINT16_MAX) {
+        throw std::runtime_error("WAL record key too long: " + std::to_string(record.key.size()) +
+                                 " bytes");
+    }
+    if (record.value.size() > UINT32_MAX) {
+        throw std::runtime_error("WAL record value too long: " +
+                                 std::to_string(record.value.size()) + " bytes");
+    }
     
     buffer.clear();
     
@@ -185,9 +352,17 @@ void WAL::SerializeRecord(const WALRecord& record, std::vector<char>& buffer) {
     buffer.insert(buffer.end(), record.key.begin(), record.key.end());
     
     // Value length and data
-    uint16_t val_len = record.value.size();
-    buffer.push_back(val_len & 0xFF);
-    buffer.push_back((val_len >> 8) & 0xFF);
+    uint32_t val_len = record.value.size();
+    if (val_len < LONG_VALUE) {
+        buffer.push_back(val_len & 0xFF);
+        buffer.push_back((val_len >> 8) & 0xFF);
+    } else {
+        buffer.push_back(LONG_VALUE & 0xFF);
+        buffer.push_back((LONG_VALUE >> 8) & 0xFF);
+        for (int i = 0; i < 4; ++i) {
+            buffer.push_back((val_len >> (i * 8)) & 0xFF);
+        }
+    }
     buffer.insert(buffer.end(), record.value.begin(), record.value.end());
     
     // Checksum
@@ -197,7 +372,7 @@ void WAL::SerializeRecord(const WALRecord& record, std::vector<char>& buffer) {
 }
 
 bool WAL::DeserializeRecord(const std::vector<char>& buffer, WALRecord& record) {
-    if (buffer.size() < 27) {  // Minimum record size
+    if (buffer.size() < 29) {  // Minimum record size (empty key and value)
         return false;
     }
     
@@ -237,10 +412,23 @@ bool WAL::DeserializeRecord(const std::vector<char>& buffer, WALRecord& record)
     offset += key_len;
     
     // Value
-    uint16_t val_len = static_cast<uint8_t>(buffer[offset]) | 
+    if (offset + 2 > buffer.size()) {
+        return false;
+    }
+    uint32_t val_len = static_cast<uint8_t>(buffer[offset]) | 
                       (static_cast<uint8_t>(buffer[offset + 1]) << 8);
     offset += 2;
     
+    if (val_len == LONG_VALUE) {
+        if (offset + 4 > buffer.size()) {
+            return false;
+        }
+        val_len = 0;
+        for (int i = 0; i < 4; ++i) {
+            val_len |= (static_cast<uint32_t>(static_cast<uint8_t>(buffer[offset++])) << (i * 8));
+        }
+    }
+    
     if (offset + val_len + 4 > buffer.size()) {
         return false;
     }
@@ -264,18 +452,27 @@ bool WAL::DeserializeRecord(const std::vector<char>& buffer, WALRecord& record)
 }
 
 std::vector<WAL::WALRecord> WAL::ReadLog() {
+    uint64_t offset = 0;
+    return ReadLog(offset);
+}
+
+std::vector<WAL::WALRecord> WAL::ReadLog(uint64_t& offset, uint64_t max_lsn) {
+    std::lock_guard<std::mutex> lock(file_mutex_);
     std::vector<WALRecord> records;
+    
+    // Buffered records are part of the log too
+    WriteStripes();
 
     // Reset stream state before reading (important after writes/eof)
     log_.clear();
-    log_.seekg(0, std::ios::beg);
+    log_.seekg(offset, std::ios::beg);
     
     while (log_.good() && !log_.eof()) {
-        // Read record size (we need to read header first to determine size)
-        char header[27];  // Minimum header size
-        log_.read(header, 27);
+        // Read fixed header: [type:1] [lsn:8] [txn_id:8] [page_id:4] [key_len:2]
+        char header[23];
+        log_.read(header, 23);
         
-        if (log_.gcount() < 27) {
+        if (log_.gcount() < 23) {
             break;  // End of file or incomplete record
         }
         
@@ -291,16 +488,28 @@ std::vector<WAL::WALRecord> WAL::ReadLog() {
             break;
         }
         
-        // Read value length
-        char val_len_bytes[2];
+        // Read value length (two bytes, or LONG_VALUE and four more)
+        char val_len_bytes[6];
+        size_t val_len_size = 2;
         log_.read(val_len_bytes, 2);
         
         if (log_.gcount() < 2) {
             break;
         }
         
-        uint16_t val_len = static_cast<uint8_t>(val_len_bytes[0]) | 
+        uint32_t val_len = static_cast<uint8_t>(val_len_bytes[0]) | 
                           (static_cast<uint8_t>(val_len_bytes[1]) << 8);
+        if (val_len == LONG_VALUE) {
+            log_.read(val_len_bytes + 2, 4);
+            if (log_.gcount() < 4) {
+                break;
+            }
+            val_len_size = 6;
+            val_len = 0;
+            for (int i = 0; i < 4; ++i) {
+                val_len |= (static_cast<uint32_t>(static_cast<uint8_t>(val_len_bytes[2 + i])) << (i * 8));
+            }
+        }
         
         // Read value
         std::vector<char> val_buf(val_len);
@@ -320,34 +529,71 @@ std::vector<WAL::WALRecord> WAL::ReadLog() {
         
         // Reconstruct full buffer
         std::vector<char> full_buffer;
-        full_buffer.insert(full_buffer.end(), header, header + 27);
+        full_buffer.insert(full_buffer.end(), header, header + 23);
         full_buffer.insert(full_buffer.end(), key_buf.begin(), key_buf.end());
-        full_buffer.insert(full_buffer.end(), val_len_bytes, val_len_bytes + 2);
+        full_buffer.insert(full_buffer.end(), val_len_bytes, val_len_bytes + val_len_size);
         full_buffer.insert(full_buffer.end(), val_buf.begin(), val_buf.end());
         full_buffer.insert(full_buffer.end(), checksum_bytes, checksum_bytes + 4);
         
         WALRecord record;
         if (DeserializeRecord(full_buffer, record)) {
+            if (record.lsn > max_lsn) {
+                break;  // Left for a later call
+            }
             records.push_back(record);
+            offset += full_buffer.size();
         } else {
             // Corrupted record, stop reading
             break;
         }
     }
     
+    // Reading stops at EOF; clear eof/fail so later appends are not dropped
+    log_.clear();
+    
     return records;
 }
 
-void WAL::Truncate() {
-    log_.close();
+void WAL::Truncate(uint64_t keep_from_lsn) {
+    std::vector<WALRecord> kept;
+    if (keep_from_lsn != UINT64_MAX) {
+        for (auto& record : ReadLog()) {
+            if (record.lsn >= keep_from_lsn && record.type != RecordType::CHECKPOINT) {
+                kept.push_back(std::move(record));
+            }
+        }
+    }
     
-    // Truncate file
-    std::ofstream truncate(wal_file_, std::ios::trunc | std::ios::binary);
-    truncate.close();
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        for (auto& stripe : stripes_) {
+            std::lock_guard<std::mutex> stripe_lock(stripe.mutex);
+            stripe.data.clear();
+            stripe.records.clear();
+        }
+        log_.close();
+        
+        // Truncate file
+        std::ofstream truncate(wal_file_, std::ios::trunc | std::ios::binary);
+        truncate.close();
+        
+        // Reopen
+        log_.open(wal_file_, std::ios::in | std::ios::out | std::ios::binary);
+        size_ = 0;
+        
+        // Retained records keep their LSNs and checksums
+        std::vector<char> buffer;
+        for (const auto& record : kept) {
+            SerializeRecord(record, buffer);
+            log_.write(buffer.data(), buffer.size());
+            size_ += buffer.size();
+        }
+    }
     
-    // Reopen
-    log_.open(wal_file_, std::ios::in | std::ios::out | std::ios::binary);
-    current_lsn_ = 0;
+    // Re-seed the empty log with a checkpoint so the LSN sequence
+    // survives a reopen (the constructor restores it from the last record)
+    LogCheckpoint();
+    Flush();
 }
 
 } // namespace toydb
@@ -2,6 +2,8 @@
 ToyDB - A minimal but functional database engine
 """
 
+import time
+
 from ._storage_engine import StorageEngine, IndexedStorageEngine, TransactionalStorageEngine
 from .parser import parse_sql
 from .executor import Executor
@@ -88,9 +90,21 @@ class IndexedDatabase:
         db.close()
     """
     
-    def __init__(self, db_file: str):
+    def __init__(self, db_file: str, value_log_threshold: int = 0,
+                 value_log_segment_size: int = 0):
+        """
+        Args:
+            db_file: Database file path
+            value_log_threshold: Values longer than this many bytes are
+                kept in an append-only value log (db_file.vlog.<n>) and
+                leaves store a pointer; 0 keeps all values in the leaves
+            value_log_segment_size: Bytes after which the value log starts
+                a new segment (only sealed segments are collected);
+                0 uses the default of 4 MB
+        """
         self.db_file = db_file
-        self.engine = IndexedStorageEngine(db_file)
+        self.engine = IndexedStorageEngine(db_file, value_log_threshold,
+                                           value_log_segment_size)
     
     def insert(self, key: str, value: str):
         """Insert a key-value pair"""
@@ -100,10 +114,48 @@ class IndexedDatabase:
         """Get value by key"""
         return self.engine.get(key)
 
+    def get_with_version(self, key: str) -> tuple:
+        """Get (value, version) by key"""
+        return self.engine.get_with_version(key)
+
+    def put_if_absent(self, key: str, value: str) -> bool:
+        """Insert only if key does not exist. Returns True if written."""
+        return self.engine.put_if_absent(key, value)
+
+    def put_if_version(self, key: str, value: str, expected_version: int) -> bool:
+        """Overwrite only if the entry is still at expected_version"""
+        return self.engine.put_if_version(key, value, expected_version)
+
+    def delete_if(self, key: str, expected_version: int) -> bool:
+        """Delete only if the entry is still at expected_version"""
+        return self.engine.delete_if(key, expected_version)
+
+    def merge(self, key: str, operand: str, op: str = "add") -> str:
+        """
+        Read-modify-write in one call using a merge operator
+        
+        Built-in operators: "add" (integer add), "max" (integer max),
+        "append" (comma-separated append). Returns the new value.
+        """
+        return self.engine.merge(key, operand, op)
+
+    def register_merge_operator(self, name: str, fn):
+        """Register fn(existing: Optional[str], operand: str) -> str as a merge operator"""
+        self.engine.register_merge_operator(name, fn)
+
     def delete(self, key: str):
         """Delete a key-value pair"""
         self.engine.delete(key)
     
+    def delete_range(self, start_key: str, end_key: str):
+        """
+        Delete all keys in range [start_key, end_key]
+        
+        Subtrees fully inside the range are dropped as a whole and their
+        pages reused, so this is much cheaper than deleting key by key.
+        """
+        self.engine.delete_range(start_key, end_key)
+    
     def range_scan(self, start_key: str, end_key: str) -> list:
         """
         Get all key-value pairs in range [start_key, end_key]
@@ -113,10 +165,36 @@ class IndexedDatabase:
         """
         return self.engine.range_scan(start_key, end_key)
     
+    def multi_range_scan(self, ranges: list) -> list:
+        """
+        Get all key-value pairs in any of the [start_key, end_key] ranges
+        
+        One cursor walks the tree forward: a range starting on the leaf
+        where the previous one ended is read from that leaf, so an IN-list
+        of nearby keys costs far less than one range_scan per value.
+        
+        Returns:
+            List of (key, value) tuples sorted by key, without duplicates
+        """
+        return self.engine.multi_range_scan(ranges)
+    
     def flush(self):
         """Flush all changes to disk"""
         self.engine.flush()
     
+    def collect_value_log(self, max_live_ratio: float = 0.5) -> int:
+        """
+        Garbage-collect the value log
+        
+        Sealed segments whose live bytes are at most max_live_ratio of
+        their size are rewritten: live values move to the active segment
+        and the old file is deleted.
+        
+        Returns:
+            Number of bytes reclaimed
+        """
+        return self.engine.collect_value_log(max_live_ratio)
+    
     def close(self):
         """Close database and flush changes"""
         self.flush()
@@ -124,7 +202,9 @@ class IndexedDatabase:
     def get_stats(self) -> dict:
         """Get database statistics"""
         return {
-            "cache_hit_rate": self.engine.get_cache_hit_rate()
+            "cache_hit_rate": self.engine.get_cache_hit_rate(),
+            "value_log_bytes": self.engine.get_value_log_size(),
+            "epoch_pending_frames": self.engine.get_epoch_pending()
         }
     
     def __enter__(self):
@@ -156,28 +236,97 @@ class TransactionalDatabase:
         db.insert_txn(txn, "key3", "value3")
         db.commit_transaction(txn)
         
+        # Partial rollback
+        txn = db.begin_transaction()
+        sp = db.savepoint(txn)
+        db.insert_txn(txn, "key4", "bad")
+        db.rollback_to(txn, sp)
+        db.commit_transaction(txn)
+        
+        # Read-only transaction (no WAL records, no flush on commit)
+        txn = db.begin_transaction(read_only=True)
+        db.get("key2")
+        db.commit_transaction(txn)
+        
+        # Counter update without a read round trip
+        db.merge("visits", "1", "add")
+        
         # Checkpoint (truncate WAL)
         db.checkpoint()
         
         db.close()
     """
     
-    def __init__(self, db_file: str):
+    def __init__(self, db_file: str, merge_operators: dict = None,
+                 value_log_threshold: int = 0):
+        """
+        Args:
+            db_file: Database file path
+            merge_operators: User-defined merge operators {name: fn} that
+                must be available while replaying the WAL
+            value_log_threshold: Values longer than this many bytes go to
+                the value log; 0 keeps all values in the leaves
+        """
         self.db_file = db_file
-        self.engine = TransactionalStorageEngine(db_file)
+        if value_log_threshold:
+            self.engine = TransactionalStorageEngine(db_file, merge_operators or {},
+                                                     value_log_threshold)
+        elif merge_operators:
+            self.engine = TransactionalStorageEngine(db_file, merge_operators)
+        else:
+            self.engine = TransactionalStorageEngine(db_file)
+    
+    def begin_transaction(self, read_only: bool = False, isolation: str = "") -> int:
+        """
+        Start a new transaction, returns transaction ID
+        
+        A read_only transaction writes nothing to the WAL on begin or
+        commit and rejects writes. It always reads a consistent snapshot
+        ("" isolation is promoted to "snapshot").
+        
+        isolation:
+            ""             get_txn / range_scan_txn read the latest state
+            "snapshot"     reads see what was committed at begin; writing a
+                           key another transaction changed meanwhile fails
+            "serializable" snapshot reads plus rw-antidependency tracking;
+                           a transaction that could cause write skew fails
+                           with "Serialization failure" and is aborted
+        """
+        return self.engine.begin_transaction(read_only, isolation)
     
-    def begin_transaction(self) -> int:
-        """Start a new transaction, returns transaction ID"""
-        return self.engine.begin_transaction()
+    def commit_transaction(self, txn_id: int, wait_durable: bool = True) -> int:
+        """
+        Commit a transaction, returns its commit LSN
+        
+        The transaction's keys are released as soon as its commit record
+        is logged. With wait_durable=False the call returns before the
+        log is flushed, so commits can be pipelined: pass the LSN to
+        wait_durable() (or make any later synchronous commit) before
+        acknowledging the commit to anyone.
+        """
+        return self.engine.commit_transaction(txn_id, wait_durable)
     
-    def commit_transaction(self, txn_id: int):
-        """Commit a transaction"""
-        self.engine.commit_transaction(txn_id)
+    def wait_durable(self, lsn: int):
+        """Block until the log is on disk up to lsn"""
+        self.engine.wait_durable(lsn)
     
     def abort_transaction(self, txn_id: int):
         """Abort a transaction (rollback)"""
         self.engine.abort_transaction(txn_id)
     
+    def savepoint(self, txn_id: int) -> int:
+        """Mark a savepoint in a transaction, returns it for rollback_to"""
+        return self.engine.savepoint(txn_id)
+    
+    def rollback_to(self, txn_id: int, savepoint: int):
+        """
+        Undo the transaction's writes made after savepoint
+        
+        The transaction stays open and the savepoint can be reused, so a
+        failed item in a batch can be retried without redoing the batch.
+        """
+        self.engine.rollback_to(txn_id, savepoint)
+    
     def insert(self, key: str, value: str):
         """Insert with auto-transaction"""
         self.engine.insert(key, value)
@@ -186,6 +335,56 @@ class TransactionalDatabase:
         """Insert within a transaction"""
         self.engine.insert_txn(txn_id, key, value)
 
+    def get_with_version(self, key: str) -> tuple:
+        """
+        Get (value, version) by key
+        
+        The version is the LSN of the entry's last write; pass it to
+        put_if_version / delete_if for optimistic concurrency.
+        """
+        return self.engine.get_with_version(key)
+
+    def put_if_absent(self, key: str, value: str) -> bool:
+        """Insert only if key does not exist (auto-transaction)"""
+        return self.engine.put_if_absent(key, value)
+
+    def put_if_absent_txn(self, txn_id: int, key: str, value: str) -> bool:
+        """Insert only if key does not exist, within a transaction"""
+        return self.engine.put_if_absent_txn(txn_id, key, value)
+
+    def put_if_version(self, key: str, value: str, expected_version: int) -> bool:
+        """Compare-and-swap: overwrite only if the entry is at expected_version"""
+        return self.engine.put_if_version(key, value, expected_version)
+
+    def put_if_version_txn(self, txn_id: int, key: str, value: str, expected_version: int) -> bool:
+        """Compare-and-swap within a transaction"""
+        return self.engine.put_if_version_txn(txn_id, key, value, expected_version)
+
+    def delete_if(self, key: str, expected_version: int) -> bool:
+        """Delete only if the entry is at expected_version (auto-transaction)"""
+        return self.engine.delete_if(key, expected_version)
+
+    def delete_if_txn(self, txn_id: int, key: str, expected_version: int) -> bool:
+        """Delete only if the entry is at expected_version, within a transaction"""
+        return self.engine.delete_if_txn(txn_id, key, expected_version)
+
+    def merge(self, key: str, operand: str, op: str = "add") -> str:
+        """Merge with auto-transaction (logs only the operand), returns new value"""
+        return self.engine.merge(key, operand, op)
+
+    def merge_txn(self, txn_id: int, key: str, operand: str, op: str = "add") -> str:
+        """Merge within a transaction, returns new value"""
+        return self.engine.merge_txn(txn_id, key, operand, op)
+
+    def register_merge_operator(self, name: str, fn):
+        """
+        Register fn(existing: Optional[str], operand: str) -> str as a merge operator
+        
+        Operators used before a crash must also be passed to the
+        constructor (merge_operators=...) so recovery can replay them.
+        """
+        self.engine.register_merge_operator(name, fn)
+
     def delete(self, key: str):
         """Delete with auto-transaction"""
         self.engine.delete(key)
@@ -194,14 +393,34 @@ class TransactionalDatabase:
         """Delete within a transaction"""
         self.engine.delete_txn(txn_id, key)
     
+    def delete_range(self, start_key: str, end_key: str):
+        """Delete all keys in range [start_key, end_key] with auto-transaction"""
+        self.engine.delete_range(start_key, end_key)
+    
+    def delete_range_txn(self, txn_id: int, start_key: str, end_key: str):
+        """Delete all keys in range [start_key, end_key] within a transaction"""
+        self.engine.delete_range_txn(txn_id, start_key, end_key)
+    
     def get(self, key: str) -> str:
         """Get value by key"""
         return self.engine.get(key)
     
+    def get_txn(self, txn_id: int, key: str) -> str:
+        """Get value by key as seen by a transaction (its snapshot, if any)"""
+        return self.engine.get_txn(txn_id, key)
+    
     def range_scan(self, start_key: str, end_key: str) -> list:
         """Get all key-value pairs in range [start_key, end_key]"""
         return self.engine.range_scan(start_key, end_key)
     
+    def range_scan_txn(self, txn_id: int, start_key: str, end_key: str) -> list:
+        """Get all key-value pairs in range [start_key, end_key] as seen by a transaction"""
+        return self.engine.range_scan_txn(txn_id, start_key, end_key)
+    
+    def multi_range_scan(self, ranges: list) -> list:
+        """Get all key-value pairs in any of the [start_key, end_key] ranges"""
+        return self.engine.multi_range_scan(ranges)
+    
     def checkpoint(self):
         """Create checkpoint and truncate WAL"""
         self.engine.checkpoint()
@@ -210,6 +429,93 @@ class TransactionalDatabase:
         """Flush all changes to disk"""
         self.engine.flush()
     
+    def collect_value_log(self, max_live_ratio: float = 0.5) -> int:
+        """Garbage-collect the value log, returns bytes reclaimed"""
+        return self.engine.collect_value_log(max_live_ratio)
+    
+    def set_checkpoint_policy(self, max_wal_bytes: int = 16 << 20,
+                              max_interval: float = 300.0,
+                              recovery_target_ms: float = 0.0):
+        """
+        Configure automatic checkpoints
+        
+        After a commit, a checkpoint is taken once the WAL has grown by
+        max_wal_bytes since the last one, max_interval seconds have passed
+        with something logged, or replaying the log is estimated to take
+        longer than recovery_target_ms. 0 disables a trigger; the
+        defaults (16MB, 5 minutes) are on from the start. Open
+        transactions do not hold checkpoints back; the WAL keeps their
+        records until they finish.
+        """
+        self.engine.set_checkpoint_policy(max_wal_bytes, max_interval, recovery_target_ms)
+    
+    def changes(self, consumer: str, from_lsn: int = 0,
+                poll_interval: float = 0.1, timeout: float = None):
+        """
+        Stream committed changes (change data capture)
+        
+        Yields one dict per change, in commit order:
+            {"commit_lsn", "lsn", "txn_id", "op", "key", "value"}
+        op is "insert" (an upsert), "update", "delete", "merge" (value is
+        the merged value; extra "operator" and "operand" keys) or
+        "delete_range" (value is the end key). Blocks for new changes; with a timeout,
+        returns once nothing arrived for that many seconds. Commits made
+        with wait_durable=False are streamed once a flush covers them.
+        
+        The consumer is registered by name and resumes after the last
+        transaction it acknowledged; a transaction counts as acknowledged
+        once the next batch is requested, so delivery is at least once.
+        The WAL keeps everything a registered consumer has not
+        acknowledged (drop_change_consumer releases it).
+        
+        Example:
+            for change in db.changes("mirror"):
+                replica[change["key"]] = change["value"]
+        """
+        position = self.engine.register_change_consumer(consumer, from_lsn)
+        acked = position
+        idle_since = time.monotonic()
+        while True:
+            if position > acked:
+                self.engine.ack_changes(consumer, position)
+                acked = position
+            batch = self.engine.read_changes(position, 1000)
+            if not batch:
+                if timeout is not None and time.monotonic() - idle_since >= timeout:
+                    return
+                time.sleep(poll_interval)
+                continue
+            idle_since = time.monotonic()
+            for commit_lsn, lsn, txn_id, op, key, value, merge in batch:
+                change = {"commit_lsn": commit_lsn, "lsn": lsn, "txn_id": txn_id,
+                          "op": op, "key": key, "value": value}
+                if op == "merge":
+                    change["operator"], _, change["operand"] = merge.partition("\0")
+                yield change
+            position = batch[-1][0]
+    
+    def drop_change_consumer(self, consumer: str):
+        """Remove a change consumer so the WAL no longer retains its changes"""
+        self.engine.drop_change_consumer(consumer)
+    
+    def finish_recovery(self):
+        """
+        Redo everything left from crash recovery
+        
+        After a crash the database opens as soon as the log is analyzed;
+        keys are redone when first accessed. This completes the rest.
+        """
+        self.engine.finish_recovery()
+    
+    def collect_versions(self) -> int:
+        """
+        Prune old row versions no running snapshot can read
+        
+        A background sweeper does this continuously; returns the number
+        of versions pruned.
+        """
+        return self.engine.collect_versions()
+    
     def close(self):
         """Close database and flush changes"""
         self.flush()
@@ -218,7 +524,13 @@ class TransactionalDatabase:
         """Get database statistics"""
         return {
             "cache_hit_rate": self.engine.get_cache_hit_rate(),
-            "last_lsn": self.engine.get_last_lsn()
+            "last_lsn": self.engine.get_last_lsn(),
+            "durable_lsn": self.engine.get_durable_lsn(),
+            "recovery_pending_keys": self.engine.get_recovery_pending(),
+            "wal_bytes": self.engine.get_wal_size(),
+            "auto_checkpoints": self.engine.get_auto_checkpoints(),
+            "value_log_bytes": self.engine.get_value_log_size(),
+            **self.engine.get_version_stats()
         }
     
     def __enter__(self):
@@ -258,12 +570,27 @@ class SQLDatabase:
         results = db.execute("SELECT name FROM users ORDER BY age LIMIT 2")
         
         db.close()
+        
+        # Repeated SELECTs served from a 64MB result cache
+        db = SQLDatabase("mydb.dat", result_cache_bytes=64 << 20)
     """
     
-    def __init__(self, db_file: str):
+    def __init__(self, db_file: str, value_log_threshold: int = 0, result_cache_bytes: int = 0):
+        """
+        Args:
+            db_file: Database file path
+            value_log_threshold: Rows longer than this many bytes are kept
+                in the value log; 0 keeps all rows in the leaves
+            result_cache_bytes: Memory budget for caching SELECT results,
+                reused until a write changes a table they read; 0 (the
+                default) disables the cache
+        """
         self.db_file = db_file
-        self.engine = TransactionalStorageEngine(db_file)
-        self.executor = Executor(self.engine)
+        if value_log_threshold:
+            self.engine = TransactionalStorageEngine(db_file, {}, value_log_threshold)
+        else:
+            self.engine = TransactionalStorageEngine(db_file)
+        self.executor = Executor(self.engine, result_cache_bytes)
     
     def execute(self, sql: str):
         """
@@ -275,13 +602,17 @@ class SQLDatabase:
         """
         return self.executor.execute(sql)
     
-    def begin_transaction(self) -> int:
-        """Start a new transaction"""
-        return self.engine.begin_transaction()
+    def begin_transaction(self, read_only: bool = False) -> int:
+        """Start a new transaction (read_only: snapshot reads, no WAL traffic, writes rejected)"""
+        return self.engine.begin_transaction(read_only)
+    
+    def commit_transaction(self, txn_id: int, wait_durable: bool = True) -> int:
+        """Commit a transaction, returns its commit LSN (see TransactionalDatabase)"""
+        return self.engine.commit_transaction(txn_id, wait_durable)
     
-    def commit_transaction(self, txn_id: int):
-        """Commit a transaction"""
-        self.engine.commit_transaction(txn_id)
+    def wait_durable(self, lsn: int):
+        """Block until the log is on disk up to lsn"""
+        self.engine.wait_durable(lsn)
     
     def abort_transaction(self, txn_id: int):
         """Abort a transaction"""
@@ -301,10 +632,13 @@ class SQLDatabase:
     
     def get_stats(self) -> dict:
         """Get database statistics"""
-        return {
+        stats = {
             "cache_hit_rate": self.engine.get_cache_hit_rate(),
             "last_lsn": self.engine.get_last_lsn()
         }
+        if self.executor.result_cache is not None:
+            stats.update(self.executor.result_cache.stats())
+        return stats
     
     def __enter__(self):
         return self
@@ -49,7 +49,15 @@ class CreateIndexStmt(ASTNode):
     """CREATE INDEX statement"""
     index_name: str
     table_name: str
-    column_name: str
+    column_name: str  # Leading column
+    columns: Optional[List[str]] = None  # All key columns, in order
+    include: Optional[List[str]] = None  # INCLUDE (...) payload columns
+    
+    def __post_init__(self):
+        if self.columns is None:
+            self.columns = [self.column_name]
+        if self.include is None:
+            self.include = []
 
 
 @dataclass
@@ -87,6 +95,14 @@ class SelectStmt(ASTNode):
     group_by: Optional[List[str]] = None
     having: Optional['Expr'] = None
     table_alias: Optional[str] = None
+    order_by_columns: Optional[List[str]] = None  # ORDER BY a, b, ... (order_by = first)
+    joins: Optional[List['JoinClause']] = None  # JOIN ... JOIN ... (join = first)
+    
+    def __post_init__(self):
+        if self.order_by_columns is None and self.order_by:
+            self.order_by_columns = [self.order_by]
+        if self.joins is None:
+            self.joins = [self.join] if self.join else []
 
 
 @dataclass
@@ -143,6 +159,13 @@ class BinaryOp(Expr):
     right: Expr
 
 
+@dataclass
+class InList(Expr):
+    """Membership test: expr IN (value1, value2, ...)"""
+    expr: Expr
+    values: List[Any]
+
+
 @dataclass
 class FunctionCall(Expr):
     """Function call (e.g., COUNT(*), SUM(salary))"""
@@ -174,7 +197,7 @@ def ast_to_string(node: ASTNode, indent: int = 0) -> str:
             result += f" WHERE {expr_to_string(node.where)}"
         
         if node.order_by:
-            result += f" ORDER BY {node.order_by}"
+            result += f" ORDER BY {', '.join(node.order_by_columns)}"
         
         if node.limit:
             result += f" LIMIT {node.limit}"
@@ -192,6 +215,9 @@ def ast_to_string(node: ASTNode, indent: int = 0) -> str:
         right = expr_to_string(node.right)
         return f"{prefix}({left} {node.op} {right})"
     
+    elif isinstance(node, InList):
+        return f"{prefix}{expr_to_string(node)}"
+    
     else:
         return f"{prefix}{node}"
 
@@ -206,5 +232,8 @@ def expr_to_string(expr: Expr) -> str:
         left = expr_to_string(expr.left)
         right = expr_to_string(expr.right)
         return f"({left} {expr.op} {right})"
+    elif isinstance(expr, InList):
+        values = ", ".join(repr(v) for v in expr.values)
+        return f"({expr_to_string(expr.expr)} IN ({values}))"
     else:
         return str(expr)
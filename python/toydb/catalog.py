@@ -8,7 +8,7 @@ The catalog stores:
 - Constraints (future)
 """
 
-from typing import List, Optional, Dict
+from typing import List, Optional, Dict, Union
 from .ast_nodes import ColumnDef
 
 
@@ -68,8 +68,8 @@ class Catalog:
         if not self.table_exists(table_name):
             raise RuntimeError(f"Table '{table_name}' does not exist")
         
-        # Note: In a real DB, we'd also delete all rows
-        # For now, we just remove catalog entries
+        # Only catalog entries are removed here; the executor purges
+        # the table's rows with a range delete
         
         # First, get the columns before marking as deleted
         # Scan column entries for this table
@@ -177,26 +177,54 @@ class Catalog:
     # Index Management
     # ============================================================
     
-    def create_index(self, index_name: str, table_name: str, column_name: str):
+    def create_index(self, index_name: str, table_name: str,
+                     column_names: Union[str, List[str]],
+                     include: Optional[List[str]] = None,
+                     building: bool = False):
         """
         Register an index in the catalog
         
+        Args:
+            column_names: Key column, or list of key columns in order
+            include: Extra columns stored in each entry (covering index)
+            building: Register it as being built online (not used by
+                queries until set_index_ready)
+        
         Note: This only registers the index metadata.
         Building the actual index is handled by the executor.
         """
         if not self.table_exists(table_name):
             raise RuntimeError(f"Table '{table_name}' does not exist")
         
-        # Verify column exists
+        if isinstance(column_names, str):
+            column_names = [column_names]
+        include = include or []
+        
+        if self.get_index(index_name) is not None:
+            raise RuntimeError(f"Index '{index_name}' already exists")
+        
+        # Verify columns exist
         columns = self.get_columns(table_name)
-        if column_name not in [col.name for col in columns]:
-            raise RuntimeError(f"Column '{column_name}' does not exist in table '{table_name}'")
+        for column_name in column_names + include:
+            if column_name not in [col.name for col in columns]:
+                raise RuntimeError(f"Column '{column_name}' does not exist in table '{table_name}'")
         
         # Store index metadata
+        # Format: table=users,columns=dept;age[,include=name;salary][,state=building]
         index_key = f"{self.INDEXES_PREFIX}{index_name}"
-        index_value = f"table={table_name},column={column_name}"
+        index_value = f"table={table_name},columns={';'.join(column_names)}"
+        if include:
+            index_value += f",include={';'.join(include)}"
+        if building:
+            index_value += ",state=building"
         self.engine.insert(index_key, index_value)
     
+    def set_index_ready(self, index_name: str):
+        """Mark an index built online as complete (queries may use it)"""
+        index_key = f"{self.INDEXES_PREFIX}{index_name}"
+        value = self.engine.get(index_key)
+        self.engine.insert(index_key, value.replace(",state=building", ""))
+    
     def drop_index(self, index_name: str):
         """Remove an index from the catalog"""
         index_key = f"{self.INDEXES_PREFIX}{index_name}"
@@ -217,7 +245,9 @@ class Catalog:
             table_name: If specified, only return indexes for this table
         
         Returns:
-            List of dicts with 'name', 'table', 'column'
+            List of dicts with 'name', 'table', 'column' (leading column),
+            'columns' (all key columns), 'include' (covering columns) and
+            'building' (online build in progress)
         """
         # Scan all index entries
         start_key = self.INDEXES_PREFIX
@@ -230,28 +260,50 @@ class Catalog:
             if value == "DELETED":
                 continue
             
-            # Parse index metadata
-            # Format: table=users,column=age
-            metadata = {}
-            for part in value.split(","):
-                k, v = part.split("=")
-                metadata[k] = v
+            # Extract index name from key
+            index_name = key[len(self.INDEXES_PREFIX):]
+            index = self._parse_index(index_name, value)
             
             # Filter by table if specified
-            if table_name and metadata["table"] != table_name:
+            if table_name and index["table"] != table_name:
                 continue
             
-            # Extract index name from key
-            index_name = key[len(self.INDEXES_PREFIX):]
-            
-            indexes.append({
-                "name": index_name,
-                "table": metadata["table"],
-                "column": metadata["column"]
-            })
+            indexes.append(index)
         
         return indexes
     
+    def get_index(self, index_name: str) -> Optional[Dict]:
+        """Get a single index definition (None if it does not exist)"""
+        index_key = f"{self.INDEXES_PREFIX}{index_name}"
+        
+        for key, value in self.engine.range_scan(index_key, index_key):
+            if value != "DELETED":
+                return self._parse_index(index_name, value)
+        return None
+    
+    def _parse_index(self, index_name: str, value: str) -> Dict:
+        """
+        Parse index metadata
+        Format: table=users,columns=dept;age[,include=name][,state=building]
+        (older entries: column=age)
+        """
+        metadata = {}
+        for part in value.split(","):
+            k, v = part.split("=")
+            metadata[k] = v
+        
+        columns = metadata.get("columns", metadata.get("column", "")).split(";")
+        include = metadata["include"].split(";") if metadata.get("include") else []
+        
+        return {
+            "name": index_name,
+            "table": metadata["table"],
+            "column": columns[0],
+            "columns": columns,
+            "include": include,
+            "building": metadata.get("state") == "building"
+        }
+    
     # ============================================================
     # Statistics
     # ============================================================
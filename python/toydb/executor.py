@@ -2,12 +2,18 @@
 Query Executor - Execute parsed SQL queries against storage engine
 """
 
-from typing import List, Tuple, Any, Optional, Union, Set
+import itertools
+import threading
+from typing import List, Tuple, Any, Optional, Union, Set, Dict
 from .ast_nodes import *
 from .parser import parse_sql
 from .catalog import Catalog
 from .planner import QueryPlanner, plan_to_string
-from .aggregates import apply_aggregates
+from .aggregates import apply_aggregates, parse_aggregate_function
+from .expressions import RowPredicate, compile_expr
+from .result_cache import ResultCache
+from ._storage_engine import encode_key, hash_join
+from . import indexes
 
 
 class Executor:
@@ -17,16 +23,41 @@ class Executor:
     Executes SQL queries against the storage engine
     """
     
-    def __init__(self, storage_engine):
+    # Side log records left for the final (locked) catch-up of an online build
+    INDEX_CATCHUP_RECORDS = 64
+    
+    # Index entries bulk-loaded per transaction (bounds its undo list)
+    INDEX_LOAD_BATCH = 1024
+    
+    # Merge join groups fetched from the engine per call
+    MERGE_JOIN_BATCH = 1024
+    
+    # Statements that change a table's rows or schema
+    TABLE_WRITES = (InsertStmt, UpdateStmt, DeleteStmt, CreateTableStmt, AlterTableStmt, DropTableStmt)
+    
+    def __init__(self, storage_engine, result_cache_bytes: int = 0):
         """
         Args:
-            storage_engine: TransactionalStorageEngine or IndexedStorageEngine
+            storage_engine: TransactionalStorageEngine
+            result_cache_bytes: Memory budget for cached SELECT results; 0
+                disables the result cache
         """
         self.engine = storage_engine
+        self.result_cache = ResultCache(result_cache_bytes) if result_cache_bytes > 0 else None
         # Persistent catalog for table schemas
         self.catalog = Catalog(storage_engine)
         # Query planner for optimization
         self.planner = QueryPlanner(self.catalog, storage_engine)
+        
+        # Online index builds: writers log changes while an index is building
+        self._index_build_lock = threading.Lock()
+        self._index_log_seq = itertools.count(1)
+        
+        # A build interrupted by a restart cannot resume (its side log
+        # stopped being written): drop it, CREATE INDEX can be re-run
+        for idx in self.catalog.get_indexes():
+            if idx["building"]:
+                self._drop_index_data(idx["name"])
     
     def execute(self, sql: str) -> Optional[Union[List[Tuple], str]]:
         """
@@ -39,28 +70,35 @@ class Executor:
         """
         ast = parse_sql(sql)
         
-        if isinstance(ast, ExplainStmt):
-            return self.execute_explain(ast)
-        elif isinstance(ast, CreateTableStmt):
-            return self.execute_create_table(ast)
-        elif isinstance(ast, DropTableStmt):
-            return self.execute_drop_table(ast)
-        elif isinstance(ast, AlterTableStmt):
-            return self.execute_alter_table(ast)
-        elif isinstance(ast, CreateIndexStmt):
-            return self.execute_create_index(ast)
-        elif isinstance(ast, DropIndexStmt):
-            return self.execute_drop_index(ast)
-        elif isinstance(ast, InsertStmt):
-            return self.execute_insert(ast)
-        elif isinstance(ast, SelectStmt):
-            return self.execute_select(ast)
-        elif isinstance(ast, UpdateStmt):
-            return self.execute_update(ast)
-        elif isinstance(ast, DeleteStmt):
-            return self.execute_delete(ast)
-        else:
-            raise RuntimeError(f"Unsupported statement type: {type(ast)}")
+        try:
+            if isinstance(ast, ExplainStmt):
+                return self.execute_explain(ast)
+            elif isinstance(ast, CreateTableStmt):
+                return self.execute_create_table(ast)
+            elif isinstance(ast, DropTableStmt):
+                return self.execute_drop_table(ast)
+            elif isinstance(ast, AlterTableStmt):
+                return self.execute_alter_table(ast)
+            elif isinstance(ast, CreateIndexStmt):
+                return self.execute_create_index(ast)
+            elif isinstance(ast, DropIndexStmt):
+                return self.execute_drop_index(ast)
+            elif isinstance(ast, InsertStmt):
+                return self.execute_insert(ast)
+            elif isinstance(ast, SelectStmt):
+                if self.result_cache is not None:
+                    return self._execute_select_cached(ast)
+                return self.execute_select(ast)
+            elif isinstance(ast, UpdateStmt):
+                return self.execute_update(ast)
+            elif isinstance(ast, DeleteStmt):
+                return self.execute_delete(ast)
+            else:
+                raise RuntimeError(f"Unsupported statement type: {type(ast)}")
+        finally:
+            # A finished write makes cached results that read its table stale
+            if self.result_cache is not None and isinstance(ast, self.TABLE_WRITES):
+                self.result_cache.bump(ast.table_name)
     
     # ============================================================
     # DDL Execution
@@ -73,6 +111,12 @@ class Executor:
     def execute_drop_table(self, stmt: DropTableStmt) -> None:
         """Execute DROP TABLE"""
         self.catalog.drop_table(stmt.table_name)
+        
+        for idx in self.catalog.get_indexes(stmt.table_name):
+            self._drop_index_data(idx["name"])
+        
+        # Purge all rows with a single range delete
+        self.engine.delete_range(f"{stmt.table_name}:", f"{stmt.table_name}:~")
     
     def execute_alter_table(self, stmt: AlterTableStmt) -> None:
         """Execute ALTER TABLE ADD COLUMN"""
@@ -82,12 +126,96 @@ class Executor:
             raise RuntimeError(f"Unsupported ALTER TABLE action: {stmt.action}")
     
     def execute_create_index(self, stmt: CreateIndexStmt) -> None:
-        """Execute CREATE INDEX"""
-        self.catalog.create_index(stmt.index_name, stmt.table_name, stmt.column_name)
+        """
+        Execute CREATE INDEX as an online build (writers are not blocked)
+        
+        1. Register the index as building: from now on writers append
+           their changes to its side log instead of touching entries
+        2. Bulk-load entries from a snapshot scan of the table, in key order
+        3. Replay the side log while writers keep going
+        4. Under the build lock, replay what is left and mark the index
+           ready; only then do queries use it
+        
+        Replay is idempotent (adding an indexed row or removing a missing
+        one is a no-op), so changes the snapshot already saw are harmless.
+        """
+        self.catalog.create_index(stmt.index_name, stmt.table_name, stmt.columns,
+                                  stmt.include, building=True)
+        idx = self.catalog.get_index(stmt.index_name)
+        
+        self._bulk_load_index(idx)
+        
+        while self._replay_index_log(idx) > self.INDEX_CATCHUP_RECORDS:
+            pass
+        
+        with self._index_build_lock:
+            self._replay_index_log(idx)
+            self.catalog.set_index_ready(idx["name"])
+    
+    def _bulk_load_index(self, idx: Dict):
+        """Build entries for a snapshot of the table, inserted in key order"""
+        columns = self.catalog.get_columns(idx["table"])
+        start_key = f"{idx['table']}:"
+        end_key = f"{idx['table']}:~"
+        
+        postings = {}
+        entries = []
+        for key, value in self.engine.range_scan(start_key, end_key):
+            if value == "DELETED":
+                continue
+            row = self._parse_row(value, columns)
+            values = [row.get(col) for col in idx["columns"]]
+            if indexes.uses_postings(idx):
+                postings.setdefault(tuple(values), []).append(indexes.row_id_of(key))
+            else:
+                include_values = [row.get(col) for col in idx["include"]]
+                entries.append((indexes.entry_key(idx["name"], values, key),
+                                indexes.entry_value(key, include_values)))
+        
+        # Posting lists are written whole, already chunked
+        for values, row_ids in postings.items():
+            entries.extend(indexes.posting_entries(idx["name"], list(values), row_ids))
+        
+        # In key order, so consecutive inserts reuse the same leaves;
+        # one commit (and log flush) per batch rather than per entry
+        entries.sort()
+        for start in range(0, len(entries), self.INDEX_LOAD_BATCH):
+            txn_id = self.engine.begin_transaction()
+            try:
+                for entry_key, entry_value in entries[start:start + self.INDEX_LOAD_BATCH]:
+                    self.engine.insert_txn(txn_id, entry_key, entry_value)
+            except Exception:
+                self.engine.abort_transaction(txn_id)
+                raise
+            self.engine.commit_transaction(txn_id)
+    
+    def _replay_index_log(self, idx: Dict) -> int:
+        """Apply and remove the side log of a building index, returns records applied"""
+        start_key, end_key = indexes.build_log_range(idx["name"])
+        records = self.engine.range_scan(start_key, end_key)
+        
+        for _, value in records:
+            added, row_key, values = indexes.decode_log_record(value)
+            row = dict(zip(idx["columns"] + idx["include"], values))
+            if added:
+                self._apply_index_add(idx, row, row_key)
+            else:
+                self._apply_index_remove(idx, row, row_key)
+        
+        # Writers only append after the last applied record
+        if records:
+            self.engine.delete_range(start_key, records[-1][0])
+        return len(records)
     
     def execute_drop_index(self, stmt: DropIndexStmt) -> None:
-        """Execute DROP INDEX"""
-        self.catalog.drop_index(stmt.index_name)
+        """Execute DROP INDEX (removes the metadata and all entries)"""
+        self._drop_index_data(stmt.index_name)
+    
+    def _drop_index_data(self, index_name: str):
+        """Remove an index from the catalog with its entries and side log"""
+        self.catalog.drop_index(index_name)
+        self.engine.delete_range(*indexes.index_range(index_name))
+        self.engine.delete_range(*indexes.build_log_range(index_name))
     
     def execute_explain(self, stmt: ExplainStmt) -> str:
         """
@@ -146,6 +274,13 @@ class Executor:
         key = f"{stmt.table_name}:{row_id:020d}"
         self.engine.insert(key, row_data)
         
+        # Maintain secondary indexes
+        table_indexes = self.catalog.get_indexes(stmt.table_name)
+        if table_indexes:
+            row = self._parse_row(row_data, columns)
+            for idx in table_indexes:
+                self._add_index_entry(idx, row, key)
+        
         # Update statistics (row count)
         stats = self.catalog.get_stats(stmt.table_name)
         current_rows = stats.get("rows", 0)
@@ -162,31 +297,50 @@ class Executor:
         end_key = f"{stmt.table_name}:~"
         all_rows = self.engine.range_scan(start_key, end_key)
         
-        updated_count = 0
-        
+        # Parse rows
+        parsed = []
         for key, value in all_rows:
-            # Parse row
             values = value.split("|")
             row = {}
             for i, col in enumerate(columns):
                 if i < len(values):
                     row[col.name] = self._cast_value(values[i], col.type)
+            parsed.append((key, value, row))
+        
+        # Check WHERE condition (one batch)
+        if stmt.where is not None:
+            where = RowPredicate(stmt.where, self._column_types(stmt.table_name, columns))
+            parsed = [parsed[i] for i in where.matching([row for _, _, row in parsed])]
+        
+        updated_count = 0
+        
+        for key, value, row in parsed:
+            # Update the row
+            for col_name, new_value in stmt.assignments.items():
+                if col_name in row:
+                    row[col_name] = new_value
             
-            # Check WHERE condition
-            if stmt.where is None or self._evaluate_expr(stmt.where, row):
-                # Update the row
-                for col_name, new_value in stmt.assignments.items():
-                    if col_name in row:
-                        row[col_name] = new_value
-                
-                # Serialize updated row
-                new_values = []
-                for col in columns:
-                    new_values.append(str(row.get(col.name, "")))
-                
-                new_row_data = "|".join(new_values)
-                self.engine.insert(key, new_row_data)
-                updated_count += 1
+            # Serialize updated row
+            new_values = []
+            for col in columns:
+                new_values.append(str(row.get(col.name, "")))
+            
+            new_row_data = "|".join(new_values)
+            self.engine.insert(key, new_row_data)
+            updated_count += 1
+            
+            # Re-index rows whose key or included columns changed.
+            # Indexes are looked up after the write so an online build
+            # either sees the new row in its snapshot or gets this change.
+            table_indexes = self.catalog.get_indexes(stmt.table_name)
+            if table_indexes:
+                old_row = self._parse_row(value, columns)
+                new_row = self._parse_row(new_row_data, columns)
+                for idx in table_indexes:
+                    indexed = idx["columns"] + idx["include"]
+                    if any(old_row.get(col) != new_row.get(col) for col in indexed):
+                        self._remove_index_entry(idx, old_row, key)
+                        self._add_index_entry(idx, new_row, key)
         
         print(f"Updated {updated_count} row(s)")
     
@@ -200,24 +354,36 @@ class Executor:
         end_key = f"{stmt.table_name}:~"
         all_rows = self.engine.range_scan(start_key, end_key)
         
-        # Collect keys to delete
-        keys_to_delete = []
-        
+        # Parse rows
+        parsed = []
         for key, value in all_rows:
-            # Parse row
+            if value == "DELETED":
+                continue
+            
             values = value.split("|")
             row = {}
             for i, col in enumerate(columns):
                 if i < len(values):
                     row[col.name] = self._cast_value(values[i], col.type)
-            
-            # Check WHERE condition
-            if stmt.where is None or self._evaluate_expr(stmt.where, row):
-                keys_to_delete.append(key)
+            parsed.append((key, value, row))
         
-        # Mark as deleted (we still don't have physical DELETE)
-        for key in keys_to_delete:
+        # Check WHERE condition (one batch)
+        if stmt.where is not None:
+            where = RowPredicate(stmt.where, self._column_types(stmt.table_name, columns))
+            parsed = [parsed[i] for i in where.matching([row for _, _, row in parsed])]
+        
+        # Collect keys to delete
+        keys_to_delete = []
+        
+        for key, value, row in parsed:
+            keys_to_delete.append(key)
+            
+            # Mark as deleted (we still don't have physical DELETE)
             self.engine.insert(key, "DELETED")
+            
+            # Drop index entries (looked up after the write, as in UPDATE)
+            for idx in self.catalog.get_indexes(stmt.table_name):
+                self._remove_index_entry(idx, self._parse_row(value, columns), key)
         
         # Update statistics
         stats = self.catalog.get_stats(stmt.table_name)
@@ -240,55 +406,53 @@ class Executor:
         """
         # Get table schema from catalog
         columns = self.catalog.get_columns(stmt.table_name)
+        has_aggregates = bool(stmt.group_by) or self._has_aggregates(stmt.columns)
         
-        # Table scan: get all rows
-        start_key = f"{stmt.table_name}:"
-        end_key = f"{stmt.table_name}:~"  # ~ is after all digits
-        
-        all_rows = self.engine.range_scan(start_key, end_key)
+        # Secondary index access when WHERE / ORDER BY match an index
+        access = self.planner.choose_index_access(stmt)
         
-        # Parse rows
-        rows = []
-        for key, value in all_rows:
-            # Skip deleted rows and metadata
-            if value == "DELETED" or key.startswith("__"):
-                continue
-            
-            # Parse row data
-            values = value.split("|")
-            
-            # Create row dict
-            row = {}
-            for i, col in enumerate(columns):
-                if i < len(values):
-                    row[col.name] = self._cast_value(values[i], col.type)
-                else:
-                    row[col.name] = None
+        if access:
+            rows = self._index_scan(stmt, access, columns, has_aggregates)
+        else:
+            if stmt.joins:
+                # Join plan (order and methods) from the planner
+                rows = self._execute_join(stmt)
+            else:
+                # Table scan: get all rows
+                rows = self._scan_table(stmt.table_name, columns)
             
-            rows.append(row)
-        
-        # Handle JOIN if present
-        if stmt.join:
-            rows = self._execute_join(rows, stmt, columns)
-        
-        # Filter by WHERE clause
-        if stmt.where:
-            rows = [r for r in rows if self._evaluate_expr(stmt.where, r)]
+            # Filter by WHERE clause
+            if stmt.where:
+                types = self._column_types(stmt.table_name, columns, stmt.table_alias)
+                for join in stmt.joins:
+                    join_cols = self.catalog.get_columns(join.table_name)
+                    types.update(self._column_types(join.table_name, join_cols, join.alias))
+                rows = RowPredicate(stmt.where, types).filter(rows)
         
         # Handle aggregates and GROUP BY
-        if stmt.group_by or self._has_aggregates(stmt.columns):
-            result = apply_aggregates(rows, stmt.columns, stmt.group_by)
+        if has_aggregates:
+            # HAVING may read aggregates / columns that are not selected:
+            # compute them as extra output columns, dropped afterwards
+            output = list(stmt.columns)
+            having = RowPredicate(stmt.having) if stmt.having else None
+            if having:
+                selected = [self._output_name(col) for col in output]
+                output += [col for col in having.columns if col not in selected]
+            
+            result = apply_aggregates(rows, output, stmt.group_by)
             
             # Apply HAVING filter (after grouping)
-            if stmt.having:
-                # HAVING filter on aggregated results
-                # For simplicity, we skip this for now
-                pass
+            if having:
+                names = [self._output_name(col) for col in output]
+                groups = [dict(zip(names, values)) for values in result]
+                result = [result[i][:len(stmt.columns)] for i in having.matching(groups)]
         else:
             # No aggregates - regular projection
-            # Order by
-            if stmt.order_by:
-                rows.sort(key=lambda r: self._resolve_column_value(stmt.order_by, r))
+            # Order by (index scans may already return rows in order)
+            if stmt.order_by and not (access and access.provides_order):
+                rows.sort(key=lambda r: tuple(
+                    self._resolve_column_value(col, r) for col in stmt.order_by_columns
+                ))
             
             # Limit
             if stmt.limit:
@@ -308,6 +472,68 @@ class Executor:
         
         return result
     
+    def _execute_select_cached(self, stmt: SelectStmt) -> List[Tuple]:
+        """SELECT answered from the result cache while the tables it reads are unchanged"""
+        key = ResultCache.key(stmt)
+        rows = self.result_cache.get(key)
+        if rows is None:
+            # Versions taken before reading: a concurrent write makes the entry stale
+            tables = [stmt.table_name] + [join.table_name for join in stmt.joins]
+            tags = self.result_cache.versions(tables)
+            rows = self.execute_select(stmt)
+            self.result_cache.put(key, tags, rows)
+        return rows
+    
+    def _index_scan(self, stmt: SelectStmt, access, columns: List, has_aggregates: bool) -> List[Dict]:
+        """
+        Read rows through a secondary index, in index order
+        
+        Index entries (posting lists or per-row entries) give row keys;
+        each row is fetched and checked against the full WHERE clause (the
+        key range may be wider). For a covering access the row is rebuilt
+        from the entry alone.
+        """
+        # IN-lists and OR-ed ranges scan several key ranges in one pass
+        key_ranges = access.key_ranges()
+        if len(key_ranges) == 1:
+            entries = self.engine.range_scan(*key_ranges[0])
+        else:
+            entries = self.engine.multi_range_scan(key_ranges)
+        
+        # Stop early once LIMIT rows are found in their final order
+        can_stop = bool(stmt.limit) and not has_aggregates and \
+            (access.provides_order or not stmt.order_by)
+        
+        idx = access.index
+        where = RowPredicate(stmt.where, self._column_types(stmt.table_name, columns)) \
+            if stmt.where else None
+        
+        rows = []
+        for entry_key, entry_value in entries:
+            for row_key, key_values, include_values in indexes.scan_entry(idx, entry_key, entry_value):
+                if access.covering:
+                    # Index-only: key columns + INCLUDE columns hold everything read
+                    row = dict(zip(idx["columns"], key_values))
+                    row.update(zip(idx["include"], include_values))
+                else:
+                    value = self.engine.get(row_key)
+                    if value == "DELETED":
+                        continue
+                    row = self._parse_row(value, columns)
+                
+                if not can_stop:
+                    rows.append(row)  # WHERE checked for all rows at once
+                    continue
+                
+                if where and not where.matches(row):
+                    continue
+                
+                rows.append(row)
+                if len(rows) >= stmt.limit:
+                    return rows
+        
+        return where.filter(rows) if where and not can_stop else rows
+    
     def _has_aggregates(self, columns: List[str]) -> bool:
         """Check if any column is an aggregate function"""
         for col in columns:
@@ -315,179 +541,264 @@ class Executor:
                 return True
         return False
     
-    def _execute_join(self, left_rows: List[Dict], stmt: SelectStmt, left_cols: List) -> List[Dict]:
-        """Execute JOIN operation"""
-        join = stmt.join
-        left_table = stmt.table_name
-        left_ref = stmt.table_alias or left_table
-        right_table = join.table_name
-        right_ref = join.alias or right_table
-        
-        # Get right table schema
-        right_cols = self.catalog.get_columns(right_table)
-        
-        # Scan right table
-        start_key = f"{right_table}:"
-        end_key = f"{right_table}:~"
-        right_data = self.engine.range_scan(start_key, end_key)
-        
-        # Parse right rows
-        right_rows = []
-        for key, value in right_data:
+    def _scan_table(self, table: str, columns: List) -> List[Dict]:
+        """All live rows of a table, parsed"""
+        start_key = f"{table}:"
+        end_key = f"{table}:~"  # ~ is after all digits
+        
+        rows = []
+        for key, value in self.engine.range_scan(start_key, end_key):
+            # Skip deleted rows and metadata
             if value == "DELETED" or key.startswith("__"):
                 continue
-            
-            values = value.split("|")
-            row = {}
-            for i, col in enumerate(right_cols):
-                if i < len(values):
-                    row[col.name] = self._cast_value(values[i], col.type)
-            right_rows.append(row)
+            rows.append(self._parse_row(value, columns))
+        return rows
+    
+    def _execute_join(self, stmt: SelectStmt) -> List[Dict]:
+        """
+        Execute the JOINs of a query with the plan chosen by the planner
+        (nested loops in written order when it has none)
         
-        # Perform JOIN (nested loop join)
-        result = []
+        While joining, a row is a tuple holding one tuple of column values
+        per relation, in the order of the plan step's layout; ON conditions
+        are compiled over those values laid end to end.
+        """
+        relations = self.planner.join_relations(stmt)
+        plan = self.planner.choose_join(stmt) or self.planner.written_order_join(stmt)
+        names = [[col.name for col in rel.columns] for rel in relations]
+        
+        rows = self._run_join_step(plan, relations, names)
         
+        # Back to row dicts, relations in written order
+        order = [plan.layout.index(i) for i in range(len(relations))]
+        return [self._combine_join_rows([dict(zip(names[i], row[pos])) for i, pos in enumerate(order)],
+                                        relations)
+                for row in rows]
+    
+    def _run_join_step(self, step, relations: List, names: List[List[str]]) -> List[Tuple]:
+        """Rows produced by a join plan step (see _execute_join)"""
+        if step.method is None:
+            rel = next(iter(step.relations))
+            rows = self._scan_table(relations[rel].table, relations[rel].columns)
+            return [(values,) for values in self._filter_leaf(step, relations, names, rows)]
+        
+        if step.method == "merge":
+            return self._merge_join(step, relations, names)
+        
+        left_rows = self._run_join_step(step.left, relations, names)
+        if step.method == "index_nested_loop":
+            return self._index_nested_loop_join(step, relations, names, left_rows)
+        
+        right_rows = self._run_join_step(step.right, relations, names)
+        on = self._compile_join_conditions(step, relations, names)
+        if step.method == "hash":
+            return self._hash_join(step, names, on, left_rows, right_rows)
+        
+        # Nested loop: ON checked for every pair
+        result = []
         for left_row in left_rows:
-            for right_row in right_rows:
-                combined = {}
-                ambiguous_cols: Set[str] = set()
-
-                # Add left columns (qualified by table + alias, plus unqualified)
-                for col_name, col_value in left_row.items():
-                    combined[f"{left_table}.{col_name}"] = col_value
-                    if left_ref != left_table:
-                        combined[f"{left_ref}.{col_name}"] = col_value
-                    combined[col_name] = col_value
-                
-                # Add right columns (qualified by table + alias; detect unqualified ambiguity)
-                for col_name, col_value in right_row.items():
-                    combined[f"{right_table}.{col_name}"] = col_value
-                    if right_ref != right_table:
-                        combined[f"{right_ref}.{col_name}"] = col_value
-
-                    if col_name in combined:
-                        ambiguous_cols.add(col_name)
-                        # Remove unqualified ambiguous key so callers must qualify
-                        combined.pop(col_name, None)
-                    else:
-                        combined[col_name] = col_value
-
-                if ambiguous_cols:
-                    combined["__ambiguous_cols__"] = ambiguous_cols
-                
-                # Check ON condition
-                if self._evaluate_join_condition(join.on_condition, combined, left_table, right_table, left_ref, right_ref):
-                    result.append(combined)
+            result.extend(self._join_pairs(on, [(left_row, right_row) for right_row in right_rows]))
+        return result
+    
+    def _filter_leaf(self, leaf, relations: List, names: List[List[str]], rows: List[Dict]) -> List[Tuple]:
+        """Value tuples of the rows of a plan leaf passing its filters"""
+        rel = next(iter(leaf.relations))
+        values = [tuple(map(row.get, names[rel])) for row in rows]
+        return [values[i] for i in self._matching(self._leaf_programs(leaf, relations, names), values)]
+    
+    def _leaf_programs(self, leaf, relations: List, names: List[List[str]]) -> List:
+        """
+        Programs filtering the value tuples of a plan leaf: WHERE conjuncts
+        reading only its relation, then its ON conjuncts alike
+        """
+        programs = []
+        if leaf.filters:
+            rel = next(iter(leaf.relations))
+            types = [col.type for col in relations[rel].columns]
+            programs.append(compile_expr(self.planner.conjunction(leaf.filters),
+                                         lambda name: names[rel].index(name.split(".")[-1]),
+                                         lambda slot: types[slot]))
+        return programs + self._compile_join_conditions(leaf, relations, names)
+    
+    def _matching(self, programs: List, values: List[Tuple]) -> List[int]:
+        """Indexes of the value tuples every program holds for"""
+        selected = list(range(len(values)))
+        for program in programs:
+            if not selected:
+                break
+            selected = [selected[i] for i in program.filter([values[j] for j in selected])]
+        return selected
+    
+    def _compile_join_conditions(self, step, relations: List, names: List[List[str]]) -> List:
+        """
+        Programs of a plan step's ON conjuncts, over its rows' values laid
+        end to end; values are compared as stored (no numeric coercion)
+        """
+        offsets, types = {}, []
+        for rel in step.layout:
+            offsets[rel] = len(types)
+            types.extend(col.type for col in relations[rel].columns)
+        
+        programs = []
+        for cond in step.conditions:
+            def slot_of(name: str, cond=cond) -> int:
+                rel, col = cond.names[name]
+                return offsets[rel] + names[rel].index(col)
+            programs.append(compile_expr(cond.expr, slot_of, lambda slot: types[slot],
+                                         coerce_numeric_text=False))
+        return programs
+    
+    def _join_pairs(self, on: List, pairs: List[Tuple[Tuple, Tuple]]) -> List[Tuple]:
+        """Joined rows of the (left, right) pairs every ON program holds for"""
+        if not on:
+            return [left + right for left, right in pairs]
+        values = [tuple(itertools.chain(*left, *right)) for left, right in pairs]
+        return [pairs[i][0] + pairs[i][1] for i in self._matching(on, values)]
+    
+    def _column_value(self, row: Tuple, layout: List[int], names: List[List[str]], column: Tuple[int, str]):
+        """Value of a (relation, column) in a join row"""
+        rel, col = column
+        return row[layout.index(rel)][names[rel].index(col)]
+    
+    def _hash_join(self, step, names: List[List[str]], on: List, left_rows: List[Tuple],
+                   right_rows: List[Tuple]) -> List[Tuple]:
+        """
+        Equi-join hashing the smaller input on the key columns (C++ hash
+        join); matched pairs are then checked against every ON conjunct
+        """
+        left_keys = [[self._column_value(row, step.left.layout, names, left) for left, _ in step.keys]
+                     for row in left_rows]
+        right_keys = [[self._column_value(row, step.right.layout, names, right) for _, right in step.keys]
+                      for row in right_rows]
+        
+        if len(left_rows) <= len(right_rows):
+            # Keep the left order, as the other joins do
+            pairs = sorted(hash_join(left_keys, right_keys))
+        else:
+            pairs = [(left, right) for right, left in hash_join(right_keys, left_keys)]
+        return self._join_pairs(on, [(left_rows[left], right_rows[right]) for left, right in pairs])
+    
+    def _merge_join(self, step, relations: List, names: List[List[str]]) -> List[Tuple]:
+        """
+        Join of two tables through indexes led by the first key's columns
+        
+        The C++ merge join streams both indexes in join value order and
+        returns the entries sharing each value, MERGE_JOIN_BATCH groups per
+        call (each call resumes after the last join value); only their rows
+        are fetched, filtered and joined (full ON check) group by group.
+        """
+        on = self._compile_join_conditions(step, relations, names)
+        left_rel, right_rel = next(iter(step.left.relations)), next(iter(step.right.relations))
+        left_prefix = indexes.index_prefix(step.left_index["name"])
+        right_prefix = indexes.index_prefix(step.right_index["name"])
         
+        result = []
+        for left_entries, right_entries in self._merge_join_groups(left_prefix, right_prefix):
+            left_rows = self._entry_rows(step.left_index, left_entries, relations[left_rel].columns)
+            left_rows = self._filter_leaf(step.left, relations, names, left_rows)
+            if not left_rows:
+                continue
+            right_rows = self._entry_rows(step.right_index, right_entries, relations[right_rel].columns)
+            right_rows = self._filter_leaf(step.right, relations, names, right_rows)
+            result.extend(self._join_pairs(on, [((left,), (right,)) for left in left_rows
+                                                for right in right_rows]))
         return result
     
-    def _evaluate_join_condition(
-        self,
-        expr: Expr,
-        row: dict,
-        left_table: str,
-        right_table: str,
-        left_ref: Optional[str] = None,
-        right_ref: Optional[str] = None,
-    ) -> bool:
-        """Evaluate JOIN ON condition with strict column resolution"""
-        if isinstance(expr, BinaryOp):
-            left_val = self._get_join_expr_value(expr.left, row, left_table, right_table, left_ref, right_ref)
-            right_val = self._get_join_expr_value(expr.right, row, left_table, right_table, left_ref, right_ref)
-            
-            if expr.op == "=":
-                return left_val == right_val
-            elif expr.op == "!=":
-                return left_val != right_val
-            elif expr.op == "<":
-                return left_val < right_val
-            elif expr.op == ">":
-                return left_val > right_val
-            elif expr.op == "<=":
-                return left_val <= right_val
-            elif expr.op == ">=":
-                return left_val >= right_val
-            elif expr.op == "AND":
-                return left_val and right_val
-            elif expr.op == "OR":
-                return left_val or right_val
-            else:
-                raise RuntimeError(f"Unsupported operator: {expr.op}")
-        
-        return True
-    
-    def _get_join_expr_value(
-        self,
-        expr: Expr,
-        row: dict,
-        left_table: str,
-        right_table: str,
-        left_ref: Optional[str] = None,
-        right_ref: Optional[str] = None,
-    ):
-        """Get expression value for JOIN with strict (SQL-like) resolution"""
-        if isinstance(expr, ColumnRef):
-            col_name = expr.name
-
-            # Explicitly qualified reference
-            if "." in col_name:
-                if col_name in row:
-                    return row[col_name]
-                raise RuntimeError(f"Column not found in JOIN condition: {col_name}")
-
-            # Unqualified reference: detect ambiguity first
-            if col_name in row.get("__ambiguous_cols__", set()):
-                raise RuntimeError(f"Ambiguous column in JOIN condition: {col_name}")
-
-            # Try known qualification variants
-            candidates = [
-                f"{left_table}.{col_name}",
-                f"{right_table}.{col_name}",
-            ]
-            if left_ref:
-                candidates.append(f"{left_ref}.{col_name}")
-            if right_ref:
-                candidates.append(f"{right_ref}.{col_name}")
-
-            values = [row[c] for c in candidates if c in row]
-            if len(values) == 1:
-                return values[0]
-            if len(values) > 1:
-                raise RuntimeError(f"Ambiguous column in JOIN condition: {col_name}")
-
-            raise RuntimeError(f"Column not found in JOIN condition: {col_name}")
+    def _merge_join_groups(self, left_prefix: str, right_prefix: str):
+        """Yields (left entries, right entries) per join value, batch by batch"""
+        after = ""
+        while True:
+            groups = self.engine.merge_join(left_prefix, right_prefix, after, self.MERGE_JOIN_BATCH)
+            for _, left_entries, right_entries in groups:
+                yield left_entries, right_entries
+            if len(groups) < self.MERGE_JOIN_BATCH:
+                return
+            after = groups[-1][0]
+    
+    def _index_nested_loop_join(self, step, relations: List, names: List[List[str]],
+                                left_rows: List[Tuple]) -> List[Tuple]:
+        """
+        Join probing the right table's index with the left rows' values of
+        the first key
         
-        elif isinstance(expr, Literal):
-            return expr.value
+        Distinct join values are probed in one sorted multi-range scan (the
+        B+Tree reuses its descent path between nearby keys), and the rows
+        they reference are fetched the same way; rows keep the left order.
+        """
+        on = self._compile_join_conditions(step, relations, names)
+        left_column = step.keys[0][0]
+        right_rel = next(iter(step.right.relations))
+        
+        # Join value (as its encoded key) -> right row keys
+        idx = step.right_index
+        probes = {}
+        for row in left_rows:
+            value = self._column_value(row, step.left.layout, names, left_column)
+            probes[encode_key([value])] = value
+        ranges = [indexes.scan_range(idx["name"], [value]) for value in probes.values()]
+        matches: Dict[str, List[str]] = {}
+        for entry_key, entry_value in self.engine.multi_range_scan(ranges) if ranges else []:
+            for row_key, key_values, _ in indexes.scan_entry(idx, entry_key, entry_value):
+                matches.setdefault(encode_key(key_values[:1]), []).append(row_key)
+        
+        # Right rows by key, filtered as the right leaf would be
+        fetched = self._fetch_rows([key for keys in matches.values() for key in keys],
+                                   relations[right_rel].columns)
+        row_keys = list(fetched)
+        values = [tuple(map(fetched[key].get, names[right_rel])) for key in row_keys]
+        right_rows = {row_keys[i]: values[i]
+                      for i in self._matching(self._leaf_programs(step.right, relations, names), values)}
+        
+        pairs = []
+        for left_row in left_rows:
+            value = self._column_value(left_row, step.left.layout, names, left_column)
+            for key in matches.get(encode_key([value]), []):
+                if key in right_rows:
+                    pairs.append((left_row, (right_rows[key],)))
+        return self._join_pairs(on, pairs)
+    
+    def _entry_rows(self, idx: Dict, entries: List[Tuple[str, str]], columns: List) -> List[Dict]:
+        """Rows referenced by index entries, fetched from the table"""
+        row_keys = [row_key for entry_key, entry_value in entries
+                    for row_key, _, _ in indexes.scan_entry(idx, entry_key, entry_value)]
+        rows = self._fetch_rows(row_keys, columns)
+        return [rows[key] for key in row_keys if key in rows]
+    
+    def _fetch_rows(self, row_keys: List[str], columns: List) -> Dict[str, Dict]:
+        """Parsed rows by key, read in one sorted batch of point lookups"""
+        if not row_keys:
+            return {}
+        found = self.engine.multi_range_scan([(key, key) for key in row_keys])
+        return {key: self._parse_row(value, columns) for key, value in found if value != "DELETED"}
+    
+    def _combine_join_rows(self, rows: List[Dict], relations: List) -> Dict:
+        """
+        Joined row of one row per relation: columns qualified by table and
+        alias (a later relation wins for a repeated table), plus the plain
+        names only one relation has
+        """
+        combined = {}
+        ambiguous_cols: Set[str] = set()
+        
+        for row, rel in zip(rows, relations):
+            for col_name, col_value in row.items():
+                combined[f"{rel.table}.{col_name}"] = col_value
+                if rel.ref != rel.table:
+                    combined[f"{rel.ref}.{col_name}"] = col_value
+                
+                if col_name in ambiguous_cols:
+                    continue
+                if col_name in combined:
+                    ambiguous_cols.add(col_name)
+                    # Remove unqualified ambiguous key so callers must qualify
+                    combined.pop(col_name, None)
+                else:
+                    combined[col_name] = col_value
         
-        elif isinstance(expr, BinaryOp):
-            left = self._get_join_expr_value(expr.left, row, left_table, right_table, left_ref, right_ref)
-            right = self._get_join_expr_value(expr.right, row, left_table, right_table, left_ref, right_ref)
-            
-            if expr.op == "+":
-                return left + right
-            elif expr.op == "-":
-                return left - right
-            elif expr.op == "*":
-                return left * right
-            elif expr.op == "/":
-                return left / right
-            else:
-                # For comparison operators, return the comparison result
-                if expr.op == "=":
-                    return left == right
-                elif expr.op == "!=":
-                    return left != right
-                elif expr.op == "<":
-                    return left < right
-                elif expr.op == ">":
-                    return left > right
-                elif expr.op == "<=":
-                    return left <= right
-                elif expr.op == ">=":
-                    return left >= right
-        
-        return None
+        if ambiguous_cols:
+            combined["__ambiguous_cols__"] = ambiguous_cols
+        
+        return combined
     
     # ============================================================
     # Helper Methods
@@ -506,6 +817,84 @@ class Executor:
             # If casting fails, return as string
             return value
     
+    def _column_types(self, table: str, columns: List, ref: Optional[str] = None) -> Dict[str, str]:
+        """Column name -> type, plain and qualified (typed comparisons in predicates)"""
+        types = {}
+        for col in columns:
+            types[col.name] = col.type
+            types[f"{table}.{col.name}"] = col.type
+            if ref:
+                types[f"{ref}.{col.name}"] = col.type
+        return types
+    
+    def _output_name(self, column: str) -> str:
+        """Name of a SELECT column as HAVING refers to it (COUNT(*), dept)"""
+        func, arg = parse_aggregate_function(column)
+        return f"{func}({arg})" if func else column
+    
+    def _parse_row(self, value: str, columns: List) -> Dict:
+        """Parse stored row data (col1|col2|...) into a dict"""
+        values = value.split("|")
+        
+        row = {}
+        for i, col in enumerate(columns):
+            if i < len(values):
+                row[col.name] = self._cast_value(values[i], col.type)
+            else:
+                row[col.name] = None
+        return row
+    
+    def _add_index_entry(self, idx: Dict, row: Dict, row_key: str):
+        """Index a row (goes to the side log while the index is building)"""
+        if not (idx["building"] and self._log_index_change(idx, True, row, row_key)):
+            self._apply_index_add(idx, row, row_key)
+    
+    def _remove_index_entry(self, idx: Dict, row: Dict, row_key: str):
+        """Un-index a row (goes to the side log while the index is building)"""
+        if not (idx["building"] and self._log_index_change(idx, False, row, row_key)):
+            self._apply_index_remove(idx, row, row_key)
+    
+    def _log_index_change(self, idx: Dict, added: bool, row: Dict, row_key: str) -> bool:
+        """
+        Append a change to the side log of a building index
+        
+        Returns False if the build finished meanwhile (apply directly).
+        The state is re-read under the lock the build holds while it
+        drains the log for the last time, so no change is lost.
+        """
+        with self._index_build_lock:
+            current = self.catalog.get_index(idx["name"])
+            if current is None:
+                return True  # Dropped
+            if not current["building"]:
+                return False
+            
+            values = [row.get(col) for col in idx["columns"] + idx["include"]]
+            self.engine.insert(indexes.build_log_key(idx["name"], next(self._index_log_seq)),
+                               indexes.encode_log_record(added, row_key, values))
+            return True
+    
+    def _apply_index_add(self, idx: Dict, row: Dict, row_key: str):
+        """Index a row (posting list add, or one entry for covering indexes)"""
+        values = [row.get(col) for col in idx["columns"]]
+        
+        if indexes.uses_postings(idx):
+            indexes.add_posting(self.engine, idx["name"], values, indexes.row_id_of(row_key))
+        else:
+            include_values = [row.get(col) for col in idx["include"]]
+            self.engine.insert(indexes.entry_key(idx["name"], values, row_key),
+                               indexes.entry_value(row_key, include_values))
+    
+    def _apply_index_remove(self, idx: Dict, row: Dict, row_key: str):
+        """Un-index a row (no error if it is not indexed)"""
+        values = [row.get(col) for col in idx["columns"]]
+        
+        if indexes.uses_postings(idx):
+            indexes.remove_posting(self.engine, idx["name"], values, indexes.row_id_of(row_key))
+        else:
+            entry_key = indexes.entry_key(idx["name"], values, row_key)
+            self.engine.delete_range(entry_key, entry_key)
+    
     def _resolve_column_value(self, column: str, row: dict, strict_ambiguous: bool = False) -> Any:
         """Resolve column references, including qualified names and ambiguity checks."""
         if "." in column:
@@ -515,59 +904,3 @@ class Executor:
             raise RuntimeError(f"Ambiguous column reference: {column}")
 
         return row.get(column)
-
-    def _evaluate_expr(self, expr: Expr, row: dict) -> bool:
-        """Evaluate WHERE clause expression against a row"""
-        if isinstance(expr, BinaryOp):
-            left = self._get_expr_value(expr.left, row)
-            right = self._get_expr_value(expr.right, row)
-            
-            # Try to convert to numbers for comparison if both look numeric
-            try:
-                if isinstance(left, str) and left.replace(".", "").replace("-", "").isdigit():
-                    left = float(left) if "." in left else int(left)
-                if isinstance(right, str) and right.replace(".", "").replace("-", "").isdigit():
-                    right = float(right) if "." in right else int(right)
-            except (ValueError, AttributeError):
-                pass
-            
-            op = expr.op.upper()
-            if op == "=":
-                return left == right
-            elif op == ">":
-                return left > right
-            elif op == "<":
-                return left < right
-            elif op == ">=":
-                return left >= right
-            elif op == "<=":
-                return left <= right
-            elif op == "!=":
-                return left != right
-            elif op == "AND":
-                return left and right
-            elif op == "OR":
-                return left or right
-            else:
-                raise RuntimeError(f"Unknown operator: {op}")
-        
-        elif isinstance(expr, ColumnRef):
-            return self._resolve_column_value(expr.name, row, strict_ambiguous=True)
-        
-        elif isinstance(expr, Literal):
-            return expr.value
-        
-        else:
-            raise RuntimeError(f"Unknown expression type: {type(expr)}")
-    
-    def _get_expr_value(self, expr: Expr, row: dict) -> Any:
-        """Get value of expression in context of a row"""
-        if isinstance(expr, ColumnRef):
-            return self._resolve_column_value(expr.name, row, strict_ambiguous=True)
-        elif isinstance(expr, Literal):
-            return expr.value
-        elif isinstance(expr, BinaryOp):
-            # For AND/OR in sub-expressions
-            return self._evaluate_expr(expr, row)
-        else:
-            raise RuntimeError(f"Unknown expression type: {type(expr)}")
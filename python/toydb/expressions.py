@@ -0,0 +1,218 @@
+"""
+Expression Compiler - WHERE / JOIN ON / HAVING expressions as bytecode
+
+An expression is compiled once per query into an ExprProgram (C++, see
+cpp/include/expr_vm.hpp) and evaluated over whole batches of rows. Each
+row is passed as a tuple of column values ("slots"); the compiler maps
+every column reference to its slot:
+
+    WHERE age > 30 AND dept = 'Eng'      slots: (age, dept)
+
+    LOAD_COLUMN  v0 <- slot 0            all loads and constants come
+    LOAD_CONST   v1 <- 30                first, every comparison reads
+    LOAD_COLUMN  v2 <- slot 1            registers
+    LOAD_CONST   v3 <- 'Eng'
+    GT_INT       f0 <- v0 > v1           typed: age is INT, 30 is an int
+    JUMP_IF_FALSE f0 -> 7                AND short-circuits
+    EQ_TEXT      f0 <- v2 = v3
+    RETURN       f0
+
+Text literals that look numeric are turned into numbers here, as the
+executor always compared them; text column values are coerced the same
+way at run time (WHERE / HAVING only, JOIN ON compares plain values).
+"""
+
+from typing import Any, Callable, Dict, List, Optional
+from .ast_nodes import *
+from ._storage_engine import ExprProgram, ExprOp
+
+
+_COMPARISONS = {
+    "=": (ExprOp.EQ, ExprOp.EQ_INT, ExprOp.EQ_TEXT),
+    "!=": (ExprOp.NE, ExprOp.NE_INT, ExprOp.NE_TEXT),
+    "<": (ExprOp.LT, ExprOp.LT_INT, None),
+    "<=": (ExprOp.LE, ExprOp.LE_INT, None),
+    ">": (ExprOp.GT, ExprOp.GT_INT, None),
+    ">=": (ExprOp.GE, ExprOp.GE_INT, None),
+}
+
+
+def looks_numeric(value: Any) -> bool:
+    """Text the executor compares as a number ("42", "-1.5")"""
+    return isinstance(value, str) and value.replace(".", "").replace("-", "").isdigit()
+
+
+def _coerce(value: Any) -> Any:
+    """Numeric-looking text as a number (unchanged if it does not parse)"""
+    if looks_numeric(value):
+        try:
+            return float(value) if "." in value else int(value)
+        except ValueError:
+            pass
+    return value
+
+
+def compile_expr(
+    expr: Expr,
+    slot_of: Callable[[str], int],
+    type_of: Callable[[int], Optional[str]] = lambda slot: None,
+    coerce_numeric_text: bool = True,
+) -> ExprProgram:
+    """
+    Compile a boolean expression
+
+    Args:
+        expr: WHERE / ON / HAVING expression
+        slot_of: Column name -> slot in the row tuple (raises if unknown)
+        type_of: Slot -> column type (INT, FLOAT, TEXT), None if unknown
+        coerce_numeric_text: Compare numeric-looking text as numbers
+    """
+    return _Compiler(slot_of, type_of, coerce_numeric_text).compile(expr)
+
+
+class _Compiler:
+    def __init__(self, slot_of, type_of, coerce_numeric_text: bool):
+        self.slot_of = slot_of
+        self.type_of = type_of
+        self.coerce = coerce_numeric_text
+        self.program = ExprProgram(coerce_numeric_text)
+        self.registers: Dict[Any, int] = {}  # Loaded column slot / constant -> register
+        self.flags = 0
+
+    def compile(self, expr: Expr) -> ExprProgram:
+        # Loads first, so every branch sees them
+        self._load_operands(expr)
+        result = self._compile_bool(expr)
+        self.program.emit(ExprOp.RETURN, 0, result)
+        return self.program
+
+    def _load_operands(self, expr: Expr):
+        if isinstance(expr, BinaryOp):
+            self._load_operands(expr.left)
+            self._load_operands(expr.right)
+        elif isinstance(expr, InList):
+            self._load_operands(expr.expr)
+        elif isinstance(expr, ColumnRef):
+            slot = self.slot_of(expr.name)
+            if ("col", slot) not in self.registers:
+                reg = self.registers[("col", slot)] = len(self.registers)
+                self.program.emit(ExprOp.LOAD_COLUMN, reg, slot)
+        elif isinstance(expr, Literal):
+            value = _coerce(expr.value) if self.coerce else expr.value
+            key = ("const", type(value), value)
+            if key not in self.registers:
+                reg = self.registers[key] = len(self.registers)
+                self.program.emit(ExprOp.LOAD_CONST, reg, self.program.add_constant(value))
+        else:
+            raise RuntimeError(f"Unknown expression type: {type(expr)}")
+
+    def _register(self, expr: Expr) -> int:
+        """Value register loaded for a column or literal operand"""
+        if isinstance(expr, ColumnRef):
+            return self.registers[("col", self.slot_of(expr.name))]
+        if isinstance(expr, Literal):
+            value = _coerce(expr.value) if self.coerce else expr.value
+            return self.registers[("const", type(value), value)]
+        raise RuntimeError(f"Unsupported operand: {expr_to_string(expr)}")
+
+    def _operand_type(self, expr: Expr) -> Optional[str]:
+        if isinstance(expr, ColumnRef):
+            return self.type_of(self.slot_of(expr.name))
+        value = _coerce(expr.value) if self.coerce else expr.value
+        if isinstance(value, int):
+            return "INT"
+        if isinstance(value, str):
+            return "TEXT"
+        return None
+
+    def _new_flag(self) -> int:
+        self.flags += 1
+        return self.flags - 1
+
+    def _compile_bool(self, expr: Expr, dst: Optional[int] = None) -> int:
+        """Emit code leaving the truth of expr in a flag register"""
+        if dst is None:
+            dst = self._new_flag()
+
+        if isinstance(expr, BinaryOp) and expr.op.upper() in ("AND", "OR"):
+            self._compile_bool(expr.left, dst)
+            jump_op = ExprOp.JUMP_IF_FALSE if expr.op.upper() == "AND" else ExprOp.JUMP_IF_TRUE
+            jump = self.program.emit(jump_op, 0, dst)
+            self._compile_bool(expr.right, dst)
+            self.program.patch(jump, len(self.program))
+
+        elif isinstance(expr, BinaryOp):
+            if expr.op not in _COMPARISONS:
+                raise RuntimeError(f"Unknown operator: {expr.op}")
+            self.program.emit(self._comparison_op(expr), dst,
+                              self._register(expr.left), self._register(expr.right))
+
+        elif isinstance(expr, InList):
+            self.program.emit(ExprOp.IN_LIST, dst, self._register(expr.expr),
+                              self.program.add_list(expr.values))
+
+        else:
+            self.program.emit(ExprOp.TRUTHY, dst, self._register(expr))
+
+        return dst
+
+    def _comparison_op(self, expr: BinaryOp):
+        generic, int_op, text_op = _COMPARISONS[expr.op]
+        left, right = self._operand_type(expr.left), self._operand_type(expr.right)
+
+        if left == "INT" and right == "INT":
+            return int_op
+
+        # Text equality is plain string equality unless coercion could
+        # make two different strings equal (both sides numeric-looking)
+        if text_op is not None and left == "TEXT" and right == "TEXT":
+            plain = [e for e in (expr.left, expr.right)
+                     if isinstance(e, Literal) and not looks_numeric(e.value)]
+            if plain or not self.coerce:
+                return text_op
+
+        return generic
+
+
+class RowPredicate:
+    """
+    A compiled WHERE / HAVING expression over row dicts
+
+    Slots are the referenced column names, in order of appearance.
+    """
+
+    def __init__(self, expr: Expr, column_types: Optional[Dict[str, str]] = None):
+        self.columns: List[str] = []
+        column_types = column_types or {}
+
+        def slot_of(name: str) -> int:
+            if name not in self.columns:
+                self.columns.append(name)
+            return self.columns.index(name)
+
+        self.program = compile_expr(expr, slot_of,
+                                    lambda slot: column_types.get(self.columns[slot]))
+
+    def _check_ambiguous(self, row: Dict):
+        ambiguous = row.get("__ambiguous_cols__")
+        if ambiguous:
+            for col in self.columns:
+                if col in ambiguous:
+                    raise RuntimeError(f"Ambiguous column reference: {col}")
+
+    def matching(self, rows: List[Dict]) -> List[int]:
+        """Indexes of the rows the predicate holds for"""
+        if not rows:
+            return []
+        # Rows of one query share their columns (and ambiguous names)
+        self._check_ambiguous(rows[0])
+        columns = self.columns
+        return self.program.filter([tuple(map(row.get, columns)) for row in rows])
+
+    def filter(self, rows: List[Dict]) -> List[Dict]:
+        """The rows the predicate holds for, in order"""
+        return [rows[i] for i in self.matching(rows)]
+
+    def matches(self, row: Dict) -> bool:
+        self._check_ambiguous(row)
+        return self.program.evaluate(tuple(map(row.get, self.columns)))
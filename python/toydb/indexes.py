@@ -0,0 +1,262 @@
+"""
+Secondary Indexes - Layout of index entries in the B-Tree
+
+Index entries are plain key-value pairs next to the table rows. Keys are
+built with encode_key (C++ KeyEncoder), which is order-preserving, so all
+entries sharing a prefix of column values form one contiguous key range
+and a range scan over an index returns rows ordered by (col1, col2, ...).
+
+Plain (non-covering) indexes are non-unique and store one posting list
+per distinct value instead of one entry per row:
+
+    __index__:<name>:<encode_key((col1, col2, ...))><chunk>  ->  row IDs
+
+The value is a PostingList (sorted, delta-encoded row IDs). Lists are
+split into chunks of at most POSTING_CHUNK_BYTES so an entry always fits
+a leaf. Sealed chunks are keyed by encode_key((max_row_id,)), an upper
+bound of their IDs; the open tail chunk is keyed by POSTING_TAIL, so
+appends (row IDs only grow) always hit the tail. Adding and removing a
+row ID is a posting_add / posting_remove merge applied at the leaf.
+
+A covering index (CREATE INDEX ... INCLUDE (c3, c4)) stores one entry
+per row, carrying the included column values in the payload:
+
+    __index__:<name>:<encode_key((col1, col2, ..., row_id))>
+        ->  row key + "|" + encode_key((c3, c4))
+
+so queries reading only key and included columns never touch the rows.
+
+While an index is built online, writers do not touch its entries but
+append their changes to a side log, replayed once the bulk load is done:
+
+    __index_log__:<name>:<seq>  ->  "+" or "-" + row key + "|"
+                                    + encode_key((cols..., include cols...))
+"""
+
+from typing import Any, Dict, List, Optional, Tuple
+from ._storage_engine import encode_key, decode_key, encode_postings, decode_postings
+
+
+INDEX_PREFIX = "__index__:"
+
+# Sorts after every encoded component (all type tags are below '~')
+KEY_UPPER_BOUND = "~"
+
+# Key suffix of the open posting chunk: after sealed chunks, below '~'
+POSTING_TAIL = "}"
+
+# Max encoded size of one posting chunk (keeps leaf entries small)
+POSTING_CHUNK_BYTES = 192
+
+BUILD_LOG_PREFIX = "__index_log__:"
+
+
+def index_prefix(index_name: str) -> str:
+    """Key prefix shared by all entries of an index"""
+    return f"{INDEX_PREFIX}{index_name}:"
+
+
+def index_range(index_name: str) -> Tuple[str, str]:
+    """[start, end] covering every entry of an index"""
+    prefix = index_prefix(index_name)
+    return prefix, prefix + KEY_UPPER_BOUND
+
+
+def uses_postings(idx: Dict) -> bool:
+    """Plain indexes use posting lists, covering indexes one entry per row"""
+    return not idx["include"]
+
+
+def row_id_of(row_key: str) -> int:
+    """Row ID part of a row key (table:%020d)"""
+    return int(row_key.rsplit(":", 1)[1])
+
+
+def row_key_of(table_name: str, row_id: int) -> str:
+    """Row key for a row ID"""
+    return f"{table_name}:{row_id:020d}"
+
+
+# ============================================================
+# Covering indexes (one entry per row)
+# ============================================================
+
+def entry_key(index_name: str, values: List[Any], row_key: str) -> str:
+    """Index entry key for a row whose indexed columns hold values"""
+    return index_prefix(index_name) + encode_key(list(values) + [row_id_of(row_key)])
+
+
+def entry_value(row_key: str, include_values: List[Any]) -> str:
+    """Index entry payload: the row key, plus included column values"""
+    if not include_values:
+        return row_key
+    return row_key + "|" + encode_key(list(include_values))
+
+
+def decode_entry(key: str, value: str) -> Tuple[List[Any], str, List[Any]]:
+    """
+    Split an index entry into (key column values, row key, included values)
+    """
+    key_values = decode_key(key[key.index(":", len(INDEX_PREFIX)) + 1:])[:-1]
+
+    row_key, sep, payload = value.partition("|")
+    include_values = decode_key(payload) if sep else []
+    return key_values, row_key, include_values
+
+
+# ============================================================
+# Posting lists (one entry per distinct value)
+# ============================================================
+
+def add_posting(engine, index_name: str, values: List[Any], row_id: int):
+    """Add a row ID to the posting list of values"""
+    prefix = index_prefix(index_name) + encode_key(list(values))
+    chunk_key = _find_chunk(engine, prefix, row_id) or prefix + POSTING_TAIL
+
+    # One transaction, so a crash cannot leave the split half done
+    txn_id = engine.begin_transaction()
+    try:
+        merged = engine.merge_txn(txn_id, chunk_key, str(row_id), "posting_add")
+        if len(merged) > POSTING_CHUNK_BYTES:
+            # Seal the lower half under its max ID; the upper half keeps the key
+            ids = decode_postings(merged)
+            low, high = ids[:len(ids) // 2], ids[len(ids) // 2:]
+            engine.insert_txn(txn_id, prefix + encode_key([low[-1]]), encode_postings(low))
+            engine.insert_txn(txn_id, chunk_key, encode_postings(high))
+    except Exception:
+        engine.abort_transaction(txn_id)
+        raise
+    engine.commit_transaction(txn_id)
+
+
+def remove_posting(engine, index_name: str, values: List[Any], row_id: int):
+    """Remove a row ID from the posting list of values (no-op if absent)"""
+    prefix = index_prefix(index_name) + encode_key(list(values))
+    chunk_key = _find_chunk(engine, prefix, row_id)
+    if chunk_key is None:
+        return
+
+    txn_id = engine.begin_transaction()
+    try:
+        if engine.merge_txn(txn_id, chunk_key, str(row_id), "posting_remove") == "":
+            engine.delete_range_txn(txn_id, chunk_key, chunk_key)
+    except Exception:
+        engine.abort_transaction(txn_id)
+        raise
+    engine.commit_transaction(txn_id)
+
+
+def posting_entries(index_name: str, values: List[Any], row_ids: List[int]) -> List[Tuple[str, str]]:
+    """Chunked entries for a whole posting list (bulk index build)"""
+    prefix = index_prefix(index_name) + encode_key(list(values))
+
+    entries = []
+    chunk = []
+    for row_id in sorted(row_ids):
+        chunk.append(row_id)
+        if len(encode_postings(chunk)) > POSTING_CHUNK_BYTES:
+            sealed = chunk[:-1]
+            entries.append((prefix + encode_key([sealed[-1]]), encode_postings(sealed)))
+            chunk = [row_id]
+
+    if chunk:
+        entries.append((prefix + POSTING_TAIL, encode_postings(chunk)))
+    return entries
+
+
+def decode_posting_entry(key: str, value: str) -> Tuple[List[Any], List[int]]:
+    """Split a posting chunk into (key column values, row IDs)"""
+    encoded = key[key.index(":", len(INDEX_PREFIX)) + 1:]
+    if encoded.endswith(POSTING_TAIL):
+        key_values = decode_key(encoded[:-len(POSTING_TAIL)])
+    else:
+        key_values = decode_key(encoded)[:-1]
+    return key_values, decode_postings(value)
+
+
+def _find_chunk(engine, prefix: str, row_id: int) -> Optional[str]:
+    """First chunk whose key bounds row_id (the tail if none is sealed)"""
+    chunks = engine.range_scan(prefix + encode_key([row_id]), prefix + POSTING_TAIL)
+    return chunks[0][0] if chunks else None
+
+
+# ============================================================
+# Online build side log
+# ============================================================
+
+def build_log_key(index_name: str, seq: int) -> str:
+    """Side log key of the seq-th change recorded during a build"""
+    return f"{BUILD_LOG_PREFIX}{index_name}:{seq:020d}"
+
+
+def build_log_range(index_name: str) -> Tuple[str, str]:
+    """[start, end] covering the whole side log of an index"""
+    prefix = f"{BUILD_LOG_PREFIX}{index_name}:"
+    return prefix, prefix + KEY_UPPER_BOUND
+
+
+def encode_log_record(added: bool, row_key: str, values: List[Any]) -> str:
+    """Side log record: row (un)indexed with key + included column values"""
+    return ("+" if added else "-") + row_key + "|" + encode_key(list(values))
+
+
+def decode_log_record(value: str) -> Tuple[bool, str, List[Any]]:
+    """Split a side log record into (added, row key, values)"""
+    row_key, _, payload = value[1:].partition("|")
+    return value[0] == "+", row_key, decode_key(payload)
+
+
+# ============================================================
+# Scans
+# ============================================================
+
+def key_value(value: Any, type_: str) -> Any:
+    """
+    Convert a literal to the key type of a column
+
+    Returns:
+        The value to encode, or None if the literal cannot be compared
+        through the index (mismatched types are left to a table scan)
+    """
+    if isinstance(value, bool):
+        return None
+    if type_ == "INT":
+        return value if isinstance(value, int) else None
+    if type_ == "FLOAT":
+        return float(value) if isinstance(value, (int, float)) else None
+    return value if isinstance(value, str) else None
+
+
+def scan_range(index_name: str, eq_values: List[Any],
+               lower: Optional[Any] = None,
+               upper: Optional[Any] = None) -> Tuple[str, str]:
+    """
+    Key range for equality on a column prefix plus an optional range on
+    the next column. Bounds are inclusive; strict comparisons are left to
+    the WHERE filter. A one-sided range skips NULLs.
+    """
+    prefix = index_prefix(index_name) + encode_key(list(eq_values))
+
+    if lower is None and upper is None:
+        return prefix, prefix + KEY_UPPER_BOUND
+
+    start = prefix + encode_key([lower]) if lower is not None \
+        else prefix + encode_key([None]) + KEY_UPPER_BOUND
+    end = prefix + encode_key([upper]) + KEY_UPPER_BOUND if upper is not None \
+        else prefix + KEY_UPPER_BOUND
+    return start, end
+
+
+def scan_entry(idx: Dict, key: str, value: str) -> List[Tuple[str, List[Any], List[Any]]]:
+    """
+    Rows referenced by one index entry, in index order
+
+    Returns:
+        List of (row key, key column values, included column values)
+    """
+    if uses_postings(idx):
+        key_values, row_ids = decode_posting_entry(key, value)
+        return [(row_key_of(idx["table"], row_id), key_values, []) for row_id in row_ids]
+
+    key_values, row_key, include_values = decode_entry(key, value)
+    return [(row_key, key_values, include_values)]
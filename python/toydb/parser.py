@@ -5,6 +5,7 @@ SQL Parser - Simple recursive descent parser for basic SQL statements
 import re
 from typing import List, Optional, Any
 from .ast_nodes import *
+from .aggregates import parse_aggregate_function
 
 
 class ParseError(Exception):
@@ -21,7 +22,7 @@ class SQLParser:
     - INSERT INTO table_name VALUES (val1, val2, ...)
     - SELECT * FROM table_name
     - SELECT col1, col2 FROM table_name WHERE condition
-    - SELECT ... ORDER BY col
+    - SELECT ... ORDER BY col1, col2, ...
     - SELECT ... LIMIT n
     """
     
@@ -209,7 +210,8 @@ class SQLParser:
     
     def parse_create_index(self) -> CreateIndexStmt:
         """
-        Parse: CREATE INDEX index_name ON table_name (column_name)
+        Parse: CREATE INDEX index_name ON table_name (col1, col2, ...)
+               [INCLUDE (col3, ...)]
         """
         self.expect("CREATE")
         self.expect("INDEX")
@@ -220,11 +222,25 @@ class SQLParser:
         
         table_name = self.advance()
         
+        columns = self._parse_identifier_list()
+        
+        # Optional covering columns stored in the index entries
+        include = []
+        if self.match("INCLUDE"):
+            self.advance()
+            include = self._parse_identifier_list()
+        
+        return CreateIndexStmt(index_name, table_name, columns[0], columns, include)
+    
+    def _parse_identifier_list(self) -> List[str]:
+        """Parse: (name1, name2, ...)"""
         self.expect("(")
-        column_name = self.advance()
+        names = [self.advance()]
+        while self.match(","):
+            self.advance()
+            names.append(self.advance())
         self.expect(")")
-        
-        return CreateIndexStmt(index_name, table_name, column_name)
+        return names
     
     def parse_drop_index(self) -> DropIndexStmt:
         """
@@ -268,11 +284,11 @@ class SQLParser:
     def parse_select(self) -> SelectStmt:
         """
         Parse: SELECT columns FROM table 
-               [JOIN table ON condition]
+               [JOIN table ON condition ...]
                [WHERE condition] 
                [GROUP BY columns]
                [HAVING condition]
-               [ORDER BY col] 
+               [ORDER BY col1, col2, ...] 
                [LIMIT n]
         """
         self.expect("SELECT")
@@ -295,10 +311,11 @@ class SQLParser:
         table_name = self.advance()
         table_alias = self._parse_optional_alias()
         
-        # Optional JOIN
-        join = None
-        if self.match("INNER", "LEFT", "RIGHT", "JOIN"):
-            join = self.parse_join()
+        # Optional JOINs
+        joins = []
+        while self.match("INNER", "LEFT", "RIGHT", "JOIN"):
+            joins.append(self.parse_join())
+        join = joins[0] if joins else None
         
         # Optional WHERE clause
         where = None
@@ -326,10 +343,15 @@ class SQLParser:
         
         # Optional ORDER BY
         order_by = None
+        order_by_columns = None
         if self.match("ORDER"):
             self.advance()  # ORDER
             self.expect("BY")
-            order_by = self.advance()
+            order_by_columns = [self.advance()]
+            while self.match(","):
+                self.advance()
+                order_by_columns.append(self.advance())
+            order_by = order_by_columns[0]
         
         # Optional LIMIT
         limit = None
@@ -337,7 +359,8 @@ class SQLParser:
             self.advance()
             limit = int(self.advance())
         
-        return SelectStmt(columns, table_name, where, order_by, limit, join, group_by, having, table_alias)
+        return SelectStmt(columns, table_name, where, order_by, limit, join, group_by, having, table_alias,
+                          order_by_columns, joins)
     
     def _parse_column_expression(self) -> str:
         """Parse a column expression (regular column, qualified column, or aggregate function)"""
@@ -457,7 +480,7 @@ class SQLParser:
         return left
     
     def parse_comparison(self) -> Expr:
-        """Parse comparison: col = val, col > val, etc."""
+        """Parse comparison: col = val, col > val, col IN (v1, v2), etc."""
         left = self.parse_primary()
         
         if self.match("=", ">", "<", ">=", "<=", "!="):
@@ -465,6 +488,16 @@ class SQLParser:
             right = self.parse_primary()
             return BinaryOp(left, op, right)
         
+        if self.match("IN"):
+            self.advance()
+            self.expect("(")
+            values = [self.parse_literal()]
+            while self.match(","):
+                self.advance()
+                values.append(self.parse_literal())
+            self.expect(")")
+            return InList(left, values)
+        
         return left
     
     def parse_primary(self) -> Expr:
@@ -482,6 +515,11 @@ class SQLParser:
         if token.replace(".", "").isdigit():
             return Literal(self.parse_literal())
         
+        # Aggregate (HAVING), named like its SELECT column: COUNT(*)
+        if self.match("COUNT", "SUM", "AVG", "MIN", "MAX") and self.peek() == "(":
+            func, arg = parse_aggregate_function(self._parse_column_expression())
+            return ColumnRef(f"{func}({arg})")
+        
         # Column reference (optionally qualified, e.g. u.id)
         col = self.advance()
         if self.match("."):
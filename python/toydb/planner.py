@@ -8,10 +8,18 @@ Generates optimal execution plans for SQL queries by:
 - Collecting and using statistics
 """
 
-from typing import List, Optional, Dict, Any
-from dataclasses import dataclass
+import itertools
+from typing import List, Optional, Dict, Any, Set, Tuple, FrozenSet
+from dataclasses import dataclass, field
 from .ast_nodes import *
 from .catalog import Catalog
+from .aggregates import parse_aggregate_function
+from . import indexes
+
+
+def _indent(node) -> str:
+    """A child node's lines, nested one level under its parent"""
+    return str(node).replace("\n", "\n  ")
 
 
 @dataclass
@@ -37,10 +45,12 @@ class IndexScanNode(PlanNode):
     index_name: str = ""
     column_name: str = ""
     condition: Optional[Expr] = None
+    index_only: bool = False  # Covering index: rows are never fetched
     
     def __str__(self):
         cond = f" WHERE {expr_to_string(self.condition)}" if self.condition else ""
-        return f"IndexScan({self.table_name}, {self.index_name}){cond} [cost={self.cost:.1f}, rows={self.estimated_rows}]"
+        kind = "IndexOnlyScan" if self.index_only else "IndexScan"
+        return f"{kind}({self.table_name}, {self.index_name}){cond} [cost={self.cost:.1f}, rows={self.estimated_rows}]"
 
 
 @dataclass
@@ -51,7 +61,7 @@ class FilterNode(PlanNode):
     selectivity: float = 0.1  # Estimated fraction of rows passing filter
     
     def __str__(self):
-        return f"Filter({expr_to_string(self.condition)}) [selectivity={self.selectivity:.2f}, rows={self.estimated_rows}]\n  {self.child}"
+        return f"Filter({expr_to_string(self.condition)}) [selectivity={self.selectivity:.2f}, rows={self.estimated_rows}]\n  {_indent(self.child)}"
 
 
 @dataclass
@@ -66,7 +76,7 @@ class ProjectNode(PlanNode):
     
     def __str__(self):
         cols = ", ".join(self.columns)
-        return f"Project({cols})\n  {self.child}"
+        return f"Project({cols})\n  {_indent(self.child)}"
 
 
 @dataclass
@@ -76,7 +86,7 @@ class SortNode(PlanNode):
     column: str = ""
     
     def __str__(self):
-        return f"Sort({self.column})\n  {self.child}"
+        return f"Sort({self.column})\n  {_indent(self.child)}"
 
 
 @dataclass
@@ -86,7 +96,126 @@ class LimitNode(PlanNode):
     limit: int = 0
     
     def __str__(self):
-        return f"Limit({self.limit})\n  {self.child}"
+        return f"Limit({self.limit})\n  {_indent(self.child)}"
+
+
+@dataclass
+class JoinNode(PlanNode):
+    """Join of two inputs, each a table or another join"""
+    method: str = "NestedLoopJoin"
+    left: Optional[PlanNode] = None
+    right: Optional[PlanNode] = None
+    condition: Optional[Expr] = None  # None: cross product
+    
+    def __str__(self):
+        condition = expr_to_string(self.condition) if self.condition else ""
+        children = "".join(f"\n  {_indent(child)}" for child in (self.left, self.right))
+        return f"{self.method}({condition}) [cost={self.cost:.1f}, rows={self.estimated_rows}]{children}"
+
+
+@dataclass
+class IndexAccess:
+    """
+    How the executor reads a table through a secondary index
+    
+    eq_values bind a prefix of the index columns; lower/upper (inclusive)
+    bound the next column, or ranges lists several such bounds (IN-lists,
+    OR-ed ranges) read in one multi-range scan. provides_order is set when the index order
+    already satisfies ORDER BY, so no sort is needed; covering when every
+    column the query reads is a key or INCLUDE column (index-only scan).
+    """
+    index: Dict
+    eq_values: List[Any]
+    lower: Optional[Any] = None
+    upper: Optional[Any] = None
+    provides_order: bool = False
+    covering: bool = False
+    ranges: Optional[List[tuple]] = None
+    
+    def key_range(self) -> tuple:
+        """[start_key, end_key] of the index entries to scan"""
+        return indexes.scan_range(self.index["name"], self.eq_values, self.lower, self.upper)
+    
+    def key_ranges(self) -> List[tuple]:
+        """All [start_key, end_key] ranges to scan (one unless ranges is set)"""
+        if self.ranges is None:
+            return [self.key_range()]
+        return [indexes.scan_range(self.index["name"], self.eq_values, lower, upper)
+                for lower, upper in self.ranges]
+
+
+@dataclass
+class JoinRelation:
+    """A table of a JOIN query: the FROM table is relation 0, then each JOIN in order"""
+    table: str
+    ref: str  # Alias, or the table name
+    columns: List  # Catalog columns
+    rows: int = 0  # Table row count (catalog stats)
+
+
+@dataclass
+class JoinCondition:
+    """
+    An ON conjunct with its column references resolved: names maps each
+    referenced name to (relation, column)
+    """
+    expr: Expr
+    names: Dict[str, Tuple[int, str]]
+    
+    @property
+    def relations(self) -> FrozenSet[int]:
+        # A conjunct reading no column (ON 1 = 1) is checked with the FROM table
+        return frozenset(rel for rel, _ in self.names.values()) or frozenset([0])
+    
+    def equi_columns(self) -> Optional[Tuple[Tuple[int, str], Tuple[int, str]]]:
+        """(relation, column) of both sides of a column = column of two relations"""
+        expr = self.expr
+        if not (isinstance(expr, BinaryOp) and expr.op == "="
+                and isinstance(expr.left, ColumnRef) and isinstance(expr.right, ColumnRef)):
+            return None
+        a, b = self.names[expr.left.name], self.names[expr.right.name]
+        return (a, b) if a[0] != b[0] else None
+
+
+@dataclass
+class JoinStep:
+    """
+    A node of a join plan, producing rows of a set of relations
+    
+    A leaf (method None) reads one relation and applies its filters (WHERE
+    conjuncts reading only that relation). A join combines left and right:
+    
+    - "nested_loop": every left row against every right row
+    - "hash": the smaller input is hashed on the keys (HashJoin in C++)
+    - "merge": two leaves read through indexes led by the first key
+      columns, merged in key order (MergeJoin in C++)
+    - "index_nested_loop": the right leaf's index (led by the first key's
+      right column) is probed with the left rows' values in one sorted batch
+    
+    conditions are the ON conjuncts first covered by this join (all of
+    them are checked on every matched pair); keys are the equi-join column
+    pairs among them, as ((relation, column) on the left, on the right).
+    Merge and index probes compare encoded keys, so their first key pair
+    has one INT or TEXT type on both sides.
+    """
+    relations: FrozenSet[int]
+    rows: int
+    cost: float
+    method: Optional[str] = None
+    left: Optional['JoinStep'] = None
+    right: Optional['JoinStep'] = None
+    conditions: List[JoinCondition] = field(default_factory=list)
+    keys: List[Tuple[Tuple[int, str], Tuple[int, str]]] = field(default_factory=list)
+    filters: List[Expr] = field(default_factory=list)  # Leaf only
+    left_index: Optional[Dict] = None  # merge
+    right_index: Optional[Dict] = None  # merge, index_nested_loop
+    
+    @property
+    def layout(self) -> List[int]:
+        """Relations of a produced row, in order"""
+        if self.method is None:
+            return list(self.relations)
+        return self.left.layout + self.right.layout
 
 
 class QueryPlanner:
@@ -106,6 +235,18 @@ class QueryPlanner:
     COST_INDEX_SCAN_PER_ROW = 0.5  # Cheaper than table scan (no parsing)
     COST_FILTER_PER_ROW = 0.1
     COST_SORT_PER_ROW = 2.0  # O(n log n) but simplified
+    COST_INDEX_PROBE = 2.0  # Sorted batch of seeks: descents mostly reused
+    COST_HASH_PER_ROW = 1.0  # Build or probe one row of a hash join (held in memory)
+    
+    # Join orders are searched exhaustively up to this many tables
+    MAX_DP_RELATIONS = 8
+    
+    JOIN_METHOD_NAMES = {
+        "nested_loop": "NestedLoopJoin",
+        "hash": "HashJoin",
+        "merge": "MergeJoin",
+        "index_nested_loop": "IndexNestedLoopJoin",
+    }
     
     def __init__(self, catalog: Catalog, storage_engine):
         self.catalog = catalog
@@ -124,23 +265,30 @@ class QueryPlanner:
         6. Add limit node if LIMIT
         7. Add projection node for SELECT columns
         """
-        # Get table statistics
-        stats = self.catalog.get_stats(stmt.table_name)
-        total_rows = stats.get("rows", 0)
-        
-        # If no stats, estimate by counting
-        if total_rows == 0:
-            total_rows = self._estimate_row_count(stmt.table_name)
-            self.catalog.update_stats(stmt.table_name, total_rows)
+        total_rows = self._table_rows(stmt.table_name)
         
-        # Choose access method
-        scan_node = self._choose_access_method(stmt, total_rows)
+        # Choose access method (the index the executor will use, if any)
+        access = self.choose_index_access(stmt)
+        if access:
+            scan_node = self._index_scan_node(stmt, access, total_rows)
+        elif stmt.joins:
+            scan_node = self._join_node(stmt)
+        else:
+            scan_node = self._choose_access_method(stmt, total_rows)
         
         # Apply filters (if WHERE clause not already handled by index)
         plan = scan_node
         if stmt.where and not isinstance(scan_node, IndexScanNode):
-            # Add filter node
+            # Add filter node (a join plan already counts the conjuncts it
+            # applies to single tables)
             selectivity = self._estimate_selectivity(stmt.where)
+            if stmt.joins:
+                pushed = [expr for exprs in self.relation_filters(stmt, self.join_relations(stmt)).values()
+                          for expr in exprs]
+                selectivity = 1.0
+                for expr in self._split_conjuncts(stmt.where):
+                    if not any(expr is other for other in pushed):
+                        selectivity *= self._estimate_selectivity(expr)
             plan = FilterNode(
                 child=scan_node,
                 condition=stmt.where,
@@ -149,11 +297,11 @@ class QueryPlanner:
                 estimated_rows=int(scan_node.estimated_rows * selectivity)
             )
         
-        # Apply ORDER BY
-        if stmt.order_by:
+        # Apply ORDER BY (unless an index scan already returns rows in order)
+        if stmt.order_by and not (access and access.provides_order):
             plan = SortNode(
                 child=plan,
-                column=stmt.order_by,
+                column=", ".join(stmt.order_by_columns),
                 cost=plan.cost + (plan.estimated_rows * self.COST_SORT_PER_ROW),
                 estimated_rows=plan.estimated_rows
             )
@@ -240,7 +388,7 @@ class QueryPlanner:
             (index_name, column_name, estimated_rows) or None
         """
         # Get indexes for this table
-        indexes = self.catalog.get_indexes(table_name)
+        indexes = [idx for idx in self.catalog.get_indexes(table_name) if not idx["building"]]
         
         if not indexes:
             return None
@@ -275,6 +423,543 @@ class QueryPlanner:
         
         return None
     
+    def choose_index_access(self, stmt: SelectStmt) -> Optional[IndexAccess]:
+        """
+        Pick a secondary index for a single-table SELECT
+        
+        An index is usable when WHERE binds its leading columns by equality
+        (AND-ed conjuncts only), ranges over the next column (a comparison,
+        an IN-list or an OR of ranges), or - with a LIMIT - when its column
+        order matches ORDER BY. The index binding
+        the most columns wins; covering indexes break ties.
+        """
+        if stmt.join:
+            return None
+        
+        # Indexes still being built online are incomplete
+        table_indexes = [idx for idx in self.catalog.get_indexes(stmt.table_name)
+                         if not idx["building"]]
+        if not table_indexes:
+            return None
+        
+        column_types = {col.name: col.type for col in self.catalog.get_columns(stmt.table_name)}
+        refs = {stmt.table_name, stmt.table_alias}
+        needed = self._referenced_columns(stmt, list(column_types))
+        
+        # Split WHERE into col-op-literal conjuncts; IN-lists and OR-ed
+        # ranges on one column become (col, "IN", [(lower, upper), ...])
+        conjuncts = []
+        for expr in self._split_conjuncts(stmt.where):
+            comparison = self._comparison(expr, refs, column_types)
+            if comparison:
+                conjuncts.append(comparison)
+                continue
+            
+            column_ranges = self._column_ranges(expr, refs, column_types)
+            if column_ranges:
+                col_name, ranges = column_ranges
+                if len(ranges) == 1 and ranges[0][0] is not None and ranges[0][0] == ranges[0][1]:
+                    conjuncts.append((col_name, "=", ranges[0][0]))
+                else:
+                    conjuncts.append((col_name, "IN", ranges))
+        
+        best = None
+        best_score = None
+        
+        for idx in table_indexes:
+            cols = idx["columns"]
+            
+            # Equality on a prefix of the index columns
+            eq_values = []
+            for col in cols:
+                value = next((v for c, o, v in conjuncts if c == col and o == "="), None)
+                if value is None:
+                    break
+                eq_values.append(value)
+            
+            # Range on the next column
+            lower = upper = None
+            ranges = None
+            if len(eq_values) < len(cols):
+                next_col = cols[len(eq_values)]
+                for c, o, v in conjuncts:
+                    if c != next_col:
+                        continue
+                    if o in (">", ">=") and (lower is None or v > lower):
+                        lower = v
+                    elif o in ("<", "<=") and (upper is None or v < upper):
+                        upper = v
+                    elif o == "IN" and ranges is None:
+                        ranges = v
+                
+                # Several ranges: clip each by the plain bounds
+                if ranges is not None:
+                    ranges = [self._intersect_range(r, (lower, upper)) for r in ranges]
+                    ranges = [r for r in ranges if r is not None]
+                    lower = upper = None
+            
+            # Rows sharing the equality prefix are ordered by the remaining columns
+            provides_order = False
+            if stmt.order_by_columns:
+                n = len(stmt.order_by_columns)
+                provides_order = any(
+                    cols[j:j + n] == stmt.order_by_columns
+                    for j in range(len(eq_values) + 1)
+                )
+            
+            has_range = lower is not None or upper is not None or ranges is not None
+            if not eq_values and not has_range and not (provides_order and stmt.limit):
+                continue
+            
+            covering = needed is not None and needed <= set(cols) | set(idx["include"])
+            
+            score = (len(eq_values), has_range, provides_order, covering)
+            if best_score is None or score > best_score:
+                best_score = score
+                best = IndexAccess(idx, eq_values, lower, upper, provides_order, covering, ranges)
+        
+        return best
+    
+    def _index_scan_node(self, stmt: SelectStmt, access: IndexAccess, total_rows: int) -> IndexScanNode:
+        """Plan node for the index access chosen by choose_index_access"""
+        selectivity = 0.01 ** len(access.eq_values)
+        if access.lower is not None or access.upper is not None:
+            selectivity *= 0.3
+        elif access.ranges is not None:
+            selectivity *= min(1.0, sum(
+                0.01 if lower is not None and lower == upper else 0.3
+                for lower, upper in access.ranges
+            ))
+        estimated_rows = max(1, int(total_rows * selectivity))
+        
+        # Non-covering scans also fetch and parse every matching row
+        per_row = self.COST_INDEX_SCAN_PER_ROW
+        if not access.covering:
+            per_row += self.COST_TABLE_SCAN_PER_ROW
+        
+        return IndexScanNode(
+            table_name=stmt.table_name,
+            index_name=access.index["name"],
+            column_name=access.index["column"],
+            condition=stmt.where,
+            index_only=access.covering,
+            cost=self.COST_INDEX_SEEK + estimated_rows * per_row,
+            estimated_rows=estimated_rows
+        )
+    
+    def join_relations(self, stmt: SelectStmt) -> List[JoinRelation]:
+        """The FROM table and the JOIN tables of a query, in order"""
+        tables = [(stmt.table_name, stmt.table_alias)] + \
+                 [(join.table_name, join.alias) for join in stmt.joins]
+        return [JoinRelation(table, alias or table, self.catalog.get_columns(table), self._table_rows(table))
+                for table, alias in tables]
+    
+    def join_conditions(self, stmt: SelectStmt, relations: List[JoinRelation]) -> List[JoinCondition]:
+        """
+        The conjuncts of every ON clause, resolved with SQL scoping: the ON
+        of the k-th JOIN sees the FROM table and the first k JOIN tables,
+        and an unqualified name must belong to exactly one of them
+        """
+        conditions = []
+        for k, join in enumerate(stmt.joins, start=1):
+            visible = relations[:k + 1]
+            for expr in self._split_conjuncts(join.on_condition):
+                names = {name: self._resolve_join_column(name, visible)
+                         for name in self._expr_columns(expr)}
+                conditions.append(JoinCondition(expr, names))
+        return conditions
+    
+    def _resolve_join_column(self, name: str, visible: List[JoinRelation]) -> Tuple[int, str]:
+        if "." in name:
+            ref, col = name.split(".", 1)
+            matches = [i for i, rel in enumerate(visible)
+                       if ref in (rel.table, rel.ref) and any(c.name == col for c in rel.columns)]
+            if not matches:
+                raise RuntimeError(f"Column not found in JOIN condition: {name}")
+            return matches[-1], col  # A table joined to itself unaliased: the later one
+        
+        matches = [i for i, rel in enumerate(visible) if any(c.name == name for c in rel.columns)]
+        if len(matches) > 1:
+            raise RuntimeError(f"Ambiguous column in JOIN condition: {name}")
+        if not matches:
+            raise RuntimeError(f"Column not found in JOIN condition: {name}")
+        return matches[0], name
+    
+    def relation_filters(self, stmt: SelectStmt, relations: List[JoinRelation]) -> Dict[int, List[Expr]]:
+        """WHERE conjuncts of a JOIN query that only read one relation, by relation"""
+        def owner(name: str) -> Optional[int]:
+            if "." in name:
+                ref, col = name.split(".", 1)
+                owners = [i for i, rel in enumerate(relations) if ref in (rel.table, rel.ref)]
+                if len(owners) == 1 and any(c.name == col for c in relations[owners[0]].columns):
+                    return owners[0]
+                return None
+            owners = [i for i, rel in enumerate(relations) if any(c.name == name for c in rel.columns)]
+            return owners[0] if len(owners) == 1 else None
+        
+        filters: Dict[int, List[Expr]] = {}
+        for expr in self._split_conjuncts(stmt.where):
+            owners = {owner(name) for name in self._expr_columns(expr)}
+            if len(owners) == 1 and None not in owners:
+                filters.setdefault(owners.pop(), []).append(expr)
+        return filters
+    
+    def choose_join(self, stmt: SelectStmt) -> Optional[JoinStep]:
+        """
+        Cheapest join plan for a query of INNER JOINs (None otherwise:
+        nested loops in written order, see written_order_join)
+        
+        Dynamic programming over sets of relations: the best plan of a set
+        is the cheapest join of the best plans of two disjoint subsets,
+        over every split and join method. Splits with no ON conjunct
+        between their sides (cross products) are only used for sets that
+        have no other split. Beyond MAX_DP_RELATIONS relations, the
+        relations are joined in written order, each with its best method.
+        """
+        if not stmt.joins or any(join.join_type.upper() != "INNER" for join in stmt.joins):
+            return None
+        
+        relations = self.join_relations(stmt)
+        conditions = self.join_conditions(stmt, relations)
+        leaves = self._join_leaves(stmt, relations, conditions)
+        
+        if len(relations) > self.MAX_DP_RELATIONS:
+            plan = leaves[0]
+            for leaf in leaves[1:]:
+                plan = self._best_join(plan, leaf, relations, conditions, cross_product=True)
+            return plan
+        
+        best: Dict[FrozenSet[int], JoinStep] = {leaf.relations: leaf for leaf in leaves}
+        everything = range(len(relations))
+        for size in range(2, len(relations) + 1):
+            for subset in itertools.combinations(everything, size):
+                subset = frozenset(subset)
+                splits = [(frozenset(left), subset - frozenset(left))
+                          for k in range(1, size) for left in itertools.combinations(sorted(subset), k)]
+                
+                # Both sides must already have a plan (DP over smaller sets)
+                plans = [self._best_join(best[left], best[right], relations, conditions)
+                         for left, right in splits]
+                plans = [plan for plan in plans if plan is not None]
+                if not plans:
+                    plans = [self._best_join(best[left], best[right], relations, conditions,
+                                             cross_product=True) for left, right in splits]
+                best[subset] = min(plans, key=lambda plan: plan.cost)
+        
+        return best[frozenset(everything)]
+    
+    def written_order_join(self, stmt: SelectStmt) -> JoinStep:
+        """Nested loop joins of the relations in written order (no reordering)"""
+        relations = self.join_relations(stmt)
+        conditions = self.join_conditions(stmt, relations)
+        leaves = self._join_leaves(stmt, relations, conditions)
+        
+        plan = leaves[0]
+        for leaf in leaves[1:]:
+            covered = self._covered_conditions(plan, leaf, conditions)
+            plan = JoinStep(plan.relations | leaf.relations,
+                            rows=self._join_rows(plan, leaf, covered, [], relations),
+                            cost=self._nested_loop_cost(plan, leaf),
+                            method="nested_loop", left=plan, right=leaf, conditions=covered)
+        return plan
+    
+    def _join_leaves(self, stmt: SelectStmt, relations: List[JoinRelation],
+                     conditions: List[JoinCondition]) -> List[JoinStep]:
+        """One leaf per relation: a table scan with its pushed-down filters"""
+        pushed = self.relation_filters(stmt, relations)
+        leaves = []
+        for i, rel in enumerate(relations):
+            filters = pushed.get(i, [])
+            selectivity = 1.0
+            for expr in filters:
+                selectivity *= self._estimate_selectivity(expr)
+            
+            # ON conjuncts reading only this relation are checked at the scan too
+            leaf = JoinStep(frozenset([i]), rows=0, cost=0.0, filters=filters)
+            own = [cond for cond in conditions if cond.relations <= leaf.relations]
+            for cond in own:
+                selectivity *= self._estimate_selectivity(cond.expr)
+            leaf.conditions = own
+            
+            leaf.rows = max(1, int(rel.rows * selectivity)) if rel.rows else 0
+            leaf.cost = rel.rows * self.COST_TABLE_SCAN_PER_ROW
+            if filters or own:
+                leaf.cost += rel.rows * self.COST_FILTER_PER_ROW
+            leaves.append(leaf)
+        return leaves
+    
+    def _covered_conditions(self, left: JoinStep, right: JoinStep,
+                            conditions: List[JoinCondition]) -> List[JoinCondition]:
+        """ON conjuncts first covered by joining left and right"""
+        both = left.relations | right.relations
+        return [cond for cond in conditions if cond.relations <= both
+                and not cond.relations <= left.relations and not cond.relations <= right.relations]
+    
+    def _best_join(self, left: JoinStep, right: JoinStep, relations: List[JoinRelation],
+                   conditions: List[JoinCondition], cross_product: bool = False) -> Optional[JoinStep]:
+        """Cheapest way to join two plans (None for a cross product unless allowed)"""
+        covered = self._covered_conditions(left, right, conditions)
+        if not covered and not cross_product:
+            return None
+        
+        # Equi-join columns oriented (left side, right side)
+        keys = []
+        for cond in covered:
+            pair = cond.equi_columns()
+            if pair and pair[0][0] in left.relations:
+                keys.append(pair)
+            elif pair and pair[1][0] in left.relations:
+                keys.append((pair[1], pair[0]))
+        
+        rows = self._join_rows(left, right, covered, keys, relations)
+        
+        def step(method: str, cost: float, key_order=keys, **indexes) -> JoinStep:
+            return JoinStep(left.relations | right.relations, rows, cost, method, left, right,
+                            covered, list(key_order), **indexes)
+        
+        options = [step("nested_loop", self._nested_loop_cost(left, right))]
+        if keys:
+            options.append(step("hash", left.cost + right.cost +
+                                (left.rows + right.rows) * self.COST_HASH_PER_ROW))
+        
+        # Merge and index probes: a key (moved first) whose right column
+        # leads an index, with a type encoded keys compare exactly
+        for key in keys:
+            (left_rel, left_col), (right_rel, right_col) = key
+            key_type = self._column_type(relations[right_rel], right_col)
+            if key_type not in ("INT", "TEXT") or self._column_type(relations[left_rel], left_col) != key_type:
+                continue
+            right_idx = self._leading_index(relations[right_rel].table, right_col)
+            if right_idx is None or right.method is not None:
+                continue
+            key_order = [key] + [k for k in keys if k is not key]
+            
+            matches = self._matches_per_probe(key, relations)
+            options.append(step("index_nested_loop", left.cost + left.rows * (
+                self.COST_INDEX_PROBE + matches * (self.COST_INDEX_SCAN_PER_ROW + self.COST_TABLE_SCAN_PER_ROW)
+            ), key_order, right_index=right_idx))
+            
+            left_idx = self._leading_index(relations[left_rel].table, left_col)
+            if left_idx is not None and left.method is None:
+                cost = self._merge_join_cost(relations[left_rel].rows, relations[right_rel].rows)
+                if left.filters or left.conditions or right.filters or right.conditions:
+                    cost += (relations[left_rel].rows + relations[right_rel].rows) * self.COST_FILTER_PER_ROW
+                options.append(step("merge", cost, key_order, left_index=left_idx, right_index=right_idx))
+        
+        return min(options, key=lambda option: option.cost)
+    
+    def _column_type(self, relation: JoinRelation, column: str) -> Optional[str]:
+        return next((col.type for col in relation.columns if col.name == column), None)
+    
+    def _leading_index(self, table: str, column: str) -> Optional[Dict]:
+        """A ready index whose first column is column"""
+        for idx in self.catalog.get_indexes(table):
+            if not idx["building"] and idx["columns"][0] == column:
+                return idx
+        return None
+    
+    def _key_domain(self, key, relations: List[JoinRelation]) -> int:
+        """
+        Distinct values assumed for an equi-join key: the row count of the
+        smaller table (a foreign key referencing it)
+        """
+        (left_rel, _), (right_rel, _) = key
+        return max(1, min(relations[left_rel].rows, relations[right_rel].rows))
+    
+    def _join_rows(self, left: JoinStep, right: JoinStep, covered: List[JoinCondition],
+                   keys: List, relations: List[JoinRelation]) -> int:
+        """Estimated rows of a join: |L| * |R| / key domain, times the other conjuncts' selectivity"""
+        rows = float(left.rows) * right.rows
+        if keys:
+            rows /= self._key_domain(keys[0], relations)
+        for cond in covered:
+            if not (keys and cond.equi_columns() in (keys[0], keys[0][::-1])):
+                rows *= self._estimate_selectivity(cond.expr)
+        return max(1, int(rows)) if left.rows and right.rows else 0
+    
+    def _matches_per_probe(self, key, relations: List[JoinRelation]) -> float:
+        """Right rows per left row (before the right leaf's filters)"""
+        return max(1.0, relations[key[1][0]].rows / self._key_domain(key, relations))
+    
+    def _join_node(self, stmt: SelectStmt) -> PlanNode:
+        """Plan node for the join plan the executor will run"""
+        relations = self.join_relations(stmt)
+        plan = self.choose_join(stmt) or self.written_order_join(stmt)
+        return self._join_step_node(plan, relations)
+    
+    def _join_step_node(self, step: JoinStep, relations: List[JoinRelation],
+                        index: Optional[Dict] = None, probes: Optional[int] = None) -> PlanNode:
+        """Plan node of a join step; index and probes describe how a leaf is read"""
+        if step.method is None:
+            rel = relations[next(iter(step.relations))]
+            if index and probes is not None:
+                # Probed once per left row (index nested loop)
+                node = IndexScanNode(table_name=rel.table, index_name=index["name"],
+                                     column_name=index["columns"][0], estimated_rows=step.rows,
+                                     cost=probes * self.COST_INDEX_PROBE)
+            elif index:
+                node = IndexScanNode(table_name=rel.table, index_name=index["name"],
+                                     column_name=index["columns"][0], estimated_rows=rel.rows,
+                                     cost=rel.rows * self.COST_INDEX_SCAN_PER_ROW)
+            else:
+                node = TableScanNode(table_name=rel.table, estimated_rows=rel.rows,
+                                     cost=rel.rows * self.COST_TABLE_SCAN_PER_ROW)
+            checks = step.filters + [cond.expr for cond in step.conditions]
+            if not checks:
+                return node
+            return FilterNode(child=node, condition=self.conjunction(checks),
+                              selectivity=step.rows / max(rel.rows, 1),
+                              cost=step.cost, estimated_rows=step.rows)
+        
+        left = self._join_step_node(step.left, relations, step.left_index)
+        probes = step.left.rows if step.method == "index_nested_loop" else None
+        right = self._join_step_node(step.right, relations, step.right_index, probes)
+        condition = self.conjunction([cond.expr for cond in step.conditions]) if step.conditions else None
+        return JoinNode(method=self.JOIN_METHOD_NAMES[step.method], left=left, right=right,
+                        condition=condition, cost=step.cost, estimated_rows=step.rows)
+    
+    def conjunction(self, exprs: List[Expr]) -> Expr:
+        """exprs AND-ed together"""
+        condition = exprs[0]
+        for expr in exprs[1:]:
+            condition = BinaryOp(condition, "AND", expr)
+        return condition
+    
+    def _nested_loop_cost(self, left: JoinStep, right: JoinStep) -> float:
+        """Produce both inputs, evaluate ON for every pair"""
+        return left.cost + right.cost + left.rows * right.rows * self.COST_FILTER_PER_ROW
+    
+    def _merge_join_cost(self, left_rows: int, right_rows: int) -> float:
+        """Scan both indexes once, fetch the rows of matching entries"""
+        return (2 * self.COST_INDEX_SEEK +
+                (left_rows + right_rows) * (self.COST_INDEX_SCAN_PER_ROW + self.COST_TABLE_SCAN_PER_ROW))
+    
+    def _comparison(self, expr: Expr, refs: Set, column_types: Dict) -> Optional[tuple]:
+        """(column, op, key value) for a col-op-literal comparison, else None"""
+        if not isinstance(expr, BinaryOp):
+            return None
+        op, left, right = expr.op, expr.left, expr.right
+        if isinstance(left, Literal) and isinstance(right, ColumnRef):
+            flipped = {"<": ">", ">": "<", "<=": ">=", ">=": "<=", "=": "="}
+            if op not in flipped:
+                return None
+            op, left, right = flipped[op], right, left
+        if not (isinstance(left, ColumnRef) and isinstance(right, Literal)):
+            return None
+        
+        col_name = self._table_column(left.name, refs, column_types)
+        if col_name is None:
+            return None
+        
+        value = indexes.key_value(right.value, column_types[col_name])
+        if value is None:
+            return None
+        return col_name, op, value
+    
+    def _column_ranges(self, expr: Expr, refs: Set, column_types: Dict) -> Optional[tuple]:
+        """
+        (column, [(lower, upper), ...]) when expr only restricts one column
+        to a union of ranges: comparisons, IN-lists, OR of those, AND of
+        single ranges. Bounds are inclusive (strict comparisons are left to
+        the WHERE filter); None means unbounded.
+        """
+        if isinstance(expr, InList):
+            if not isinstance(expr.expr, ColumnRef):
+                return None
+            col_name = self._table_column(expr.expr.name, refs, column_types)
+            if col_name is None:
+                return None
+            values = [indexes.key_value(v, column_types[col_name]) for v in expr.values]
+            if any(v is None for v in values):
+                return None
+            return col_name, [(v, v) for v in values]
+        
+        if not isinstance(expr, BinaryOp):
+            return None
+        
+        op = expr.op.upper()
+        if op in ("AND", "OR"):
+            left = self._column_ranges(expr.left, refs, column_types)
+            right = self._column_ranges(expr.right, refs, column_types)
+            if left is None or right is None or left[0] != right[0]:
+                return None
+            if op == "OR":
+                return left[0], left[1] + right[1]
+            if len(left[1]) != 1 or len(right[1]) != 1:
+                return None
+            both = self._intersect_range(left[1][0], right[1][0])
+            return left[0], [both] if both else []
+        
+        comparison = self._comparison(expr, refs, column_types)
+        if comparison is None:
+            return None
+        col_name, op, value = comparison
+        if op == "=":
+            return col_name, [(value, value)]
+        if op in (">", ">="):
+            return col_name, [(value, None)]
+        if op in ("<", "<="):
+            return col_name, [(None, value)]
+        return None
+    
+    def _intersect_range(self, a: tuple, b: tuple) -> Optional[tuple]:
+        """Intersection of two inclusive (lower, upper) ranges, None if empty"""
+        lowers = [v for v in (a[0], b[0]) if v is not None]
+        uppers = [v for v in (a[1], b[1]) if v is not None]
+        lower = max(lowers) if lowers else None
+        upper = min(uppers) if uppers else None
+        if lower is not None and upper is not None and lower > upper:
+            return None
+        return lower, upper
+    
+    def _table_column(self, name: str, refs: Set, column_types: Dict) -> Optional[str]:
+        """Column name of a (possibly qualified) reference to this table"""
+        if "." in name:
+            ref, name = name.split(".", 1)
+            if ref not in refs:
+                return None
+        return name if name in column_types else None
+    
+    def _referenced_columns(self, stmt: SelectStmt, all_columns: List[str]) -> Optional[Set[str]]:
+        """Columns a single-table SELECT reads (None if not known)"""
+        names = []
+        for col in stmt.columns:
+            if col == "*":
+                names.extend(all_columns)
+                continue
+            _, arg = parse_aggregate_function(col)
+            if arg != "*":
+                names.append(arg)
+        
+        names.extend(stmt.group_by or [])
+        names.extend(stmt.order_by_columns or [])
+        names.extend(self._expr_columns(stmt.where))
+        
+        # Qualified names are only resolved for JOINs
+        if any("." in name for name in names):
+            return None
+        return set(names)
+    
+    def _expr_columns(self, expr: Optional[Expr]) -> List[str]:
+        """Column names referenced by an expression"""
+        if isinstance(expr, ColumnRef):
+            return [expr.name]
+        if isinstance(expr, BinaryOp):
+            return self._expr_columns(expr.left) + self._expr_columns(expr.right)
+        if isinstance(expr, InList):
+            return self._expr_columns(expr.expr)
+        if isinstance(expr, FunctionCall):
+            return self._expr_columns(expr.argument)
+        return []
+    
+    def _split_conjuncts(self, condition: Optional[Expr]) -> List[Expr]:
+        """Flatten an AND tree into its conjuncts"""
+        if condition is None:
+            return []
+        if isinstance(condition, BinaryOp) and condition.op.upper() == "AND":
+            return self._split_conjuncts(condition.left) + self._split_conjuncts(condition.right)
+        return [condition]
+    
     def _estimate_selectivity(self, condition: Expr) -> float:
         """
         Estimate fraction of rows that pass the filter
@@ -301,9 +986,19 @@ class QueryPlanner:
                 left_sel = self._estimate_selectivity(condition.left)
                 right_sel = self._estimate_selectivity(condition.right)
                 return min(1.0, left_sel + right_sel)
+        elif isinstance(condition, InList):
+            return min(1.0, 0.01 * len(condition.values))
         
         return 0.1  # Default: 10%
     
+    def _table_rows(self, table_name: str) -> int:
+        """Row count from the catalog stats (counted once if missing)"""
+        total_rows = self.catalog.get_stats(table_name).get("rows", 0)
+        if total_rows == 0:
+            total_rows = self._estimate_row_count(table_name)
+            self.catalog.update_stats(table_name, total_rows)
+        return total_rows
+    
     def _estimate_row_count(self, table_name: str) -> int:
         """
         Estimate number of rows by counting
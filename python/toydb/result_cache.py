@@ -0,0 +1,116 @@
+"""
+Query Result Cache - SELECT results reused while their tables are unchanged
+
+Every table has a version counter, bumped once a write to it (INSERT,
+UPDATE, DELETE, CREATE / ALTER / DROP TABLE) has finished. A cached
+result is tagged with the versions of the tables it read, taken before
+the query ran:
+
+    SELECT COUNT(*) FROM orders           key: parsed statement
+        tags {orders: 7}                  valid while orders is at 7
+
+A lookup returns the result only if every tag is still current, so a
+write racing with the query at worst makes its entry useless, never
+stale. Results are kept under a byte budget, least recently used first
+out.
+"""
+
+import sys
+import threading
+from collections import OrderedDict
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+
+
+def result_size(rows: List[Tuple]) -> int:
+    """Approximate memory held by a result (list, row tuples and values)"""
+    size = sys.getsizeof(rows)
+    for row in rows:
+        size += sys.getsizeof(row) + sum(sys.getsizeof(value) for value in row)
+    return size
+
+
+class ResultCache:
+    """
+    LRU cache of SELECT results under a memory budget
+
+    Keys are normalized queries: the parsed statement, so spacing and
+    keyword case do not matter, with its literal values (the query's
+    parameters) part of the key.
+    """
+
+    def __init__(self, max_bytes: int):
+        self.max_bytes = max_bytes
+        self._lock = threading.Lock()
+        self._versions: Dict[str, int] = {}
+        self._entries: "OrderedDict[str, Tuple[Dict[str, int], List[Tuple], int]]" = OrderedDict()
+        self._bytes = 0
+        self.hits = 0
+        self.misses = 0
+        self.evictions = 0
+
+    @staticmethod
+    def key(stmt: Any) -> str:
+        return repr(stmt)
+
+    def versions(self, tables: Iterable[str]) -> Dict[str, int]:
+        """Current version of each table (read before running the query)"""
+        with self._lock:
+            return {table: self._versions.get(table, 0) for table in tables}
+
+    def bump(self, table: str):
+        """Record a finished write to table: results that read it are invalid"""
+        with self._lock:
+            self._versions[table] = self._versions.get(table, 0) + 1
+
+    def get(self, key: str) -> Optional[List[Tuple]]:
+        """Cached rows for key, None if missing or a table changed since"""
+        with self._lock:
+            entry = self._entries.get(key)
+            if entry is not None:
+                tags, rows, size = entry
+                if all(self._versions.get(table, 0) == version for table, version in tags.items()):
+                    self._entries.move_to_end(key)
+                    self.hits += 1
+                    return list(rows)
+                # Stale: drop it now rather than wait for eviction
+                del self._entries[key]
+                self._bytes -= size
+            self.misses += 1
+            return None
+
+    def put(self, key: str, tags: Dict[str, int], rows: List[Tuple]):
+        """Cache rows computed from tables at the tagged versions"""
+        size = result_size(rows)
+        if size > self.max_bytes:
+            return
+
+        with self._lock:
+            # A write finished while the query ran: the result may be stale already
+            if any(self._versions.get(table, 0) != version for table, version in tags.items()):
+                return
+
+            old = self._entries.pop(key, None)
+            if old is not None:
+                self._bytes -= old[2]
+            self._entries[key] = (tags, list(rows), size)
+            self._bytes += size
+
+            while self._bytes > self.max_bytes:
+                _, (_, _, evicted) = self._entries.popitem(last=False)
+                self._bytes -= evicted
+                self.evictions += 1
+
+    def clear(self):
+        with self._lock:
+            self._entries.clear()
+            self._bytes = 0
+
+    def stats(self) -> Dict[str, int]:
+        with self._lock:
+            return {
+                "result_cache_entries": len(self._entries),
+                "result_cache_bytes": self._bytes,
+                "result_cache_hits": self.hits,
+                "result_cache_misses": self.misses,
+                "result_cache_evictions": self.evictions,
+            }
@@ -9,8 +9,18 @@ ext_modules = [
             "cpp/src/page.cpp",
             "cpp/src/page_manager.cpp",
             "cpp/src/buffer_pool.cpp",
+            "cpp/src/epoch_manager.cpp",
             "cpp/src/btree.cpp",
             "cpp/src/wal.cpp",
+            "cpp/src/merge_operator.cpp",
+            "cpp/src/key_encoder.cpp",
+            "cpp/src/posting_list.cpp",
+            "cpp/src/value_log.cpp",
+            "cpp/src/snapshot_manager.cpp",
+            "cpp/src/change_feed.cpp",
+            "cpp/src/expr_vm.cpp",
+            "cpp/src/merge_join.cpp",
+            "cpp/src/hash_join.cpp",
         ],
         include_dirs=["cpp/include"],
         cxx_std=17,
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""
+Automatic Checkpoint Test
+Tests that the checkpoint policy keeps the WAL bounded without checkpoint() calls
+"""
+
+import os
+import subprocess
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import TransactionalDatabase
+
+# Keeps a transaction open across automatic checkpoints, then crashes
+_CRASHING_WRITER = """
+import os, sys
+sys.path[:0] = {path!r}
+from toydb import TransactionalDatabase
+db = TransactionalDatabase({db_file!r})
+db.set_checkpoint_policy(max_wal_bytes=8192, max_interval=0)
+db.insert("pending", "0")
+txn = db.begin_transaction()
+db.insert_txn(txn, "pending", "1")
+for i in range(200):
+    db.insert(f"more:{{i:03d}}", "v" * 50)
+db.insert_txn(txn, "late", "1")
+print(db.get_stats()["auto_checkpoints"])
+sys.stdout.flush()
+os._exit(0)
+"""
+
+
+def test_wal_bytes_trigger(temp_db_path):
+    """The WAL is checkpointed once it grows past max_wal_bytes"""
+    db_file = temp_db_path
+
+    print("=== Automatic Checkpoint Test ===\n")
+
+    with TransactionalDatabase(db_file) as db:
+        db.set_checkpoint_policy(max_wal_bytes=8192, max_interval=0)
+        for i in range(1000):
+            db.insert(f"key:{i:04d}", "v" * 50)
+
+        stats = db.get_stats()
+        assert stats["auto_checkpoints"] >= 5
+        assert stats["wal_bytes"] < 8192 + 200
+        assert os.path.getsize(db_file + ".wal") < 8192 + 200
+        print(f"✓ {stats['auto_checkpoints']} checkpoints kept the WAL under 8KB")
+
+        # Checkpoints go on while a transaction has uncommitted writes;
+        # the WAL keeps everything from its first write on
+        txn = db.begin_transaction()
+        db.insert_txn(txn, "pending", "1")
+        taken = db.get_stats()["auto_checkpoints"]
+        for i in range(200):
+            db.insert(f"more:{i:03d}", "v" * 50)
+        assert db.get_stats()["auto_checkpoints"] > taken
+        assert db.get_stats()["wal_bytes"] > 200 * 50
+        db.commit_transaction(txn)
+        db.checkpoint()
+        assert db.get_stats()["wal_bytes"] < 200
+        print("✓ Checkpoints continue while a transaction is open")
+
+    with TransactionalDatabase(db_file) as db:
+        assert db.get("key:0999") == "v" * 50
+        assert db.get("pending") == "1"
+        assert len(db.range_scan("more:", "more:~")) == 200
+        print("✓ Data intact after reopen")
+
+    print("\n🎉 Automatic Checkpoint Test: PASSED\n")
+
+
+def test_checkpoint_with_open_transaction(temp_db_path):
+    """A transaction open across checkpoints is rolled back after a crash"""
+    db_file = temp_db_path
+
+    script = _CRASHING_WRITER.format(path=sys.path, db_file=db_file)
+    out = subprocess.run([sys.executable, "-c", script], check=True,
+                         capture_output=True, text=True).stdout
+    assert int(out.split()[-1]) > 0
+
+    with TransactionalDatabase(db_file) as db:
+        assert db.get("pending") == "0"
+        with pytest.raises(Exception, match="Key not found"):
+            db.get("late")
+        assert len(db.range_scan("more:", "more:~")) == 200
+        print("✓ Checkpointed uncommitted write rolled back")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""
+Commit Pipelining Test
+Tests early lock release and commits acknowledged before the log flush
+"""
+
+import os
+import subprocess
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import TransactionalDatabase
+
+
+# Pipelined commits filling far more pages than the buffer pool holds,
+# then an exit without closing the database (a crash)
+_CRASHING_WRITER = """
+import os, sys
+sys.path[:0] = {path!r}
+from toydb import TransactionalDatabase
+db = TransactionalDatabase({db_file!r})
+for i in range(4000):
+    txn = db.begin_transaction()
+    db.insert_txn(txn, f"k{{(i * 7919) % 4000:05d}}", str(i) * 40)
+    db.commit_transaction(txn, wait_durable=False)
+os._exit(0)
+"""
+
+
+def test_pipelined_commits(temp_db_path):
+    """A hot key is released at commit, before the commit is durable"""
+    db_file = temp_db_path
+
+    print("=== Commit Pipelining Test ===\n")
+
+    with TransactionalDatabase(db_file) as db:
+        lsns = []
+        for i in range(10):
+            txn = db.begin_transaction(isolation="snapshot")
+            db.insert_txn(txn, "hot", str(i))
+            lsns.append(db.commit_transaction(txn, wait_durable=False))
+
+        assert lsns == sorted(lsns)
+        assert db.get_stats()["durable_lsn"] < lsns[0]
+        print("✓ Ten commits of one key pipelined without a flush")
+
+        reader = db.begin_transaction(read_only=True, isolation="snapshot")
+        assert db.get_txn(reader, "hot") == "9"
+        db.commit_transaction(reader)
+        assert db.get_stats()["durable_lsn"] >= lsns[-1]
+        print("✓ Reader of pipelined commits acknowledged after they are durable")
+
+        txn = db.begin_transaction()
+        db.insert_txn(txn, "cold", "x")
+        lsn = db.commit_transaction(txn, wait_durable=False)
+        db.wait_durable(lsn)
+        assert db.get_stats()["durable_lsn"] >= lsn
+
+    with TransactionalDatabase(db_file) as db:
+        assert db.get("hot") == "9"
+        assert db.get("cold") == "x"
+        print("✓ Pipelined commits survive reopen")
+
+    print("\n🎉 Commit Pipelining Test: PASSED\n")
+
+
+def test_crash_after_eviction(temp_db_path):
+    """Pages evicted before a crash never hold changes the log lost"""
+    db_file = temp_db_path
+
+    print("=== Crash After Eviction Test ===\n")
+
+    script = _CRASHING_WRITER.format(path=sys.path, db_file=db_file)
+    subprocess.run([sys.executable, "-c", script], check=True)
+    assert os.path.getsize(db_file) > 128 * 4096  # More than the pool holds
+    assert os.path.getsize(db_file + ".wal") > 0  # Flushed ahead of evictions
+
+    with TransactionalDatabase(db_file) as db:
+        db.finish_recovery()
+        rows = dict(db.range_scan("k", "l"))
+        # Commits are recovered in order: a prefix of them, nothing after a gap
+        recovered = [i for i in range(4000) if f"k{(i * 7919) % 4000:05d}" in rows]
+        assert recovered == list(range(len(recovered))) and recovered
+        assert all(rows[f"k{(i * 7919) % 4000:05d}"] == str(i) * 40 for i in recovered)
+        print(f"✓ First {len(recovered)} commits recovered, none after a gap")
+
+    print("\n🎉 Crash After Eviction Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+Composite Index Test
+Tests the order-preserving key encoder and multi-column indexes
+"""
+
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import SQLDatabase, parse_sql
+from toydb._storage_engine import encode_key, decode_key
+
+
+def test_key_encoding_order():
+    """Encoded keys sort like the tuples they encode"""
+    tuples = [
+        (None,),
+        (-2**63,), (-5,), (0,), (7,), (2**63 - 1,),
+        (-1e300,), (-2.5,), (0.0,), (1e-9,), (3.25,),
+        ("",), ("\x00",), ("a",), ("a\x00b",), ("ab",),
+        ("eng", None), ("eng", 30), ("eng", 31), ("ops", 20), ("é",),
+    ]
+    keys = [encode_key(list(t)) for t in tuples]
+
+    assert keys == sorted(keys)
+    for t, k in zip(tuples, keys):
+        assert tuple(decode_key(k)) == t
+        assert "~" not in k
+
+    print("✓ Memcomparable order and round-trip")
+
+
+def test_multi_column_index(temp_db_path):
+    """CREATE INDEX on (dept, age) serves equality, range and ORDER BY"""
+    db_file = temp_db_path
+
+    ast = parse_sql("SELECT * FROM t ORDER BY a, b")
+    assert ast.order_by == "a" and ast.order_by_columns == ["a", "b"]
+
+    with SQLDatabase(db_file) as db:
+        db.execute("CREATE TABLE emp (id INT, dept TEXT, age INT)")
+        people = [(i, ["eng", "ops", "hr"][i % 3], 20 + (i * 7) % 30) for i in range(60)]
+        for pid, dept, age in people:
+            db.execute(f"INSERT INTO emp VALUES ({pid}, '{dept}', {age})")
+
+        db.execute("CREATE INDEX idx_dept_age ON emp (dept, age)")
+        idx = db.executor.catalog.get_index("idx_dept_age")
+        assert idx["columns"] == ["dept", "age"]
+
+        # Equality on the prefix plus a range on the next column
+        result = db.execute("SELECT id FROM emp WHERE dept = 'eng' AND age > 35")
+        expected = {p[0] for p in people if p[1] == "eng" and p[2] > 35}
+        assert {r[0] for r in result} == expected
+        print("✓ Prefix equality + range via index")
+
+        # ORDER BY both index columns, no sort needed
+        plan = db.execute("EXPLAIN SELECT * FROM emp ORDER BY dept, age LIMIT 5")
+        assert "Sort" not in plan
+        result = db.execute("SELECT dept, age FROM emp ORDER BY dept, age LIMIT 5")
+        assert result == sorted((p[1], p[2]) for p in people)[:5]
+        print("✓ Multi-column ORDER BY via index range scan")
+
+        # UPDATE and DELETE keep entries in sync
+        db.execute("UPDATE emp SET age = 99 WHERE id = 0")
+        db.execute("DELETE FROM emp WHERE id = 3")
+        result = db.execute("SELECT id FROM emp WHERE dept = 'eng' AND age >= 99")
+        assert [r[0] for r in result] == [0]
+        result = db.execute("SELECT id FROM emp WHERE dept = 'eng' AND age = 41")
+        assert 3 not in [r[0] for r in result]
+
+        # Inserts after CREATE INDEX are indexed too
+        db.execute("INSERT INTO emp VALUES (100, 'eng', 99)")
+        result = db.execute("SELECT id FROM emp WHERE dept = 'eng' AND age = 99 ORDER BY id")
+        assert [r[0] for r in result] == [0, 100]
+
+        db.execute("DROP INDEX idx_dept_age")
+        assert db.engine.range_scan("__index__:idx_dept_age:", "__index__:idx_dept_age:~") == []
+        result = db.execute("SELECT id FROM emp WHERE dept = 'eng' AND age = 99 ORDER BY id")
+        assert [r[0] for r in result] == [0, 100]
+        print("✓ Index maintained through UPDATE / DELETE / DROP INDEX")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
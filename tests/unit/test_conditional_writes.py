@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""
+Conditional Write Test
+Tests put_if_absent / put_if_version / delete_if (compare-and-swap)
+"""
+
+import os
+import sys
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import IndexedDatabase, TransactionalDatabase
+
+
+@pytest.mark.parametrize("db_class", [IndexedDatabase, TransactionalDatabase])
+def test_compare_and_swap(db_class, temp_db_path):
+    """Conditional writes only apply when the condition holds"""
+    db_file = temp_db_path
+
+    with db_class(db_file) as db:
+        assert db.put_if_absent("job:1", "pending")
+        assert not db.put_if_absent("job:1", "other")
+        assert db.get("job:1") == "pending"
+
+        value, version = db.get_with_version("job:1")
+        assert value == "pending"
+
+        # Stale version loses, current version wins
+        assert not db.put_if_version("job:1", "done", version + 100)
+        assert db.put_if_version("job:1", "running", version)
+        _, new_version = db.get_with_version("job:1")
+        assert new_version > version
+
+        # A second writer holding the old version is rejected
+        assert not db.put_if_version("job:1", "done", version)
+
+        assert not db.delete_if("job:1", version)
+        assert db.delete_if("job:1", new_version)
+        with pytest.raises(Exception, match="Key not found"):
+            db.get("job:1")
+
+        # Missing key never matches a version
+        assert not db.put_if_version("job:1", "x", new_version)
+
+
+def test_conditional_writes_in_transaction(temp_db_path):
+    """Conditional writes join explicit transactions and survive reopen"""
+    db_file = temp_db_path
+
+    with TransactionalDatabase(db_file) as db:
+        txn = db.begin_transaction()
+        assert db.put_if_absent_txn(txn, "a", "1")
+        assert not db.put_if_absent_txn(txn, "a", "2")
+        db.commit_transaction(txn)
+
+        txn = db.begin_transaction()
+        assert db.put_if_absent_txn(txn, "b", "1")
+        db.abort_transaction(txn)
+
+        _, version = db.get_with_version("a")
+
+    with TransactionalDatabase(db_file) as db:
+        assert db.get_with_version("a") == ("1", version)
+        with pytest.raises(Exception, match="Key not found"):
+            db.get("b")
+
+        txn = db.begin_transaction()
+        assert db.put_if_version_txn(txn, "a", "2", version)
+        db.commit_transaction(txn)
+        assert db.get("a") == "2"
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
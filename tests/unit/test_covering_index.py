@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""
+Covering Index Test
+Tests CREATE INDEX ... INCLUDE (...) and index-only scans
+"""
+
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import SQLDatabase
+
+
+def test_covering_index(temp_db_path):
+    """Covered queries are answered from index entries alone"""
+    db_file = temp_db_path
+
+    print("=== Covering Index Test ===\n")
+
+    with SQLDatabase(db_file) as db:
+        db.execute("CREATE TABLE emp (id INT, name TEXT, dept TEXT, salary FLOAT)")
+        for i in range(30):
+            dept = ["eng", "ops"][i % 2]
+            db.execute(f"INSERT INTO emp VALUES ({i}, 'e{i}', '{dept}', {1000.5 + i})")
+
+        db.execute("CREATE INDEX idx_dept ON emp (dept) INCLUDE (name, salary)")
+        assert db.executor.catalog.get_index("idx_dept")["include"] == ["name", "salary"]
+
+        query = "SELECT name, salary FROM emp WHERE dept = 'ops'"
+        plan = db.execute("EXPLAIN " + query)
+        assert "IndexOnlyScan" in plan
+        expected = [(f"e{i}", 1000.5 + i) for i in range(1, 30, 2)]
+        assert sorted(db.execute(query)) == sorted(expected)
+        print("✓ EXPLAIN shows IndexOnlyScan")
+
+        # Prove the base table is not read: corrupt the stored rows
+        rows = db.engine.range_scan("emp:", "emp:~")
+        for key, _ in rows:
+            db.engine.insert(key, "garbage")
+        assert sorted(db.execute(query)) == sorted(expected)
+        print("✓ Covered query never touches the base table")
+
+        # Restore rows; UPDATE of an included column rewrites the entry
+        for key, value in rows:
+            db.engine.insert(key, value)
+        db.execute("UPDATE emp SET salary = 1.5 WHERE id = 1")
+        result = db.execute("SELECT salary FROM emp WHERE dept = 'ops' AND name = 'e1'")
+        assert result == [(1.5,)]
+
+        # Columns outside the index fall back to fetching rows
+        plan = db.execute("EXPLAIN SELECT id FROM emp WHERE dept = 'ops'")
+        assert "IndexScan(" in plan
+        assert len(db.execute("SELECT id FROM emp WHERE dept = 'ops'")) == 15
+        print("✓ Included columns stay in sync; non-covered queries fetch rows")
+
+    print("\n🎉 Covering Index Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
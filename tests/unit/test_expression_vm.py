@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""
+Expression VM Test
+Tests WHERE / JOIN ON / HAVING evaluated as compiled bytecode
+"""
+
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import SQLDatabase
+from toydb.parser import parse_sql
+from toydb.expressions import RowPredicate, compile_expr
+
+
+def _where(sql):
+    return parse_sql(sql).where
+
+
+def test_compiled_predicates():
+    """Typed opcodes, short-circuit AND / OR, IN lists and coercion"""
+    print("=== Expression VM Test ===\n")
+
+    where = RowPredicate(_where("SELECT * FROM t WHERE age > 30 AND dept = 'Eng'"),
+                         {"age": "INT", "dept": "TEXT"})
+    assert where.columns == ["age", "dept"]
+    rows = [{"age": 31, "dept": "Eng"}, {"age": 30, "dept": "Eng"},
+            {"age": 45, "dept": "Ops"}, {"age": "40", "dept": "Eng"}]
+    assert where.matching(rows) == [0, 3]
+    print("✓ Batch filtered with typed comparisons (text '40' still coerced)")
+
+    # The right side of OR is skipped once the left one holds:
+    # ordering NULL against a number would raise
+    either = RowPredicate(_where("SELECT * FROM t WHERE id IN (1, 2) OR score > 10"))
+    assert either.filter([{"id": 1, "score": None}, {"id": 3, "score": 11}]) == \
+        [{"id": 1, "score": None}, {"id": 3, "score": 11}]
+    try:
+        either.matches({"id": 3, "score": None})
+        assert False, "Expected an error ordering NULL"
+    except RuntimeError:
+        pass
+    print("✓ OR short-circuits, IN lists use plain equality")
+
+    # JOIN ON compares values as stored
+    slots = {"a": 0, "b": 1}
+    on = compile_expr(_where("SELECT * FROM t WHERE a = b"), slots.__getitem__,
+                      coerce_numeric_text=False)
+    assert on.filter([("007", "7"), ("7", "7"), (7, 7.0)]) == [1, 2]
+    print("✓ Join conditions compare without numeric coercion")
+    print("\n🎉 Expression VM Test: PASSED\n")
+
+
+def test_sql_filters(temp_db_path):
+    """WHERE, JOIN and HAVING through SQL"""
+    db_file = temp_db_path
+
+    print("=== Expression VM SQL Test ===\n")
+
+    with SQLDatabase(db_file) as db:
+        db.execute("CREATE TABLE users (id INT, name TEXT, city TEXT)")
+        db.execute("CREATE TABLE orders (id INT, user_id INT, amount INT)")
+        for row in [(1, "Alice", "Oslo"), (2, "Bob", "Rome"), (3, "Carol", "Oslo")]:
+            db.execute(f"INSERT INTO users VALUES {row}")
+        for row in [(1, 1, 50), (2, 1, 70), (3, 2, 20), (4, 3, 90), (5, 3, 10)]:
+            db.execute(f"INSERT INTO orders VALUES {row}")
+
+        result = db.execute("SELECT name FROM users WHERE city = 'Oslo' OR id = 2 ORDER BY name")
+        assert result == [("Alice",), ("Bob",), ("Carol",)]
+        result = db.execute("SELECT name FROM users WHERE id >= '2' AND city != 'Rome'")
+        assert result == [("Carol",)]
+        print("✓ WHERE")
+
+        result = db.execute("""
+            SELECT u.name, o.amount FROM users u
+            INNER JOIN orders o ON u.id = o.user_id AND o.amount > 40
+        """)
+        assert sorted(result) == [("Alice", 50), ("Alice", 70), ("Carol", 90)]
+        print("✓ JOIN ON with a compound condition")
+
+        result = db.execute("""
+            SELECT user_id, SUM(amount) FROM orders
+            GROUP BY user_id HAVING COUNT(*) > 1
+        """)
+        assert sorted(result) == [(1, 120), (3, 100)]
+        result = db.execute("""
+            SELECT user_id FROM orders
+            GROUP BY user_id HAVING SUM(amount) >= 100 AND user_id != 3
+        """)
+        assert result == [(1,)]
+        print("✓ HAVING on selected and unselected aggregates")
+
+        db.execute("UPDATE orders SET amount = 0 WHERE amount < 25")
+        db.execute("DELETE FROM orders WHERE amount = 0")
+        assert len(db.execute("SELECT * FROM orders")) == 3
+
+    print("\n🎉 Expression VM SQL Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+Index Nested Loop Join Test
+Tests JOINs probing the right table's index with batched, sorted lookups
+"""
+
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import SQLDatabase
+
+
+def _nested_loop(db, query):
+    """Result of query with only the nested loop join available"""
+    choose_join = db.executor.planner.choose_join
+    db.executor.planner.choose_join = lambda stmt: None
+    try:
+        return db.execute(query)
+    finally:
+        db.executor.planner.choose_join = choose_join
+
+
+def test_index_nested_loop_join(temp_db_path):
+    """Selective joins probe the right index instead of scanning the table"""
+    db_file = temp_db_path
+
+    print("=== Index Nested Loop Join Test ===\n")
+
+    with SQLDatabase(db_file) as db:
+        db.execute("CREATE TABLE customers (id INT, name TEXT, tier TEXT)")
+        db.execute("CREATE TABLE orders (id INT, customer_id INT, amount INT)")
+        for i in range(300):
+            db.execute(f"INSERT INTO customers VALUES ({i}, 'c{i}', '{['gold', 'basic'][i % 2]}')")
+        for i in range(100):
+            db.execute(f"INSERT INTO orders VALUES ({i}, {(i * 37) % 320}, {i * 5})")
+
+        query = """
+            SELECT o.id, c.name FROM orders o INNER JOIN customers c
+            ON o.customer_id = c.id WHERE o.amount < 40
+        """
+        assert "HashJoin" in db.execute("EXPLAIN " + query)
+
+        db.execute("CREATE INDEX idx_customers_id ON customers (id)")
+        plan = db.execute("EXPLAIN " + query)
+        assert "IndexNestedLoopJoin" in plan and "idx_customers_id" in plan
+        assert "Filter((o.amount < 40))" in plan
+        print("✓ EXPLAIN shows IndexNestedLoopJoin, WHERE on orders applied first")
+
+        result = db.execute(query)
+        assert sorted(result) == [(i, f"c{(i * 37) % 320}") for i in range(8)]
+        assert sorted(result) == sorted(_nested_loop(db, query))
+        print("✓ Same rows as the nested loop join")
+
+        # Left rows sharing a join value, values with no match, residual ON
+        db.execute("INSERT INTO orders VALUES (500, 3, 1)")
+        db.execute("INSERT INTO orders VALUES (501, 3, 2)")
+        db.execute("INSERT INTO orders VALUES (502, 999, 3)")
+        query = """
+            SELECT o.id, c.tier FROM orders o INNER JOIN customers c
+            ON o.customer_id = c.id AND c.tier = 'basic' WHERE o.amount < 5
+        """
+        result = db.execute(query)
+        assert sorted(result) == [(500, "basic"), (501, "basic")]
+        assert sorted(result) == sorted(_nested_loop(db, query))
+        print("✓ Repeated probes, missing keys and residual ON conditions")
+
+        # Rows deleted or updated after indexing
+        db.execute("DELETE FROM customers WHERE id = 3")
+        db.execute("UPDATE customers SET name = 'renamed' WHERE id = 37")
+        result = db.execute(query)
+        assert result == []
+        result = db.execute(
+            "SELECT c.name FROM orders o INNER JOIN customers c ON o.customer_id = c.id WHERE o.id = 1"
+        )
+        assert result == [("renamed",)]
+        print("✓ Deletes and updates are reflected")
+
+    print("\n🎉 Index Nested Loop Join Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Instant Restart Test
+Tests that the database opens before recovery finishes and redoes keys on access
+"""
+
+import os
+import subprocess
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import TransactionalDatabase
+
+
+# Writes, then exits without closing the database (a crash)
+_CRASHING_WRITER = """
+import os, sys
+sys.path[:0] = {path!r}
+from toydb import TransactionalDatabase
+db = TransactionalDatabase({db_file!r})
+for i in range(300):
+    db.insert(f"user:{{i:03d}}", f"name{{i}}")
+for _ in range(4):
+    db.merge("visits", "5", "add")
+db.delete_range("user:100", "user:149")
+db.insert("user:120", "returned")
+txn = db.begin_transaction()
+db.insert_txn(txn, "user:000", "uncommitted")
+os._exit(0)
+"""
+
+# Leaves a transaction open whose writes another commit wrote back to the
+# data file, then crashes
+_CRASHING_LOSER = """
+import os, sys
+sys.path[:0] = {path!r}
+from toydb import TransactionalDatabase
+db = TransactionalDatabase({db_file!r})
+for i in range(100):
+    db.insert(f"acct:{{i:03d}}", str(i))
+txn = db.begin_transaction()
+db.insert_txn(txn, "acct:005", "uncommitted")
+db.insert_txn(txn, "acct:new", "uncommitted")
+db.delete_txn(txn, "acct:007")
+db.delete_range_txn(txn, "acct:050", "acct:059")
+other = db.begin_transaction()
+db.insert_txn(other, "audit", "1")
+db.commit_transaction(other)
+os._exit(0)
+"""
+
+
+def test_instant_restart(temp_db_path):
+    """Reads after a crash are served while keys are still being redone"""
+    db_file = temp_db_path
+
+    print("=== Instant Restart Test ===\n")
+
+    script = _CRASHING_WRITER.format(path=sys.path, db_file=db_file)
+    subprocess.run([sys.executable, "-c", script], check=True)
+
+    with TransactionalDatabase(db_file) as db:
+        pending = db.get_stats()["recovery_pending_keys"]
+        assert pending > 200
+        print(f"✓ Opened with {pending} keys left to redo")
+
+        assert db.get("user:299") == "name299"
+        assert db.get("user:000") == "name0"
+        assert db.get("visits") == "20"
+        rows = db.range_scan("user:095", "user:155")
+        assert [k for k, _ in rows] == ["user:095", "user:096", "user:097", "user:098",
+                                        "user:099", "user:120", "user:150", "user:151",
+                                        "user:152", "user:153", "user:154", "user:155"]
+        assert db.get_stats()["recovery_pending_keys"] < pending
+        print("✓ Keys redone on first access")
+
+        db.finish_recovery()
+        assert db.get_stats()["recovery_pending_keys"] == 0
+        assert len(db.range_scan("user:", "user:~")) == 251
+
+    with TransactionalDatabase(db_file) as db:
+        assert db.get_stats()["recovery_pending_keys"] == 0
+        assert db.get("user:120") == "returned"
+        print("✓ Recovered state survives a clean reopen")
+
+    print("\n🎉 Instant Restart Test: PASSED\n")
+
+
+def test_loser_rollback(temp_db_path):
+    """Uncommitted writes already in the data file are rolled back lazily"""
+    db_file = temp_db_path
+
+    script = _CRASHING_LOSER.format(path=sys.path, db_file=db_file)
+    subprocess.run([sys.executable, "-c", script], check=True)
+
+    with TransactionalDatabase(db_file) as db:
+        assert db.get_stats()["recovery_pending_keys"] > 0
+        assert db.get("acct:005") == "5"
+        with pytest.raises(Exception, match="Key not found"):
+            db.get("acct:new")
+        assert db.get("acct:007") == "7"
+        assert db.get("audit") == "1"
+        rows = db.range_scan("acct:", "acct:~")
+        assert len(rows) == 100 and rows[55] == ("acct:055", "55")
+        print("✓ Open transaction rolled back after the crash")
+
+    with TransactionalDatabase(db_file) as db:
+        assert db.get("acct:005") == "5"
+        assert len(db.range_scan("acct:", "acct:~")) == 100
+        assert db.range_scan("acct:new", "acct:new") == []
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+Leaf Delta Buffer Test
+Tests leaf writes buffered in the delta area: overflow, consolidation and reopen
+"""
+
+import os
+import subprocess
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import IndexedDatabase, TransactionalDatabase
+
+
+# Commits updates that stay in a leaf's delta area, then exits without
+# closing the database (a crash)
+_CRASHING_WRITER = """
+import os, sys
+sys.path[:0] = {path!r}
+from toydb import TransactionalDatabase
+db = TransactionalDatabase({db_file!r})
+for i in range(10):
+    db.insert(f"k{{i:02d}}", "base")
+db.checkpoint()
+txn = db.begin_transaction()
+for i in range(5):
+    db.insert_txn(txn, f"k{{i:02d}}", f"new{{i}}")
+db.commit_transaction(txn)
+os._exit(0)
+"""
+
+
+def test_leaf_delta_overflow(temp_db_path):
+    """Writes past the delta capacity or the page's free space consolidate"""
+    db_file = temp_db_path
+
+    print("=== Leaf Delta Overflow Test ===\n")
+
+    with IndexedDatabase(db_file) as db:
+        # One leaf: the first 8 writes are delta records, the 9th consolidates
+        for i in range(12):
+            db.insert(f"k{i:02d}", f"v{i}")
+        for r in range(1, 21):
+            db.insert("k03", f"r{r}")
+            assert db.get_with_version("k03") == (f"r{r}", r + 1)
+        rows = db.range_scan("k", "l")
+        assert [k for k, _ in rows] == [f"k{i:02d}" for i in range(12)]
+        print("✓ Repeated updates of one key consolidate every 8 writes")
+
+        # Large values: the page fills before the delta area does
+        for i in range(20, 32):
+            db.insert(f"k{i:02d}", chr(ord("a") + i % 26) * 200)
+        for i in range(20, 32):
+            db.insert(f"k{i:02d}", chr(ord("A") + i % 26) * 220)
+        assert all(db.get(f"k{i:02d}") == chr(ord("A") + i % 26) * 220 for i in range(20, 32))
+        print("✓ Page space overflow falls back to a consolidated leaf")
+
+    with IndexedDatabase(db_file) as db:
+        assert db.get_with_version("k03") == ("r20", 21)
+        assert all(db.get(f"k{i:02d}") == chr(ord("A") + i % 26) * 220 for i in range(20, 32))
+        print("✓ Delta records read back after reopen")
+
+    print("\n🎉 Leaf Delta Overflow Test: PASSED\n")
+
+
+def test_leaf_delta_recovery(temp_db_path):
+    """A leaf flushed with pending delta records recovers after a crash"""
+    db_file = temp_db_path
+
+    print("=== Leaf Delta Recovery Test ===\n")
+
+    script = _CRASHING_WRITER.format(path=sys.path, db_file=db_file)
+    subprocess.run([sys.executable, "-c", script], check=True)
+
+    with TransactionalDatabase(db_file) as db:
+        db.finish_recovery()
+        for i in range(10):
+            assert db.get(f"k{i:02d}") == (f"new{i}" if i < 5 else "base")
+        print("✓ Committed delta records survive the crash")
+
+    print("\n🎉 Leaf Delta Recovery Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
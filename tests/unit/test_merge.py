@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+Merge Operator Test
+Tests read-modify-write via registered merge operators
+"""
+
+import os
+import sys
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import IndexedDatabase, TransactionalDatabase
+
+
+def test_builtin_merge_operators(temp_db_path):
+    """add / max / append apply in place and return the new value"""
+    db_file = temp_db_path
+
+    with TransactionalDatabase(db_file) as db:
+        assert db.merge("counter", "5") == "5"
+        assert db.merge("counter", "-2", "add") == "3"
+        assert db.get("counter") == "3"
+
+        assert db.merge("high", "10", "max") == "10"
+        assert db.merge("high", "4", "max") == "10"
+
+        assert db.merge("events", "login", "append") == "login"
+        assert db.merge("events", "logout", "append") == "login,logout"
+
+        # Rejected operand leaves the value untouched
+        with pytest.raises(Exception):
+            db.merge("counter", "abc", "add")
+        assert db.get("counter") == "3"
+        with pytest.raises(OverflowError):
+            db.merge("counter", str(2**63 - 1), "add")
+        assert db.get("counter") == "3"
+
+        # ... also while a snapshot needs versions: the auto transaction
+        # is aborted, not left holding the key
+        reader = db.begin_transaction(read_only=True, isolation="snapshot")
+        with pytest.raises(Exception):
+            db.merge("counter", "abc", "add")
+        assert db.merge("counter", "1", "add") == "4"
+        assert db.get_txn(reader, "counter") == "3"
+        db.commit_transaction(reader)
+
+        with pytest.raises(Exception, match="Unknown merge operator"):
+            db.merge("counter", "1", "no_such_op")
+
+    with TransactionalDatabase(db_file) as db:
+        assert db.get("counter") == "4"
+
+
+def test_user_defined_merge_operator(temp_db_path):
+    """User-defined operators work in both engines and survive reopen"""
+    db_file = temp_db_path
+
+    def set_union(existing, operand):
+        items = set(existing.split(";")) if existing else set()
+        items.add(operand)
+        return ";".join(sorted(items))
+
+    with TransactionalDatabase(db_file, merge_operators={"union": set_union}) as db:
+        db.merge("tags", "b", "union")
+        db.merge("tags", "a", "union")
+        db.merge("tags", "b", "union")
+        assert db.get("tags") == "a;b"
+
+        txn = db.begin_transaction()
+        db.merge_txn(txn, "tags", "c", "union")
+        db.commit_transaction(txn)
+
+    with TransactionalDatabase(db_file, merge_operators={"union": set_union}) as db:
+        assert db.get("tags") == "a;b;c"
+
+    db_file = os.path.join(os.path.dirname(temp_db_path), "indexed.db")
+
+    with IndexedDatabase(db_file) as db:
+        db.register_merge_operator("union", set_union)
+        db.merge("tags", "x", "union")
+        assert db.merge("tags", "y", "union") == "x;y"
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
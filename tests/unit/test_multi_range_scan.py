@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+Multi-Range Scan Test
+Tests multi_range_scan and index scans for IN-lists and OR-ed ranges
+"""
+
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import IndexedDatabase, SQLDatabase
+
+
+def test_multi_range_scan(temp_db_path):
+    """Ranges may be unsorted and overlap; each key is returned once, in order"""
+    db_file = temp_db_path
+
+    print("=== Multi-Range Scan Test ===\n")
+
+    with IndexedDatabase(db_file) as db:
+        for i in range(0, 2000, 2):
+            db.insert(f"k{i:05d}", f"v{i}")
+
+        ranges = [("k01500", "k01504"), ("k00010", "k00010"), ("k00011", "k00011"),
+                  ("k00100", "k00120"), ("k00110", "k00130"), ("k09000", "k09999")]
+        result = db.multi_range_scan(ranges)
+
+        expected = [10] + list(range(100, 131, 2)) + [1500, 1502, 1504]
+        assert [k for k, _ in result] == [f"k{i:05d}" for i in expected]
+        assert result[0] == ("k00010", "v10")
+        print(f"✓ {len(ranges)} ranges -> {len(result)} keys in order")
+
+        # 500 point lookups in one pass agree with range_scan per key
+        keys = [f"k{i:05d}" for i in range(1999, -1, -4)]
+        result = db.multi_range_scan([(k, k) for k in keys])
+        assert result == sorted(r for k in keys for r in db.range_scan(k, k))
+        assert db.multi_range_scan([]) == []
+        assert db.multi_range_scan([("k2", "k1")]) == []
+        print("✓ 500-key IN-list matches individual lookups")
+
+    print("\n🎉 Multi-Range Scan Test: PASSED\n")
+
+
+def test_in_list_and_or_ranges(temp_db_path):
+    """IN-lists and OR-ed ranges on an indexed column use one index scan"""
+    db_file = temp_db_path
+
+    print("=== IN / OR Index Scan Test ===\n")
+
+    with SQLDatabase(db_file) as db:
+        db.execute("CREATE TABLE orders (id INT, region TEXT, amount INT)")
+        for i in range(200):
+            region = ["north", "south", "east", "west"][i % 4]
+            db.execute(f"INSERT INTO orders VALUES ({i}, '{region}', {i * 10})")
+        db.execute("CREATE INDEX idx_amount ON orders (amount)")
+        db.execute("CREATE INDEX idx_region_amount ON orders (region, amount)")
+
+        query = "SELECT id FROM orders WHERE amount IN (50, 500, 20, 7, 1990)"
+        assert "IndexScan(orders, idx_amount)" in db.execute("EXPLAIN " + query)
+        assert sorted(db.execute(query)) == [(2,), (5,), (50,), (199,)]
+        print("✓ IN-list uses the index")
+
+        query = "SELECT id FROM orders WHERE amount < 30 OR amount = 1000 OR amount >= 1960 AND amount <= 1975"
+        assert "IndexScan(orders, idx_amount)" in db.execute("EXPLAIN " + query)
+        assert sorted(db.execute(query)) == [(0,), (1,), (2,), (100,), (196,), (197,)]
+        print("✓ OR-ed ranges use the index")
+
+        # Equality prefix plus IN on the next column keeps index order
+        query = ("SELECT id FROM orders WHERE region = 'south' AND amount IN (1850, 90, 10, 20) "
+                 "ORDER BY region, amount LIMIT 2")
+        plan = db.execute("EXPLAIN " + query)
+        assert "idx_region_amount" in plan and "Sort(" not in plan
+        assert db.execute(query) == [(1,), (9,)]
+
+        # Plain bounds clip the IN-list; strict bounds are re-checked
+        query = "SELECT id FROM orders WHERE amount IN (10, 20, 30, 40) AND amount > 20"
+        assert sorted(db.execute(query)) == [(3,), (4,)]
+        assert db.execute("SELECT id FROM orders WHERE amount IN (10) AND amount > 20") == []
+        assert db.execute("SELECT id FROM orders WHERE id IN (3, 4) AND region IN ('west')") == [(3,)]
+        print("✓ IN combines with equality prefixes and range bounds")
+
+        # Mixed columns in an OR cannot use one index
+        query = "SELECT id FROM orders WHERE amount = 10 OR id = 5"
+        assert "TableScan" in db.execute("EXPLAIN " + query)
+        assert sorted(db.execute(query)) == [(1,), (5,)]
+        print("✓ Non-indexable predicates fall back to a table scan")
+
+    print("\n🎉 IN / OR Index Scan Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""
+Multi-way Join Test
+Tests queries joining several tables, reordered by the planner
+"""
+
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import SQLDatabase
+
+
+def _written_order(db, query):
+    """Result of query joined by nested loops in written order"""
+    choose_join = db.executor.planner.choose_join
+    db.executor.planner.choose_join = lambda stmt: None
+    try:
+        return db.execute(query)
+    finally:
+        db.executor.planner.choose_join = choose_join
+
+
+def test_multi_way_join(temp_db_path):
+    """Joins of three and four tables match the written-order nested loops"""
+    db_file = temp_db_path
+
+    print("=== Multi-way Join Test ===\n")
+
+    with SQLDatabase(db_file) as db:
+        db.execute("CREATE TABLE regions (id INT, name TEXT)")
+        db.execute("CREATE TABLE customers (id INT, name TEXT, region_id INT)")
+        db.execute("CREATE TABLE products (id INT, name TEXT, price INT)")
+        db.execute("CREATE TABLE orders (id INT, customer_id INT, product_id INT, qty INT)")
+        for i in range(4):
+            db.execute(f"INSERT INTO regions VALUES ({i}, 'r{i}')")
+        for i in range(50):
+            db.execute(f"INSERT INTO customers VALUES ({i}, 'c{i}', {i % 5})")  # Region 4 is missing
+        for i in range(20):
+            db.execute(f"INSERT INTO products VALUES ({i}, 'p{i}', {i * 3})")
+        for i in range(150):
+            db.execute(f"INSERT INTO orders VALUES ({i}, {(i * 7) % 55}, {i % 20}, {i % 4})")
+
+        query = """
+            SELECT o.id, c.name, p.name FROM orders o
+            INNER JOIN customers c ON o.customer_id = c.id
+            INNER JOIN products p ON o.product_id = p.id
+        """
+        plan = db.execute("EXPLAIN " + query)
+        assert plan.count("HashJoin") == 2
+        result = db.execute(query)
+        assert len(result) == 150 - len([i for i in range(150) if (i * 7) % 55 >= 50])
+        assert sorted(result) == sorted(_written_order(db, query))
+        print("✓ Three tables hash joined, same rows as nested loops")
+
+        # Four tables, WHERE conjuncts applied to their table before joining
+        query = """
+            SELECT r.name, c.name, p.name, o.qty FROM regions r
+            INNER JOIN customers c ON c.region_id = r.id
+            INNER JOIN orders o ON o.customer_id = c.id
+            INNER JOIN products p ON p.id = o.product_id AND p.price > 30
+            WHERE o.qty > 1 AND r.name != 'r0'
+        """
+        plan = db.execute("EXPLAIN " + query)
+        assert "Filter((o.qty > 1))" in plan and "Filter((r.name != 'r0'))" in plan
+        result = db.execute(query)
+        assert result and sorted(result) == sorted(_written_order(db, query))
+        assert all(qty > 1 and region != "r0" for region, _, _, qty in result)
+        print("✓ Four tables with pushed-down filters")
+
+        # Written order starting with a cross product: the planner joins
+        # through orders instead
+        query = """
+            SELECT c.id, p.id FROM customers c
+            INNER JOIN products p ON p.price >= 0
+            INNER JOIN orders o ON o.customer_id = c.id AND o.product_id = p.id
+        """
+        assert "Join()" not in db.execute("EXPLAIN " + query)
+        result = db.execute(query)
+        assert sorted(result) == sorted(_written_order(db, query))
+        print("✓ Cross products avoided")
+
+        # Selective customers probe the orders index
+        db.execute("CREATE INDEX idx_customers_id ON customers (id)")
+        db.execute("CREATE INDEX idx_orders_customer ON orders (customer_id)")
+        query = """
+            SELECT c.name, p.name FROM customers c
+            INNER JOIN orders o ON o.customer_id = c.id
+            INNER JOIN products p ON o.product_id = p.id
+            WHERE c.region_id = 1
+        """
+        plan = db.execute("EXPLAIN " + query)
+        assert "IndexNestedLoopJoin((o.customer_id = c.id))" in plan
+        result = db.execute(query)
+        assert result and sorted(result) == sorted(_written_order(db, query))
+        print("✓ Index nested loop join inside a larger plan")
+
+        # A chain longer than the exhaustive search handles
+        db.execute("CREATE TABLE chain (id INT, next INT)")
+        for i in range(5):
+            db.execute(f"INSERT INTO chain VALUES ({i}, {(i + 1) % 5})")
+        joins = " ".join(f"INNER JOIN chain t{k} ON t{k}.id = t{k - 1}.next" for k in range(1, 10))
+        query = f"SELECT t0.id, t9.id FROM chain t0 {joins}"
+        result = db.execute(query)
+        assert sorted(result) == [(i, (i + 9) % 5) for i in range(5)]
+        print("✓ Ten tables joined in written order")
+
+        # ON sees only the tables joined so far
+        try:
+            db.execute("""
+                SELECT * FROM orders o INNER JOIN customers c ON o.customer_id = p.id
+                INNER JOIN products p ON o.product_id = p.id
+            """)
+            assert False, "Expected a column error"
+        except RuntimeError as e:
+            assert "Column not found in JOIN condition: p.id" in str(e)
+        try:
+            db.execute("""
+                SELECT * FROM orders o INNER JOIN customers c ON o.customer_id = c.id
+                INNER JOIN products p ON product_id = id
+            """)
+            assert False, "Expected an ambiguity error"
+        except RuntimeError as e:
+            assert "Ambiguous column in JOIN condition: id" in str(e)
+        print("✓ JOIN ON scoping and ambiguity errors")
+
+    print("\n🎉 Multi-way Join Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""
+Posting List Test
+Tests deduplicated, delta-encoded row ID lists in non-unique indexes
+"""
+
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import SQLDatabase
+from toydb._storage_engine import encode_postings, decode_postings
+
+
+def test_posting_list_encoding():
+    """Row IDs round-trip sorted and deduplicated"""
+    ids = [1700000000000000 + i * 997 for i in range(100)] + [5, 5, 2**64 - 1]
+    encoded = encode_postings(ids)
+    assert decode_postings(encoded) == sorted(set(ids))
+    # Nearby IDs cost a few bytes each, not a full key
+    assert len(encode_postings(ids[:100])) < 100 * 4
+    print("✓ Posting list round-trip")
+
+
+def test_low_cardinality_index(temp_db_path):
+    """One chunked posting list per distinct value instead of one entry per row"""
+    db_file = temp_db_path
+
+    print("=== Posting List Test ===\n")
+
+    with SQLDatabase(db_file) as db:
+        db.execute("CREATE TABLE orders (id INT, status TEXT)")
+        statuses = ["new", "paid", "shipped"]
+        for i in range(300):
+            db.execute(f"INSERT INTO orders VALUES ({i}, '{statuses[i % 3]}')")
+
+        # Bulk build from existing rows, then incremental maintenance
+        db.execute("CREATE INDEX idx_status ON orders (status)")
+        for i in range(300, 600):
+            db.execute(f"INSERT INTO orders VALUES ({i}, '{statuses[i % 3]}')")
+
+        entries = db.engine.range_scan("__index__:idx_status:", "__index__:idx_status:~")
+        assert len(entries) <= 600 // 10
+        assert all(len(value) <= 192 for _, value in entries)
+        print(f"✓ 600 rows indexed in {len(entries)} posting entries")
+
+        result = db.execute("SELECT id FROM orders WHERE status = 'paid'")
+        assert sorted(r[0] for r in result) == list(range(1, 600, 3))
+
+        # DELETE / UPDATE remove and move row IDs
+        db.execute("DELETE FROM orders WHERE id = 1")
+        db.execute("UPDATE orders SET status = 'new' WHERE id = 4")
+        result = db.execute("SELECT id FROM orders WHERE status = 'paid'")
+        assert sorted(r[0] for r in result) == list(range(7, 600, 3))
+        result = db.execute("SELECT id FROM orders WHERE status = 'new'")
+        assert len(result) == 201 and 4 in [r[0] for r in result]
+
+        result = db.execute("SELECT status FROM orders ORDER BY status LIMIT 3")
+        assert result == [("new",)] * 3
+        print("✓ Lookups, DELETE and UPDATE through posting lists")
+
+    print("\n🎉 Posting List Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
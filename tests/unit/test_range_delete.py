@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+Range Delete Test
+Tests deleting a key range in one call (whole subtrees are dropped)
+"""
+
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import IndexedDatabase, TransactionalDatabase, SQLDatabase
+
+
+def test_range_delete(temp_db_path):
+    """delete_range removes exactly [start, end] and survives reopen"""
+    db_file = temp_db_path
+
+    print("=== Range Delete Test ===\n")
+
+    with TransactionalDatabase(db_file) as db:
+        for i in range(1000):
+            db.insert(f"k{i:05d}", f"v{i}")
+
+        db.delete_range("k00100", "k00899")
+        remaining = db.range_scan("k", "k~")
+        assert len(remaining) == 200
+        assert remaining[99][0] == "k00099"
+        assert remaining[100][0] == "k00900"
+        print("✓ Deleted 800 keys in one call")
+
+        txn = db.begin_transaction()
+        db.delete_range_txn(txn, "k00000", "k00009")
+        db.commit_transaction(txn)
+
+    # Reopen: WAL replay plus a multi-level tree
+    with TransactionalDatabase(db_file) as db:
+        assert len(db.range_scan("k", "k~")) == 190
+        assert db.get("k00999") == "v999"
+        print("✓ Range delete persisted")
+
+    db_file = os.path.join(os.path.dirname(temp_db_path), "indexed.db")
+
+    with IndexedDatabase(db_file) as db:
+        for i in range(500):
+            db.insert(f"k{i:05d}", "v")
+        db.delete_range("k00000", "k00499")
+        assert db.range_scan("k", "k~") == []
+
+        # Freed pages are reused
+        for i in range(500):
+            db.insert(f"k{i:05d}", "w")
+        assert len(db.range_scan("k", "k~")) == 500
+        db.delete_range("k00000", "k00499")
+    size = os.path.getsize(db_file)
+
+    # ... also after a restart: the free list is rebuilt from the file
+    with IndexedDatabase(db_file) as db:
+        for i in range(500):
+            db.insert(f"k{i:05d}", "x")
+    assert os.path.getsize(db_file) <= size
+    with IndexedDatabase(db_file) as db:
+        assert [v for _, v in db.range_scan("k", "k~")] == ["x"] * 500
+    print("✓ Freed pages reused, before and after reopen")
+
+    print("\n🎉 Range Delete Test: PASSED\n")
+
+
+def test_drop_table_purges_rows(temp_db_path):
+    """DROP TABLE removes the table's rows, not just its catalog entries"""
+    db_file = temp_db_path
+
+    with SQLDatabase(db_file) as db:
+        db.execute("CREATE TABLE t (id INT, name TEXT)")
+        db.execute("CREATE TABLE keep (id INT)")
+        for i in range(50):
+            db.execute(f"INSERT INTO t VALUES ({i}, 'n{i}')")
+        db.execute("INSERT INTO keep VALUES (1)")
+
+        db.execute("DROP TABLE t")
+        assert db.engine.range_scan("t:", "t:~") == []
+        assert len(db.execute("SELECT * FROM keep")) == 1
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+Read-Only Transaction Test
+Tests begin_transaction(read_only=True): no WAL traffic, writes rejected
+"""
+
+import os
+import sys
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import TransactionalDatabase
+
+
+def test_read_only_transaction(temp_db_path):
+    """Read-only transactions read data without writing to the WAL"""
+    db_file = temp_db_path
+
+    print("=== Read-Only Transaction Test ===\n")
+
+    with TransactionalDatabase(db_file) as db:
+        txn = db.begin_transaction()
+        for i in range(50):
+            db.insert_txn(txn, f"acct:{i:03d}", str(i * 10))
+        db.commit_transaction(txn)
+
+        last_lsn = db.get_stats()["last_lsn"]
+        wal_size = os.path.getsize(db_file + ".wal")
+
+        for _ in range(100):
+            txn = db.begin_transaction(read_only=True)
+            assert db.get("acct:007") == "70"
+            assert len(db.range_scan("acct:", "acct:~")) == 50
+            db.commit_transaction(txn)
+
+        assert db.get_stats()["last_lsn"] == last_lsn
+        assert os.path.getsize(db_file + ".wal") == wal_size
+        print("✓ 100 read-only transactions wrote nothing to the WAL")
+
+        # Writes inside a read-only transaction are rejected
+        txn = db.begin_transaction(read_only=True)
+        with pytest.raises(Exception, match="read-only"):
+            db.insert_txn(txn, "acct:999", "1")
+        with pytest.raises(Exception, match="read-only"):
+            db.delete_txn(txn, "acct:001")
+        with pytest.raises(Exception, match="read-only"):
+            db.merge_txn(txn, "acct:002", "5", "add")
+        db.abort_transaction(txn)
+        assert db.get("acct:001") == "10"
+        assert len(db.range_scan("acct:", "acct:~")) == 50
+        print("✓ Writes in a read-only transaction are rejected")
+
+        # Read-only transactions read a snapshot, even without an isolation
+        txn = db.begin_transaction(read_only=True)
+        assert db.get_txn(txn, "acct:003") == "30"
+        db.insert("acct:003", "31")
+        db.delete("acct:004")
+        assert db.get_txn(txn, "acct:003") == "30"
+        assert db.get_txn(txn, "acct:004") == "40"
+        assert len(db.range_scan_txn(txn, "acct:", "acct:~")) == 50
+        db.commit_transaction(txn)
+        assert db.get("acct:003") == "31"
+        print("✓ Read-only transactions read a snapshot by default")
+
+        # Read-write transactions are unaffected
+        txn = db.begin_transaction()
+        db.insert_txn(txn, "acct:050", "500")
+        db.commit_transaction(txn)
+        assert db.get_stats()["last_lsn"] > last_lsn
+
+    with TransactionalDatabase(db_file) as db:
+        assert db.get("acct:050") == "500"
+        print("✓ Read-write transactions still logged and recovered")
+
+    print("\n🎉 Read-Only Transaction Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""
+Query Result Cache Test
+Tests SELECT results cached per table version, under a memory budget
+"""
+
+import os
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import SQLDatabase
+from toydb.result_cache import ResultCache, result_size
+
+
+def test_result_cache(temp_db_path):
+    """Repeated SELECTs hit the cache until a write touches their tables"""
+    db_file = temp_db_path
+
+    print("=== Query Result Cache Test ===\n")
+
+    with SQLDatabase(db_file, result_cache_bytes=1 << 20) as db:
+        db.execute("CREATE TABLE orders (id INT, region TEXT, amount INT)")
+        db.execute("CREATE TABLE regions (name TEXT, manager TEXT)")
+        for i in range(30):
+            db.execute(f"INSERT INTO orders VALUES ({i}, 'r{i % 3}', {i * 10})")
+        for i in range(3):
+            db.execute(f"INSERT INTO regions VALUES ('r{i}', 'm{i}')")
+
+        query = "SELECT region, SUM(amount) FROM orders GROUP BY region"
+        first = db.execute(query)
+        assert db.get_stats()["result_cache_misses"] == 1
+        # Spacing and keyword case are normalized away
+        assert db.execute("select region,  SUM(amount)\n FROM orders group by region") == first
+        assert db.get_stats()["result_cache_hits"] == 1
+        print("✓ Normalized repeat of a query is a hit")
+
+        # Different literals are different queries
+        assert db.execute("SELECT id FROM orders WHERE amount > 250") == [(26,), (27,), (28,), (29,)]
+        assert db.execute("SELECT id FROM orders WHERE amount > 270") == [(28,), (29,)]
+        assert db.get_stats()["result_cache_hits"] == 1
+
+        # Writes to another table leave the entry valid
+        db.execute("UPDATE regions SET manager = 'x' WHERE name = 'r0'")
+        db.execute(query)
+        assert db.get_stats()["result_cache_hits"] == 2
+
+        # Every kind of write to the table invalidates it
+        writes = [
+            ("INSERT INTO orders VALUES (100, 'r0', 5)", 5),
+            ("UPDATE orders SET amount = 0 WHERE id = 100", -5),
+            ("DELETE FROM orders WHERE id = 0", 0),
+        ]
+        expected = dict(first)
+        for sql, delta in writes:
+            db.execute(sql)
+            expected["r0"] += delta
+            assert dict(db.execute(query)) == expected
+        assert db.get_stats()["result_cache_hits"] == 2
+        print("✓ INSERT / UPDATE / DELETE invalidate results of their table only")
+
+        # Joins are tagged with every table they read
+        join = "SELECT o.id, r.manager FROM orders o INNER JOIN regions r ON o.region = r.name WHERE o.id < 3"
+        assert sorted(db.execute(join)) == [(1, "m1"), (2, "m2")]
+        db.execute("UPDATE regions SET manager = 'new' WHERE name = 'r1'")
+        assert sorted(db.execute(join)) == [(1, "new"), (2, "m2")]
+        print("✓ Joins invalidated by either table")
+
+        # Callers may modify returned lists
+        rows = db.execute(query)
+        rows.clear()
+        assert db.execute(query)
+
+        # Dropping and re-creating a table
+        db.execute("DROP TABLE regions")
+        db.execute("CREATE TABLE regions (name TEXT, manager TEXT)")
+        assert db.execute("SELECT * FROM regions") == []
+        print("✓ DDL invalidates too")
+
+    print("\n🎉 Query Result Cache Test: PASSED\n")
+
+
+def test_result_cache_budget():
+    """Least recently used results are evicted beyond the byte budget"""
+    print("=== Query Result Cache Budget Test ===\n")
+
+    rows = [(i, f"row {i}") for i in range(10)]
+    cache = ResultCache(3 * result_size(rows))
+    for n in range(4):
+        cache.put(f"q{n}", {"t": 0}, rows)
+    assert cache.get("q0") is None and cache.get("q3") == rows
+    assert cache.stats()["result_cache_evictions"] >= 1
+    assert cache.stats()["result_cache_bytes"] <= cache.max_bytes
+    print("✓ Oldest entry evicted")
+
+    # Too large for the budget: never cached
+    cache.put("big", {"t": 0}, rows * 10)
+    assert cache.get("big") is None
+
+    # A write finished while the query ran: the result is not stored
+    tags = cache.versions(["t"])
+    cache.bump("t")
+    cache.put("late", tags, rows)
+    assert cache.get("late") is None
+    assert cache.get("q3") is None  # Tagged with the old version
+    print("✓ Oversized and stale results are not served")
+    print("\n🎉 Query Result Cache Budget Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
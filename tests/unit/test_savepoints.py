@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+Savepoint Test
+Tests savepoint / rollback_to: partial rollback inside a transaction
+"""
+
+import os
+import sys
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import TransactionalDatabase
+
+
+def test_batch_with_savepoints(temp_db_path):
+    """A failed item is rolled back alone; the rest of the batch commits"""
+    db_file = temp_db_path
+
+    print("=== Savepoint Test ===\n")
+
+    with TransactionalDatabase(db_file) as db:
+        db.insert("stock:widget", "10")
+        db.insert("stock:gadget", "3")
+
+        txn = db.begin_transaction()
+        failed = []
+        for item in range(20):
+            sp = db.savepoint(txn)
+            try:
+                db.insert_txn(txn, f"order:{item:03d}", "widget")
+                db.merge_txn(txn, "stock:widget", "-1", "add")
+                if item % 7 == 3:
+                    db.delete_txn(txn, "stock:gadget")
+                    db.insert_txn(txn, f"audit:{item:03d}", "gadget")
+                    raise ValueError("item rejected")
+            except ValueError:
+                db.rollback_to(txn, sp)
+                failed.append(item)
+        db.commit_transaction(txn)
+
+        assert failed == [3, 10, 17]
+        assert db.get("stock:widget") == str(10 - 17)
+        assert db.get("stock:gadget") == "3"
+        assert len(db.range_scan("order:", "order:~")) == 17
+        assert db.range_scan("audit:", "audit:~") == []
+        print(f"✓ {len(failed)} failed items rolled back, 17 committed")
+
+    # Compensating records make recovery end at the same state
+    with TransactionalDatabase(db_file) as db:
+        assert db.get("stock:widget") == "-7"
+        assert db.get("stock:gadget") == "3"
+        assert len(db.range_scan("order:", "order:~")) == 17
+        assert db.range_scan("audit:", "audit:~") == []
+        print("✓ Partial rollbacks survive recovery")
+
+    print("\n🎉 Savepoint Test: PASSED\n")
+
+
+def test_abort_restores_before_images(temp_db_path):
+    """Abort undoes updates and deletes, not just inserts"""
+    db_file = temp_db_path
+
+    with TransactionalDatabase(db_file) as db:
+        db.insert("a", "1")
+        db.insert("b", "2")
+
+        txn = db.begin_transaction()
+        db.insert_txn(txn, "a", "100")
+        db.delete_txn(txn, "b")
+        db.insert_txn(txn, "c", "3")
+        sp = db.savepoint(txn)
+        db.insert_txn(txn, "a", "200")
+        db.rollback_to(txn, sp)
+        assert db.get("a") == "100"
+        db.abort_transaction(txn)
+
+        assert db.get("a") == "1"
+        assert db.get("b") == "2"
+        with pytest.raises(Exception, match="Key not found"):
+            db.get("c")
+        print("✓ Abort restores before-images")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
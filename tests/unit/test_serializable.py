@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""
+Isolation Level Test
+Tests snapshot reads and serializable snapshot isolation (write skew)
+"""
+
+import os
+import sys
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import TransactionalDatabase
+
+
+def test_snapshot_reads(temp_db_path):
+    """A snapshot transaction does not see later or uncommitted writes"""
+    db_file = temp_db_path
+
+    print("=== Snapshot Read Test ===\n")
+
+    with TransactionalDatabase(db_file) as db:
+        db.insert("acct:a", "100")
+        db.insert("acct:b", "100")
+
+        reader = db.begin_transaction(read_only=True, isolation="snapshot")
+        db.insert("acct:a", "50")
+        writer = db.begin_transaction()
+        db.insert_txn(writer, "acct:b", "150")
+        db.insert_txn(writer, "acct:c", "1")
+
+        assert db.get_txn(reader, "acct:a") == "100"
+        assert db.get_txn(reader, "acct:b") == "100"
+        with pytest.raises(Exception, match="Key not found"):
+            db.get_txn(reader, "acct:c")
+        db.commit_transaction(writer)
+        assert db.range_scan_txn(reader, "acct:", "acct:~") == [("acct:a", "100"), ("acct:b", "100")]
+        db.commit_transaction(reader)
+        print("✓ Snapshot ignores commits made after begin")
+
+        assert db.get("acct:b") == "150"
+        assert len(db.range_scan("acct:", "acct:~")) == 3
+
+        # First updater wins
+        t1 = db.begin_transaction(isolation="snapshot")
+        t2 = db.begin_transaction(isolation="snapshot")
+        db.insert_txn(t1, "acct:a", "1")
+        with pytest.raises(Exception, match="Write conflict"):
+            db.insert_txn(t2, "acct:a", "2")
+        db.commit_transaction(t1)
+        db.abort_transaction(t2)
+        assert db.get("acct:a") == "1"
+        print("✓ Concurrent writes of one key conflict")
+
+        # A failed auto-commit delete leaves nothing behind to conflict with
+        reader = db.begin_transaction(read_only=True, isolation="snapshot")
+        with pytest.raises(Exception, match="Key not found"):
+            db.delete("acct:missing")
+        writer = db.begin_transaction(isolation="snapshot")
+        db.insert_txn(writer, "acct:missing", "1")
+        db.commit_transaction(writer)
+        db.delete("acct:missing")
+        db.commit_transaction(reader)
+        print("✓ Deleting a missing key does not hold it")
+
+    print("\n🎉 Snapshot Read Test: PASSED\n")
+
+
+def _on_call(db, txn):
+    return sum(1 for _, v in db.range_scan_txn(txn, "oncall:", "oncall:~") if v == "1")
+
+
+def test_write_skew(temp_db_path):
+    """Serializable transactions cannot both take the last doctor off call"""
+    db_file = temp_db_path
+
+    print("=== Serializable Isolation Test ===\n")
+
+    with TransactionalDatabase(db_file) as db:
+        # Snapshot isolation allows write skew
+        db.insert("oncall:alice", "1")
+        db.insert("oncall:bob", "1")
+        t1 = db.begin_transaction(isolation="snapshot")
+        t2 = db.begin_transaction(isolation="snapshot")
+        assert _on_call(db, t1) == 2 and _on_call(db, t2) == 2
+        db.insert_txn(t1, "oncall:alice", "0")
+        db.insert_txn(t2, "oncall:bob", "0")
+        db.commit_transaction(t1)
+        db.commit_transaction(t2)
+        assert db.range_scan("oncall:", "oncall:~") == [("oncall:alice", "0"), ("oncall:bob", "0")]
+        print("✓ Snapshot isolation: write skew leaves nobody on call")
+
+        # Serializable detects the rw-antidependency cycle
+        db.insert("oncall:alice", "1")
+        db.insert("oncall:bob", "1")
+        t1 = db.begin_transaction(isolation="serializable")
+        t2 = db.begin_transaction(isolation="serializable")
+        assert _on_call(db, t1) == 2 and _on_call(db, t2) == 2
+        db.insert_txn(t1, "oncall:alice", "0")
+        db.insert_txn(t2, "oncall:bob", "0")
+
+        failures = 0
+        for txn in (t1, t2):
+            try:
+                db.commit_transaction(txn)
+            except RuntimeError as e:
+                assert "Serialization failure" in str(e)
+                failures += 1
+        assert failures == 1
+        on_call = [k for k, v in db.range_scan("oncall:", "oncall:~") if v == "1"]
+        assert len(on_call) == 1
+        print(f"✓ Serializable: one transaction aborted, {on_call[0]} still on call")
+
+        # Transactions touching disjoint data commit normally
+        t1 = db.begin_transaction(isolation="serializable")
+        t2 = db.begin_transaction(isolation="serializable")
+        db.get_txn(t1, "oncall:alice")
+        db.insert_txn(t1, "shift:1", "alice")
+        db.get_txn(t2, "oncall:bob")
+        db.insert_txn(t2, "shift:2", "bob")
+        db.commit_transaction(t1)
+        db.commit_transaction(t2)
+        assert len(db.range_scan("shift:", "shift:~")) == 2
+        print("✓ Non-conflicting serializable transactions commit")
+
+    print("\n🎉 Serializable Isolation Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
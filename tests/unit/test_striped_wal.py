@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+Striped WAL Test
+Tests log records from several threads merged in LSN order and recovered
+"""
+
+import os
+import subprocess
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import TransactionalDatabase
+
+
+# Four threads interleave transactions and auto-commit overwrites of one
+# shared key, then the process exits without closing the database (a crash)
+_CRASHING_WRITERS = """
+import os, sys, threading
+sys.path[:0] = {path!r}
+from toydb import TransactionalDatabase
+db = TransactionalDatabase({db_file!r})
+db.engine.register_change_consumer("audit", 0)
+
+def writer(t):
+    for i in range(100):
+        txn = db.begin_transaction()
+        db.insert_txn(txn, f"t{{t}}:{{i:03d}}", str(i))
+        db.insert("last", f"{{t}}:{{i}}")
+        db.merge_txn(txn, "total", "1", "add")
+        db.commit_transaction(txn)
+
+threads = [threading.Thread(target=writer, args=(t,)) for t in range(4)]
+for thread in threads:
+    thread.start()
+for thread in threads:
+    thread.join()
+print(db.get("last"))
+sys.stdout.flush()
+os._exit(0)
+"""
+
+
+def test_striped_wal_recovery(temp_db_path):
+    """Records buffered by different threads are recovered in LSN order"""
+    db_file = temp_db_path
+
+    print("=== Striped WAL Test ===\n")
+
+    script = _CRASHING_WRITERS.format(path=sys.path, db_file=db_file)
+    out = subprocess.run([sys.executable, "-c", script], check=True,
+                         capture_output=True, text=True).stdout
+    last = out.split()[-1]
+
+    with TransactionalDatabase(db_file) as db:
+        # The shared key holds the write with the highest LSN
+        assert db.get("last") == last
+        assert db.get("total") == "400"
+        for t in range(4):
+            assert len(db.range_scan(f"t{t}:", f"t{t}:~")) == 100
+        print(f"✓ Recovered 400 transactions from 4 threads, last = {last}")
+
+        # The log on disk is in LSN order, commits included
+        changes = list(db.changes("audit", timeout=0.2))
+        assert len(changes) == 1200
+        lsns = [c["lsn"] for c in changes]
+        commits = [c["commit_lsn"] for c in changes]
+        assert commits == sorted(commits)
+        assert len(set(lsns)) == len(lsns)
+        assert [c["value"] for c in changes if c["key"] == "last"][-1] == last
+        print("✓ Change stream read the merged log in order")
+
+    print("\n🎉 Striped WAL Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
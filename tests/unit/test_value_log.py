@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+Value Log Test
+Tests key-value separation: large values in the value log, pointers in leaves
+"""
+
+import os
+import subprocess
+import sys
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import IndexedDatabase, TransactionalDatabase, SQLDatabase
+
+
+# Commits a value too long for a two-byte length field, then exits
+# without closing the database (a crash)
+_CRASHING_WRITER = """
+import os, sys
+sys.path[:0] = {path!r}
+from toydb import TransactionalDatabase
+db = TransactionalDatabase({db_file!r}, value_log_threshold=128)
+txn = db.begin_transaction()
+db.insert_txn(txn, "huge", "h" * 100000)
+db.commit_transaction(txn)
+txn = db.begin_transaction()
+db.insert_txn(txn, "after", "1")
+print(db.commit_transaction(txn))
+sys.stdout.flush()
+os._exit(0)
+"""
+
+
+def test_value_log_roundtrip(temp_db_path):
+    """Large values round-trip through the value log, small ones stay inline"""
+    db_file = temp_db_path
+
+    print("=== Value Log Test ===\n")
+
+    # Small segments so the first 200 KB of values fill several sealed ones
+    with IndexedDatabase(db_file, value_log_threshold=64, value_log_segment_size=32 * 1024) as db:
+        for i in range(200):
+            db.insert(f"k{i:04d}", f"{i}:" + "x" * 1000)
+        db.insert("small", "inline")
+
+        assert db.get("k0042") == "42:" + "x" * 1000
+        assert db.get("small") == "inline"
+        rows = db.range_scan("k", "k~")
+        assert len(rows) == 200 and rows[-1][1].startswith("199:")
+        assert db.get_stats()["value_log_bytes"] > 200 * 1000
+        print("✓ 1KB values stored through the value log")
+
+        # Overwrites leave garbage behind; collection reclaims it
+        for i in range(200):
+            db.insert(f"k{i:04d}", f"{i}:" + "y" * 1000)
+        before = db.get_stats()["value_log_bytes"]
+        reclaimed = db.collect_value_log(max_live_ratio=0.5)
+        print(f"  value log {before} bytes, reclaimed {reclaimed}")
+        assert reclaimed > 100 * 1000
+        assert db.get_stats()["value_log_bytes"] == before - reclaimed
+        assert db.get("k0199") == "199:" + "y" * 1000
+        assert all(v.endswith("y" * 1000) for _, v in db.range_scan("k", "k~"))
+        print("✓ Garbage collection keeps live values")
+
+    # Pointers stay readable after reopening (even without a threshold),
+    # including those to values moved by collection
+    with IndexedDatabase(db_file) as db:
+        assert db.get("k0007") == "7:" + "y" * 1000
+        rows = db.range_scan("k", "k~")
+        assert rows == [(f"k{i:04d}", f"{i}:" + "y" * 1000) for i in range(200)]
+
+    # Inline values and keys longer than 256 bytes, in a consolidated leaf
+    db_file = os.path.join(os.path.dirname(temp_db_path), "inline.db")
+    with IndexedDatabase(db_file) as db:
+        for i in range(10):
+            db.insert(f"v{i}", chr(ord("a") + i) * (1000 if i < 3 else 50))
+        db.insert("K" * 300, "long key")
+    with IndexedDatabase(db_file) as db:
+        assert db.get("v1") == "b" * 1000
+        assert db.get("K" * 300) == "long key"
+    print("✓ Long inline values and keys read back")
+
+    print("\n🎉 Value Log Test: PASSED\n")
+
+
+def test_value_log_recovery(temp_db_path):
+    """Transactional engine replays large values and keeps them after reopen"""
+    db_file = temp_db_path
+
+    print("=== Value Log Recovery Test ===\n")
+
+    db = TransactionalDatabase(db_file, value_log_threshold=128)
+    txn = db.begin_transaction()
+    db.insert_txn(txn, "doc:1", "a" * 3000)
+    db.insert_txn(txn, "doc:2", "b" * 20)
+    db.commit_transaction(txn)
+    db.merge("log", "e" * 100, "append")
+    db.merge("log", "f" * 100, "append")
+    db.close()
+
+    db = TransactionalDatabase(db_file, value_log_threshold=128)
+    assert db.get("doc:1") == "a" * 3000
+    assert db.get("doc:2") == "b" * 20
+    assert db.get("log") == "e" * 100 + "," + "f" * 100
+    db.close()
+    print("✓ Large values survive reopen and merges")
+
+    # Values of 64 KB and more are replayed whole from the WAL
+    script = _CRASHING_WRITER.format(path=sys.path, db_file=db_file)
+    out = subprocess.run([sys.executable, "-c", script], check=True,
+                         capture_output=True, text=True).stdout
+    last_lsn = int(out.split()[-1])
+    db = TransactionalDatabase(db_file, value_log_threshold=128)
+    assert db.get("huge") == "h" * 100000
+    assert db.get("after") == "1"
+    txn = db.begin_transaction()
+    db.insert_txn(txn, "next", "1")
+    assert db.commit_transaction(txn) > last_lsn  # Log read past the long record
+    db.close()
+    print("✓ 100KB value recovered from the WAL")
+
+    db_file = os.path.join(os.path.dirname(temp_db_path), "sql.db")
+
+    with SQLDatabase(db_file, value_log_threshold=64) as sql:
+        sql.execute("CREATE TABLE docs (id INT, body TEXT)")
+        for i in range(20):
+            sql.execute(f"INSERT INTO docs VALUES ({i}, '{'w' * 500}')")
+        assert sql.execute("SELECT id FROM docs WHERE id = 7") == [(7,)]
+        assert len(sql.execute("SELECT body FROM docs")[0][0]) == 500
+    print("✓ Wide SQL rows live in the value log")
+
+    print("\n🎉 Value Log Recovery Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))
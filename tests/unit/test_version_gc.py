@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+Version GC Test
+Tests that old row versions are pruned once no snapshot can read them
+"""
+
+import os
+import sys
+import time
+
+import pytest
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'python'))
+
+from toydb import TransactionalDatabase
+
+
+def test_version_gc(temp_db_path):
+    """A long-running snapshot holds versions back until it finishes"""
+    db_file = temp_db_path
+
+    print("=== Version GC Test ===\n")
+
+    with TransactionalDatabase(db_file) as db:
+        db.insert("counter", "0")
+        db.insert("other", "0")
+
+        old = db.begin_transaction(read_only=True, isolation="snapshot")
+        for i in range(1, 21):
+            db.insert("counter", str(i))
+
+        stats = db.get_stats()
+        assert stats["max_chain_length"] == 20
+        assert stats["oldest_snapshot_txn"] == old
+        assert stats["oldest_snapshot_lag"] == 20
+        assert db.collect_versions() == 0
+        assert db.get_txn(old, "counter") == "0"
+        print(f"✓ Old snapshot keeps {stats['versions']} versions alive")
+
+        recent = db.begin_transaction(read_only=True, isolation="snapshot")
+        db.insert("counter", "21")
+        db.insert("other", "1")
+        db.commit_transaction(old)
+
+        assert db.collect_versions() == 20
+        stats = db.get_stats()
+        assert stats["versions"] == 2 and stats["max_chain_length"] == 1
+        assert stats["oldest_snapshot_txn"] == recent
+        assert db.get_txn(recent, "counter") == "20"
+        assert db.get_txn(recent, "other") == "0"
+        print("✓ Versions older than the oldest snapshot pruned")
+
+        db.commit_transaction(recent)
+        stats = db.get_stats()
+        assert stats["versions"] == 0 and stats["versions_pruned"] == 22
+        print("✓ All versions dropped once no snapshot runs")
+
+    print("\n🎉 Version GC Test: PASSED\n")
+
+
+def test_background_sweeper(temp_db_path):
+    """The sweeper prunes versions of keys nobody reads"""
+    db_file = temp_db_path
+
+    print("=== Version Sweeper Test ===\n")
+
+    with TransactionalDatabase(db_file) as db:
+        for i in range(50):
+            db.insert(f"k{i:02d}", "a")
+
+        first = db.begin_transaction(read_only=True, isolation="snapshot")
+        for i in range(50):
+            db.insert(f"k{i:02d}", "b")
+        second = db.begin_transaction(read_only=True, isolation="snapshot")
+        db.commit_transaction(first)
+        assert db.get_stats()["versions"] == 50
+
+        deadline = time.time() + 5
+        while db.get_stats()["versions"] > 0 and time.time() < deadline:
+            time.sleep(0.05)
+        assert db.get_stats()["versions"] == 0
+        assert db.range_scan_txn(second, "k00", "k01") == [("k00", "b"), ("k01", "b")]
+        db.commit_transaction(second)
+        print("✓ Background sweeper reclaimed unread versions")
+
+    print("\n🎉 Version Sweeper Test: PASSED\n")
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__, "-s"]))